@@ -0,0 +1,112 @@
+#include "async.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cstdint>
+
+thread_local const std::atomic<bool>* current_cancellation_flag = nullptr;
+
+AsyncRun::AsyncRun(std::string program, CompletionCallback on_done)
+    : program_(std::move(program)),
+      on_done_(std::move(on_done)),
+      event_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+    if (event_fd_ < 0) {
+        throw RuntimeError("can't create eventfd");
+    }
+}
+
+AsyncRun::~AsyncRun() {
+    close(event_fd_);
+}
+
+bool AsyncRun::IsDone() const {
+    std::lock_guard lock{mutex_};
+    return done_;
+}
+
+const RunResult& AsyncRun::Wait() const {
+    std::unique_lock lock{mutex_};
+    done_condition_.wait(lock, [this] { return done_; });
+    return result_;
+}
+
+void AsyncRun::Cancel() {
+    cancelled_.store(true, std::memory_order_relaxed);
+}
+
+void AsyncRun::Complete(RunResult result) {
+    {
+        std::lock_guard lock{mutex_};
+        result_ = std::move(result);
+        done_ = true;
+    }
+    done_condition_.notify_all();
+
+    uint64_t one = 1;
+    [[maybe_unused]] auto written = write(event_fd_, &one, sizeof(one));
+    if (on_done_) {
+        on_done_(result_);
+    }
+}
+
+AsyncExecutor::AsyncExecutor(Task task) : task_(std::move(task)), thread_([this] { Work(); }) {
+}
+
+AsyncExecutor::~AsyncExecutor() {
+    {
+        std::lock_guard lock{mutex_};
+        stopping_ = true;
+        for (auto& run : queue_) {
+            run->Cancel();
+        }
+        if (current_ != nullptr) {
+            current_->Cancel();
+        }
+    }
+    queue_condition_.notify_one();
+    thread_.join();
+}
+
+void AsyncExecutor::Submit(std::shared_ptr<AsyncRun> run) {
+    {
+        std::lock_guard lock{mutex_};
+        if (stopping_) {
+            run->Cancel();
+        }
+        queue_.push_back(std::move(run));
+    }
+    queue_condition_.notify_one();
+}
+
+void AsyncExecutor::Work() {
+    while (true) {
+        std::shared_ptr<AsyncRun> run;
+        {
+            std::unique_lock lock{mutex_};
+            current_.reset();
+            queue_condition_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            run = std::move(queue_.front());
+            queue_.pop_front();
+            current_ = run;
+        }
+
+        RunResult result;
+        if (run->cancelled_.load(std::memory_order_relaxed)) {
+            // Never started.
+            result = {RunError::CANCELLED, "evaluation cancelled"};
+        } else {
+            CancellationScope scope{&run->cancelled_};
+            try {
+                result = task_(run->program_);
+            } catch (...) {
+                // An exception escaping the thread would terminate the process.
+                result = {RunError::UNKNOWN, "unknown error"};
+            }
+        }
+        run->Complete(std::move(result));
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <error.h>
+#include <run_result.h>
+
+// Cooperative cancellation. An evaluation runs with the cancellation flag of its task installed
+// for the thread; yield points in the evaluator (every function call) poll it and throw
+// Cancelled once it is set.
+
+extern thread_local const std::atomic<bool>* current_cancellation_flag;
+
+inline void CheckCancelled() {
+    auto* flag = current_cancellation_flag;
+    if (flag != nullptr && flag->load(std::memory_order_relaxed)) {
+        throw Cancelled("evaluation cancelled");
+    }
+}
+
+class CancellationScope {
+public:
+    explicit CancellationScope(const std::atomic<bool>* flag)
+        : previous_(current_cancellation_flag) {
+        current_cancellation_flag = flag;
+    }
+
+    CancellationScope(const CancellationScope&) = delete;
+    CancellationScope& operator=(const CancellationScope&) = delete;
+
+    ~CancellationScope() {
+        current_cancellation_flag = previous_;
+    }
+
+private:
+    const std::atomic<bool>* previous_;
+};
+
+// Handle of a program submitted to Interpreter::RunAsync. All methods may be called from any
+// thread.
+class AsyncRun {
+public:
+    using CompletionCallback = std::function<void(const RunResult&)>;
+
+    AsyncRun(std::string program, CompletionCallback on_done);
+    ~AsyncRun();
+
+    AsyncRun(const AsyncRun&) = delete;
+    AsyncRun& operator=(const AsyncRun&) = delete;
+
+    bool IsDone() const;
+
+    // Blocks until the program has finished and returns its result.
+    const RunResult& Wait() const;
+
+    // Asks the evaluation to stop at its next yield point; the result is then
+    // RunError::CANCELLED, unless the program finishes first.
+    void Cancel();
+
+    // An eventfd that becomes readable once the program has finished, for polling along with
+    // the host's other descriptors. It stays readable; it is closed with the handle.
+    int GetEventFd() const {
+        return event_fd_;
+    }
+
+private:
+    friend class AsyncExecutor;
+
+    std::string program_;
+    CompletionCallback on_done_;
+    std::atomic<bool> cancelled_ = false;
+    int event_fd_;
+
+    mutable std::mutex mutex_;
+    mutable std::condition_variable done_condition_;
+    bool done_ = false;
+    RunResult result_;
+
+    void Complete(RunResult result);
+};
+
+// Runs submitted programs one at a time, in submission order, on a thread of its own.
+class AsyncExecutor {
+public:
+    using Task = std::function<RunResult(const std::string&)>;
+
+    explicit AsyncExecutor(Task task);
+    // Cancels the running and the queued programs and waits for the thread.
+    ~AsyncExecutor();
+
+    AsyncExecutor(const AsyncExecutor&) = delete;
+    AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+    void Submit(std::shared_ptr<AsyncRun> run);
+
+private:
+    Task task_;
+    std::mutex mutex_;
+    std::condition_variable queue_condition_;
+    std::deque<std::shared_ptr<AsyncRun>> queue_;
+    std::shared_ptr<AsyncRun> current_;
+    bool stopping_ = false;
+    std::thread thread_;
+
+    void Work();
+};
@@ -0,0 +1,52 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <bigint.h>
+#include <scheme.h>
+
+// Times integer arithmetic: factorial and Fibonacci with bignum results, the fixnum path on a
+// call-heavy fib, and BigInt multiplication of large operands (Karatsuba).
+// Usage: scheme_advanced_bench_bignum [N] [ITERATIONS]
+
+template <typename Body>
+double MeasureMs(size_t iterations, Body&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        body();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t iterations = argc > 2 ? std::stoul(argv[2]) : 5;
+
+    Interpreter interpreter;
+    interpreter.Run("(define (fact n) (if (= n 0) 1 (* n (fact (- n 1)))))");
+    interpreter.Run("(define (fib-iter a b n) (if (= n 0) a (fib-iter b (+ a b) (- n 1))))");
+    interpreter.Run("(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))");
+
+    std::string result;
+    auto fact_ms = MeasureMs(
+        iterations, [&] { result = interpreter.Run("(fact " + std::to_string(n) + ")"); });
+    std::cout << "fact(" << n << "): " << result.size() << " digits, " << fact_ms << " ms"
+              << std::endl;
+
+    auto fib_ms = MeasureMs(iterations, [&] {
+        result = interpreter.Run("(fib-iter 0 1 " + std::to_string(n) + ")");
+    });
+    std::cout << "fib-iter(" << n << "): " << result.size() << " digits, " << fib_ms << " ms"
+              << std::endl;
+
+    auto fixnum_ms = MeasureMs(iterations, [&] { result = interpreter.Run("(fib 22)"); });
+    std::cout << "fib(22) on fixnums: " << result << ", " << fixnum_ms << " ms" << std::endl;
+
+    // Operands of about 10 n decimal digits.
+    auto factor = BigInt::FromString(std::string(10 * n, '7'));
+    BigInt product;
+    auto multiply_ms = MeasureMs(iterations, [&] { product = factor * factor; });
+    std::cout << "multiply " << 10 * n << "-digit numbers: " << multiply_ms << " ms"
+              << std::endl;
+}
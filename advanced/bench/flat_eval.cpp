@@ -0,0 +1,43 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <scheme.h>
+
+// Compares tree and flat evaluation on a call-heavy program.
+// Usage: scheme_advanced_bench_flat_eval [N] [ITERATIONS]
+
+template <typename Body>
+double MeasureMs(size_t iterations, Body&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        body();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+double MeasureFib(bool flat, size_t n, size_t iterations, std::string* result) {
+    InterpreterOptions options;
+    options.flat_evaluation = flat;
+    Interpreter interpreter{options};
+    interpreter.Run("(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))");
+
+    auto program = "(fib " + std::to_string(n) + ")";
+    return MeasureMs(iterations, [&] { *result = interpreter.Run(program); });
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 22;
+    size_t iterations = argc > 2 ? std::stoul(argv[2]) : 5;
+
+    std::string tree_result;
+    std::string flat_result;
+    double tree_ms = MeasureFib(false, n, iterations, &tree_result);
+    double flat_ms = MeasureFib(true, n, iterations, &flat_result);
+
+    std::cout << "fib(" << n << "):        " << tree_result << " / " << flat_result << "\n"
+              << "tree:           " << tree_ms << " ms\n"
+              << "flat:           " << flat_ms << " ms\n"
+              << "speedup:        " << tree_ms / flat_ms << "x" << std::endl;
+}
@@ -0,0 +1,37 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <parallel_reader.h>
+
+// Measures ParallelRead on a generated data file of independent top-level forms with a
+// growing number of threads.
+// Usage: scheme_advanced_bench_parallel_read [MEGABYTES] [MAX_THREADS]
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 64;
+    size_t max_threads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+
+    std::string source;
+    for (size_t i = 0; source.size() < megabytes * 1024 * 1024; ++i) {
+        source += "(record " + std::to_string(i) + " (name \"item-" + std::to_string(i) +
+                  "\") (tags a b c) (values 1 2 3 4 5 6 7 8))\n";
+    }
+
+    double single_thread_ms = 0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        ParallelReadOptions options;
+        options.threads = threads;
+
+        auto start = std::chrono::steady_clock::now();
+        auto forms = ParallelRead(source, options);
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        if (threads == 1) {
+            single_thread_ms = elapsed.count();
+        }
+        std::cout << threads << " threads: " << elapsed.count() << " ms, " << forms.size()
+                  << " forms, speedup " << single_thread_ms / elapsed.count() << "x"
+                  << std::endl;
+    }
+}
@@ -0,0 +1,90 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <compiled.h>
+#include <scheme.h>
+
+// Compares interpreter startup from a generated library: parsing the source with RunFile,
+// with lazily read function bodies, loading the precompiled .scmc image with RunCompiled and
+// restoring a heap image of the warmed interpreter with LoadImage.
+// Usage: scheme_advanced_bench_startup [FUNCTIONS] [ITERATIONS]
+
+template <typename Body>
+double MeasureMs(size_t iterations, Body&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        body();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    size_t functions = argc > 1 ? std::stoul(argv[1]) : 20000;
+    size_t iterations = argc > 2 ? std::stoul(argv[2]) : 10;
+
+    auto dir = std::filesystem::temp_directory_path();
+    auto source_path = (dir / "scheme_bench_startup.scm").string();
+    auto compiled_path = (dir / "scheme_bench_startup.scmc").string();
+    auto image_path = (dir / "scheme_bench_startup.scmi").string();
+
+    {
+        std::ofstream source{source_path};
+        for (size_t i = 0; i < functions; ++i) {
+            source << "(define (function-" << i << " x y)\n"
+                   << "  (if (< x y) (+ x (* y " << i << ")) (list x y '(table " << i
+                   << " 1 2 3))))\n";
+        }
+        source << "(function-0 1 2)\n";
+    }
+    {
+        std::ifstream source{source_path};
+        Tokenizer tokenizer{&source};
+        std::ofstream compiled{compiled_path, std::ios::binary};
+        CompileForms(&tokenizer, &compiled);
+    }
+    {
+        Interpreter interpreter;
+        interpreter.RunFile(source_path);
+        interpreter.SaveImage(image_path);
+    }
+
+    double source_ms = MeasureMs(iterations, [&] {
+        Interpreter interpreter;
+        interpreter.RunFile(source_path);
+    });
+    double lazy_ms = MeasureMs(iterations, [&] {
+        InterpreterOptions options;
+        options.lazy_bodies = true;
+        Interpreter interpreter{options};
+        interpreter.RunFile(source_path);
+    });
+    double compiled_ms = MeasureMs(iterations, [&] {
+        Interpreter interpreter;
+        interpreter.RunCompiled(compiled_path);
+    });
+    double image_ms = MeasureMs(iterations, [&] {
+        Interpreter interpreter;
+        interpreter.LoadImage(image_path);
+        interpreter.Run("(function-0 1 2)");
+    });
+
+    std::cout << "functions:      " << functions << "\n"
+              << "source size:    " << std::filesystem::file_size(source_path) << " bytes\n"
+              << "compiled size:  " << std::filesystem::file_size(compiled_path) << " bytes\n"
+              << "scmi size:      " << std::filesystem::file_size(image_path) << " bytes\n"
+              << "RunFile:        " << source_ms << " ms\n"
+              << "RunFile, lazy:  " << lazy_ms << " ms\n"
+              << "RunCompiled:    " << compiled_ms << " ms\n"
+              << "LoadImage:      " << image_ms << " ms\n"
+              << "lazy speedup:   " << source_ms / lazy_ms << "x\n"
+              << "image speedup:  " << source_ms / compiled_ms << "x\n"
+              << "scmi speedup:   " << source_ms / image_ms << "x" << std::endl;
+
+    std::filesystem::remove(source_path);
+    std::filesystem::remove(compiled_path);
+    std::filesystem::remove(image_path);
+}
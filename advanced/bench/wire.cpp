@@ -0,0 +1,73 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <memory_stream.h>
+#include <parser.h>
+#include <serializer.h>
+#include <tokenizer.h>
+#include <wire.h>
+
+// Compares shipping a value as text (SerializeTo, then reading it back) with the binary wire
+// format (Encode, then Decode) on generated records of numbers, symbols and strings.
+// Usage: scheme_advanced_bench_wire [RECORDS] [ITERATIONS]
+
+template <typename Body>
+double MeasureMs(size_t iterations, Body&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        body();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+ObjectPtr MakeList(std::initializer_list<ObjectPtr> elements, ObjectPtr tail = nullptr) {
+    for (auto it = std::rbegin(elements); it != std::rend(elements); ++it) {
+        auto cell = MakeNode<Cell>();
+        cell->SetFirst(*it);
+        cell->SetSecond(std::move(tail));
+        tail = std::move(cell);
+    }
+    return tail;
+}
+
+int main(int argc, char** argv) {
+    size_t records = argc > 1 ? std::stoul(argv[1]) : 200000;
+    size_t iterations = argc > 2 ? std::stoul(argv[2]) : 5;
+
+    ObjectPtr value;
+    for (size_t i = 0; i < records; ++i) {
+        auto id = static_cast<IntType>(i);
+        auto record = MakeList(
+            {MakeNode<Symbol>("record"), MakeNode<Number>(id * 7919),
+             MakeList({MakeNode<Symbol>("name"), MakeNode<String>("item-" + std::to_string(i))}),
+             MakeList({MakeNode<Symbol>("tags"), MakeNode<Symbol>("a"), MakeNode<Symbol>("b")}),
+             MakeNode<Number>(-id)});
+        value = MakeList({record}, std::move(value));
+    }
+
+    std::string text;
+    std::string message;
+    auto serialize_ms = MeasureMs(iterations, [&] {
+        text.clear();
+        SerializeTo(value, &text);
+    });
+    auto read_ms = MeasureMs(iterations, [&] {
+        MemoryStream stream{text};
+        Tokenizer tokenizer{&stream};
+        Read(&tokenizer);
+    });
+    auto encode_ms = MeasureMs(iterations, [&] {
+        message.clear();
+        Encode(value, &message);
+    });
+    auto decode_ms = MeasureMs(iterations, [&] { Decode(message); });
+
+    std::cout << "text: " << text.size() << " bytes, write " << serialize_ms << " ms, read "
+              << read_ms << " ms" << std::endl;
+    std::cout << "wire: " << message.size() << " bytes, encode " << encode_ms
+              << " ms, decode " << decode_ms << " ms" << std::endl;
+    std::cout << "round trip speedup " << (serialize_ms + read_ms) / (encode_ms + decode_ms)
+              << "x" << std::endl;
+}
@@ -0,0 +1,497 @@
+#include "bigint.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <utility>
+
+#include <error.h>
+
+namespace {
+
+using Digits = std::vector<uint32_t>;
+using DigitSpan = std::span<const uint32_t>;
+
+// Operands with fewer digits are multiplied by the schoolbook method, which is faster for them.
+constexpr size_t kKaratsubaThreshold = 32;
+
+constexpr uint32_t kDecimalBase = 1000000000;
+constexpr size_t kDecimalDigits = 9;
+
+void Trim(Digits* digits) {
+    while (!digits->empty() && digits->back() == 0) {
+        digits->pop_back();
+    }
+}
+
+DigitSpan Trimmed(DigitSpan digits) {
+    while (!digits.empty() && digits.back() == 0) {
+        digits = digits.first(digits.size() - 1);
+    }
+    return digits;
+}
+
+int CompareMagnitudes(DigitSpan first, DigitSpan second) {
+    if (first.size() != second.size()) {
+        return first.size() < second.size() ? -1 : 1;
+    }
+    for (size_t i = first.size(); i-- > 0;) {
+        if (first[i] != second[i]) {
+            return first[i] < second[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// *result += digits * 2^(32 * shift).
+void AddShifted(Digits* result, DigitSpan digits, size_t shift) {
+    if (result->size() < shift + digits.size()) {
+        result->resize(shift + digits.size());
+    }
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < digits.size(); ++i) {
+        uint64_t sum = static_cast<uint64_t>((*result)[shift + i]) + digits[i] + carry;
+        (*result)[shift + i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    for (auto j = shift + i; carry != 0; ++j) {
+        if (j == result->size()) {
+            result->push_back(0);
+        }
+        uint64_t sum = static_cast<uint64_t>((*result)[j]) + carry;
+        (*result)[j] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+}
+
+Digits AddMagnitudes(DigitSpan first, DigitSpan second) {
+    Digits result(first.begin(), first.end());
+    AddShifted(&result, second, 0);
+    Trim(&result);
+    return result;
+}
+
+// Requires first >= second.
+Digits SubtractMagnitudes(DigitSpan first, DigitSpan second) {
+    Digits result(first.begin(), first.end());
+    uint32_t borrow = 0;
+    for (size_t i = 0; i < result.size() && (i < second.size() || borrow != 0); ++i) {
+        uint64_t subtrahend = static_cast<uint64_t>(i < second.size() ? second[i] : 0) + borrow;
+        borrow = result[i] < subtrahend;
+        result[i] = static_cast<uint32_t>(result[i] - subtrahend);
+    }
+    Trim(&result);
+    return result;
+}
+
+Digits MultiplySchoolbook(DigitSpan first, DigitSpan second) {
+    Digits result(first.size() + second.size());
+    for (size_t i = 0; i < first.size(); ++i) {
+        if (first[i] == 0) {
+            continue;
+        }
+        uint64_t carry = 0;
+        for (size_t j = 0; j < second.size(); ++j) {
+            uint64_t product =
+                static_cast<uint64_t>(first[i]) * second[j] + result[i + j] + carry;
+            result[i + j] = static_cast<uint32_t>(product);
+            carry = product >> 32;
+        }
+        result[i + second.size()] = static_cast<uint32_t>(carry);
+    }
+    Trim(&result);
+    return result;
+}
+
+Digits MultiplyMagnitudes(DigitSpan first, DigitSpan second) {
+    first = Trimmed(first);
+    second = Trimmed(second);
+    if (first.size() < second.size()) {
+        std::swap(first, second);
+    }
+    if (second.empty()) {
+        return {};
+    }
+    if (second.size() < kKaratsubaThreshold) {
+        return MultiplySchoolbook(first, second);
+    }
+
+    auto half = first.size() / 2;
+    if (second.size() <= half) {
+        // Too unbalanced for Karatsuba: multiply by the halves of the larger operand.
+        auto result = MultiplyMagnitudes(first.first(half), second);
+        AddShifted(&result, MultiplyMagnitudes(first.subspan(half), second), half);
+        Trim(&result);
+        return result;
+    }
+
+    // (a1 B + a0)(b1 B + b0) = z2 B^2 + z1 B + z0 with z1 = (a0 + a1)(b0 + b1) - z0 - z2.
+    auto low_first = first.first(half);
+    auto high_first = first.subspan(half);
+    auto low_second = second.first(half);
+    auto high_second = second.subspan(half);
+    auto low = MultiplyMagnitudes(low_first, low_second);
+    auto high = MultiplyMagnitudes(high_first, high_second);
+    auto middle = MultiplyMagnitudes(AddMagnitudes(low_first, high_first),
+                                     AddMagnitudes(low_second, high_second));
+    middle = SubtractMagnitudes(middle, low);
+    middle = SubtractMagnitudes(middle, high);
+
+    auto result = std::move(low);
+    AddShifted(&result, middle, half);
+    AddShifted(&result, high, 2 * half);
+    Trim(&result);
+    return result;
+}
+
+// Divides *digits in place and returns the remainder.
+uint32_t DivideBySmall(Digits* digits, uint32_t divisor) {
+    uint64_t remainder = 0;
+    for (size_t i = digits->size(); i-- > 0;) {
+        uint64_t current = (remainder << 32) | (*digits)[i];
+        (*digits)[i] = static_cast<uint32_t>(current / divisor);
+        remainder = current % divisor;
+    }
+    Trim(digits);
+    return static_cast<uint32_t>(remainder);
+}
+
+void MultiplyAddSmall(Digits* digits, uint32_t factor, uint32_t addend) {
+    uint64_t carry = addend;
+    for (auto& digit : *digits) {
+        uint64_t product = static_cast<uint64_t>(digit) * factor + carry;
+        digit = static_cast<uint32_t>(product);
+        carry = product >> 32;
+    }
+    if (carry != 0) {
+        digits->push_back(static_cast<uint32_t>(carry));
+    }
+}
+
+// Knuth's algorithm D (TAOCP 4.3.1). divisor has at least two digits and no more than
+// dividend.
+void DivideLong(DigitSpan dividend, DigitSpan divisor, Digits* quotient, Digits* remainder) {
+    auto n = divisor.size();
+    auto m = dividend.size();
+    // Scale so the top digit of the divisor has its high bit set; quotient digit estimates
+    // are then off by at most two.
+    auto shift = std::countl_zero(divisor.back());
+    auto shifted = [shift](DigitSpan digits, size_t i) -> uint32_t {
+        auto high = i < digits.size() ? digits[i] : 0;
+        auto low = i > 0 ? digits[i - 1] : 0;
+        if (shift == 0) {
+            return high;
+        }
+        return (high << shift) | (low >> (32 - shift));
+    };
+    Digits v(n);
+    for (size_t i = 0; i < n; ++i) {
+        v[i] = shifted(divisor, i);
+    }
+    Digits u(m + 1);
+    for (size_t i = 0; i <= m; ++i) {
+        u[i] = shifted(dividend, i);
+    }
+
+    constexpr uint64_t kBase = uint64_t{1} << 32;
+    quotient->assign(m - n + 1, 0);
+    for (size_t j = m - n + 1; j-- > 0;) {
+        uint64_t numerator = (static_cast<uint64_t>(u[j + n]) << 32) | u[j + n - 1];
+        uint64_t estimate = numerator / v[n - 1];
+        uint64_t rest = numerator % v[n - 1];
+        while (estimate >= kBase || estimate * v[n - 2] > ((rest << 32) | u[j + n - 2])) {
+            --estimate;
+            rest += v[n - 1];
+            if (rest >= kBase) {
+                break;
+            }
+        }
+
+        // u[j..j+n] -= estimate * v.
+        int64_t borrow = 0;
+        int64_t difference = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t product = estimate * v[i];
+            difference = static_cast<int64_t>(u[i + j]) - borrow -
+                         static_cast<int64_t>(product & 0xffffffff);
+            u[i + j] = static_cast<uint32_t>(difference);
+            borrow = static_cast<int64_t>(product >> 32) - (difference >> 32);
+        }
+        difference = static_cast<int64_t>(u[j + n]) - borrow;
+        u[j + n] = static_cast<uint32_t>(difference);
+
+        if (difference < 0) {
+            // The estimate was one too large: add the divisor back.
+            --estimate;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t sum = static_cast<uint64_t>(u[i + j]) + v[i] + carry;
+                u[i + j] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+            u[j + n] = static_cast<uint32_t>(u[j + n] + carry);
+        }
+        (*quotient)[j] = static_cast<uint32_t>(estimate);
+    }
+    Trim(quotient);
+
+    remainder->assign(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        (*remainder)[i] = shift == 0 ? u[i] : (u[i] >> shift) | (u[i + 1] << (32 - shift));
+    }
+    Trim(remainder);
+}
+
+void DivideMagnitudes(DigitSpan dividend, DigitSpan divisor, Digits* quotient,
+                      Digits* remainder) {
+    if (divisor.empty()) {
+        throw RuntimeError("division by zero");
+    }
+    if (CompareMagnitudes(dividend, divisor) < 0) {
+        quotient->clear();
+        remainder->assign(dividend.begin(), dividend.end());
+        return;
+    }
+    if (divisor.size() == 1) {
+        quotient->assign(dividend.begin(), dividend.end());
+        auto rest = DivideBySmall(quotient, divisor.front());
+        remainder->clear();
+        if (rest != 0) {
+            remainder->push_back(rest);
+        }
+        return;
+    }
+    DivideLong(dividend, divisor, quotient, remainder);
+}
+
+}  // namespace
+
+BigInt::BigInt(IntType value) : negative_(value < 0) {
+    auto magnitude = negative_ ? uint64_t{0} - static_cast<uint64_t>(value)
+                               : static_cast<uint64_t>(value);
+    while (magnitude != 0) {
+        magnitude_.push_back(static_cast<uint32_t>(magnitude));
+        magnitude >>= 32;
+    }
+}
+
+BigInt BigInt::FromString(std::string_view text) {
+    BigInt answer;
+    bool negative = false;
+    if (!text.empty() && (text.front() == '+' || text.front() == '-')) {
+        negative = text.front() == '-';
+        text.remove_prefix(1);
+    }
+    if (text.empty() ||
+        !std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        throw SyntaxError("not an integer");
+    }
+
+    // Most significant chunk first; it is the short one.
+    auto chunk = text.size() % kDecimalDigits;
+    if (chunk == 0) {
+        chunk = kDecimalDigits;
+    }
+    while (!text.empty()) {
+        uint32_t value = 0;
+        uint32_t scale = 1;
+        for (size_t i = 0; i < chunk; ++i) {
+            value = value * 10 + static_cast<uint32_t>(text[i] - '0');
+            scale *= 10;
+        }
+        MultiplyAddSmall(&answer.magnitude_, scale, value);
+        text.remove_prefix(chunk);
+        chunk = kDecimalDigits;
+    }
+    answer.negative_ = negative;
+    answer.Normalize();
+    return answer;
+}
+
+BigInt BigInt::FromMagnitude(bool negative, std::vector<uint32_t> magnitude) {
+    BigInt answer;
+    answer.negative_ = negative;
+    answer.magnitude_ = std::move(magnitude);
+    answer.Normalize();
+    return answer;
+}
+
+bool BigInt::FitsIntType() const {
+    if (magnitude_.size() > 2) {
+        return false;
+    }
+    uint64_t magnitude = 0;
+    for (size_t i = magnitude_.size(); i-- > 0;) {
+        magnitude = (magnitude << 32) | magnitude_[i];
+    }
+    auto limit = static_cast<uint64_t>(std::numeric_limits<IntType>::max());
+    return magnitude <= (negative_ ? limit + 1 : limit);
+}
+
+IntType BigInt::ToIntType() const {
+    uint64_t magnitude = 0;
+    for (size_t i = magnitude_.size(); i-- > 0;) {
+        magnitude = (magnitude << 32) | magnitude_[i];
+    }
+    return static_cast<IntType>(negative_ ? uint64_t{0} - magnitude : magnitude);
+}
+
+double BigInt::ToDouble() const {
+    auto size = magnitude_.size();
+    uint64_t top = 0;
+    for (size_t i = size; i-- > size - std::min<size_t>(size, 2);) {
+        top = (top << 32) | magnitude_[i];
+    }
+    int exponent = 0;
+    if (size > 2) {
+        // The top 64 bits, with the lowest one set if any bit below them is, round the same
+        // way as the whole magnitude.
+        auto shift = std::countl_zero(magnitude_.back());
+        uint32_t rest = magnitude_[size - 3];
+        top = shift == 0 ? top : (top << shift) | (rest >> (32 - shift));
+        bool sticky = static_cast<uint32_t>(uint64_t{rest} << shift) != 0 ||
+                      std::any_of(magnitude_.begin(), magnitude_.end() - 3,
+                                  [](uint32_t digit) { return digit != 0; });
+        top |= sticky;
+        exponent = static_cast<int>(32 * (size - 2)) - shift;
+    }
+    auto answer = std::ldexp(static_cast<double>(top), exponent);
+    return negative_ ? -answer : answer;
+}
+
+std::string BigInt::ToString() const {
+    if (IsZero()) {
+        return "0";
+    }
+    auto digits = magnitude_;
+    std::vector<uint32_t> chunks;
+    while (!digits.empty()) {
+        chunks.push_back(DivideBySmall(&digits, kDecimalBase));
+    }
+
+    std::string answer = negative_ ? "-" : "";
+    answer += std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        auto chunk = std::to_string(chunks[i]);
+        answer.append(kDecimalDigits - chunk.size(), '0');
+        answer += chunk;
+    }
+    return answer;
+}
+
+BigInt BigInt::operator-() const {
+    auto answer = *this;
+    answer.negative_ = !negative_;
+    answer.Normalize();
+    return answer;
+}
+
+BigInt BigInt::Abs() const {
+    return negative_ ? -*this : *this;
+}
+
+BigInt BigInt::Sqrt() const {
+    if (negative_) {
+        throw RuntimeError("expected non-negative number");
+    }
+    if (IsZero()) {
+        return {};
+    }
+
+    // Newton's method from a power of two that is at least the root: the iterates decrease
+    // until they reach the floor of the root.
+    size_t bits = (magnitude_.size() - 1) * 32 + std::bit_width(magnitude_.back());
+    size_t root_bits = (bits + 1) / 2;
+    Digits start(root_bits / 32 + 1);
+    start.back() = uint32_t{1} << (root_bits % 32);
+    auto root = FromMagnitude(false, std::move(start));
+    while (true) {
+        auto next = (root + *this / root) / 2;
+        if (next >= root) {
+            return root;
+        }
+        root = std::move(next);
+    }
+}
+
+BigInt operator+(const BigInt& first, const BigInt& second) {
+    if (first.negative_ == second.negative_) {
+        return BigInt::FromMagnitude(first.negative_,
+                                     AddMagnitudes(first.magnitude_, second.magnitude_));
+    }
+    if (CompareMagnitudes(first.magnitude_, second.magnitude_) >= 0) {
+        return BigInt::FromMagnitude(first.negative_,
+                                     SubtractMagnitudes(first.magnitude_, second.magnitude_));
+    }
+    return BigInt::FromMagnitude(second.negative_,
+                                 SubtractMagnitudes(second.magnitude_, first.magnitude_));
+}
+
+BigInt operator-(const BigInt& first, const BigInt& second) {
+    return first + -second;
+}
+
+BigInt operator*(const BigInt& first, const BigInt& second) {
+    return BigInt::FromMagnitude(first.negative_ != second.negative_,
+                                 MultiplyMagnitudes(first.magnitude_, second.magnitude_));
+}
+
+BigInt operator/(const BigInt& first, const BigInt& second) {
+    Digits quotient;
+    Digits remainder;
+    DivideMagnitudes(first.magnitude_, second.magnitude_, &quotient, &remainder);
+    return BigInt::FromMagnitude(first.negative_ != second.negative_, std::move(quotient));
+}
+
+BigInt operator%(const BigInt& first, const BigInt& second) {
+    Digits quotient;
+    Digits remainder;
+    DivideMagnitudes(first.magnitude_, second.magnitude_, &quotient, &remainder);
+    return BigInt::FromMagnitude(first.negative_, std::move(remainder));
+}
+
+std::strong_ordering operator<=>(const BigInt& first, const BigInt& second) {
+    if (first.negative_ != second.negative_) {
+        return first.negative_ ? std::strong_ordering::less : std::strong_ordering::greater;
+    }
+    auto order = CompareMagnitudes(first.magnitude_, second.magnitude_);
+    if (first.negative_) {
+        order = -order;
+    }
+    return order <=> 0;
+}
+
+void BigInt::Normalize() {
+    Trim(&magnitude_);
+    if (magnitude_.empty()) {
+        negative_ = false;
+    }
+}
+
+std::string BigInteger::Serialize() {
+    return value_.ToString();
+}
+
+ObjectPtr BigInteger::Evaluate(const std::shared_ptr<ScopesCollection>&) {
+    return shared_from_this();
+}
+
+ObjectPtr MakeInteger(BigInt value) {
+    if (value.FitsIntType()) {
+        return MakeNode<Number>(value.ToIntType());
+    }
+    return MakeNode<BigInteger>(std::move(value));
+}
+
+BigInt GetBigInt(const ObjectPtr& object) {
+    if (auto* number = dynamic_cast<const Number*>(object.get())) {
+        return number->GetValue();
+    }
+    if (auto* big = dynamic_cast<const BigInteger*>(object.get())) {
+        return big->GetValue();
+    }
+    throw RuntimeError("expected number");
+}
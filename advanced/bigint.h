@@ -0,0 +1,88 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <object.h>
+
+// Arbitrary-precision integers. Integers that fit in IntType are Numbers; arithmetic that
+// overflows them continues on BigInts and the results are stored as BigIntegers, or again as
+// Numbers if they fit (see MakeInteger). So every integer has exactly one representation.
+
+class BigInt {
+public:
+    BigInt() = default;
+    BigInt(IntType value);
+
+    // Parses an optionally signed string of decimal digits; throws SyntaxError otherwise.
+    static BigInt FromString(std::string_view text);
+    // magnitude holds base 2^32 digits, least significant first.
+    static BigInt FromMagnitude(bool negative, std::vector<uint32_t> magnitude);
+
+    bool IsNegative() const {
+        return negative_;
+    }
+    bool IsZero() const {
+        return magnitude_.empty();
+    }
+    const std::vector<uint32_t>& GetMagnitude() const {
+        return magnitude_;
+    }
+
+    bool FitsIntType() const;
+    // Requires FitsIntType().
+    IntType ToIntType() const;
+    // Correctly rounded; infinite if the value is out of the range of double.
+    double ToDouble() const;
+    std::string ToString() const;
+
+    BigInt operator-() const;
+    BigInt Abs() const;
+    // Floor of the square root; throws RuntimeError for negative values.
+    BigInt Sqrt() const;
+
+    friend BigInt operator+(const BigInt& first, const BigInt& second);
+    friend BigInt operator-(const BigInt& first, const BigInt& second);
+    // Karatsuba above a size threshold, schoolbook below it.
+    friend BigInt operator*(const BigInt& first, const BigInt& second);
+    // Division truncates towards zero, like IntType division, and the remainder takes the
+    // sign of the dividend. Both throw RuntimeError on division by zero.
+    friend BigInt operator/(const BigInt& first, const BigInt& second);
+    friend BigInt operator%(const BigInt& first, const BigInt& second);
+
+    friend bool operator==(const BigInt& first, const BigInt& second) = default;
+    friend std::strong_ordering operator<=>(const BigInt& first, const BigInt& second);
+
+private:
+    bool negative_ = false;
+    // No leading zero digits; empty for zero, which is never negative.
+    std::vector<uint32_t> magnitude_;
+
+    void Normalize();
+};
+
+// Integer that doesn't fit in a Number.
+class BigInteger : public Object {
+public:
+    explicit BigInteger(BigInt value) : value_(std::move(value)) {
+    }
+
+    const BigInt& GetValue() const {
+        return value_;
+    }
+
+    std::string Serialize() override;
+    ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) override;
+
+private:
+    BigInt value_;
+};
+
+// A Number if value fits in one, a BigInteger otherwise.
+ObjectPtr MakeInteger(BigInt value);
+
+// The value of a Number or a BigInteger; throws RuntimeError for other objects.
+BigInt GetBigInt(const ObjectPtr& object);
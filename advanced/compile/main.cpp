@@ -0,0 +1,40 @@
+#include <fstream>
+#include <iostream>
+
+#include <compiled.h>
+#include <error.h>
+#include <mapped_file.h>
+#include <memory_stream.h>
+
+// Usage: scheme_advanced_compile SOURCE OUTPUT
+// Parses SOURCE once and writes its forms as a .scmc image that Interpreter::RunCompiled and
+// scheme_advanced_repl load without tokenizing or parsing.
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " SOURCE OUTPUT" << std::endl;
+        return 2;
+    }
+
+    try {
+        MappedFile source{argv[1]};
+        MemoryStream stream{source.GetText()};
+        Tokenizer tokenizer{&stream};
+
+        std::ofstream out{argv[2], std::ios::binary};
+        if (!out) {
+            std::cerr << "Can't open " << argv[2] << std::endl;
+            return 1;
+        }
+        CompileForms(&tokenizer, &out);
+        if (!out.flush()) {
+            std::cerr << "Can't write " << argv[2] << std::endl;
+            return 1;
+        }
+    } catch (const SyntaxError& syntax_error) {
+        std::cerr << "Caught SyntaxError: " << syntax_error.what() << std::endl;
+        return 1;
+    } catch (const RuntimeError& runtime_error) {
+        std::cerr << "Caught RuntimeError: " << runtime_error.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,240 @@
+#include "compiled.h"
+
+#include <bit>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <bigint.h>
+#include <error.h>
+#include <parser.h>
+
+namespace {
+
+class CompiledWriter {
+public:
+    void AddForm(const ObjectPtr& form) {
+        forms_.push_back(AddNode(form));
+    }
+
+    void Write(std::ostream* out) const {
+        CompiledHeader header{};
+        std::memcpy(header.magic, kCompiledMagic, sizeof(header.magic));
+        header.version = kCompiledVersion;
+        header.name_count = static_cast<uint32_t>(names_.size());
+        header.node_count = static_cast<uint32_t>(nodes_.size());
+        header.form_count = static_cast<uint32_t>(forms_.size());
+        header.names_size = names_blob_.size();
+
+        WriteArray(out, &header, 1);
+        WriteArray(out, names_.data(), names_.size());
+        WriteArray(out, nodes_.data(), nodes_.size());
+        WriteArray(out, forms_.data(), forms_.size());
+        WriteArray(out, names_blob_.data(), names_blob_.size());
+    }
+
+private:
+    std::vector<CompiledName> names_;
+    std::string names_blob_;
+    std::vector<CompiledNode> nodes_;
+    std::vector<uint32_t> forms_;
+
+    std::unordered_map<std::string, uint32_t> name_indices_;
+    // Atoms are immutable, so equal ones share a node.
+    std::unordered_map<uint32_t, uint32_t> symbol_nodes_;
+    std::unordered_map<uint32_t, uint32_t> string_nodes_;
+    std::unordered_map<int64_t, uint32_t> number_nodes_;
+    std::unordered_map<int64_t, uint32_t> flonum_nodes_;
+    std::unordered_map<uint32_t, uint32_t> big_number_nodes_;
+    // Holds the emitted objects, so their addresses can't be reused by later forms.
+    std::unordered_map<ObjectPtr, uint32_t> node_indices_;
+
+    template <typename T>
+    static void WriteArray(std::ostream* out, const T* data, size_t count) {
+        out->write(reinterpret_cast<const char*>(data),
+                   static_cast<std::streamsize>(count * sizeof(T)));
+    }
+
+    uint32_t AddName(const std::string& name) {
+        auto [it, inserted] = name_indices_.try_emplace(name, names_.size());
+        if (inserted) {
+            names_.push_back({static_cast<uint32_t>(names_blob_.size()),
+                              static_cast<uint32_t>(name.size())});
+            names_blob_ += name;
+        }
+        return it->second;
+    }
+
+    uint32_t Emit(const ObjectPtr& object, CompiledNode node) {
+        uint32_t index = nodes_.size();
+        nodes_.push_back(node);
+        node_indices_.emplace(object, index);
+        return index;
+    }
+
+    template <typename Key>
+    void EmitAtom(const ObjectPtr& object, std::unordered_map<Key, uint32_t>* atom_nodes, Key key,
+                  CompiledNode node) {
+        if (auto it = atom_nodes->find(key); it != atom_nodes->end()) {
+            node_indices_.emplace(object, it->second);
+            return;
+        }
+        atom_nodes->emplace(key, Emit(object, node));
+    }
+
+    uint32_t IndexOf(const ObjectPtr& object) const {
+        return object == nullptr ? kCompiledNil : node_indices_.at(object);
+    }
+
+    // Emits the subtree in post-order with an explicit stack; already emitted (shared)
+    // subtrees are referenced instead of being written again.
+    uint32_t AddNode(const ObjectPtr& root) {
+        std::vector<std::pair<ObjectPtr, bool>> stack{{root, false}};
+        while (!stack.empty()) {
+            auto [object, children_done] = std::move(stack.back());
+            stack.pop_back();
+            if (object == nullptr || node_indices_.contains(object)) {
+                continue;
+            }
+
+            if (auto cell = As<Cell>(object); cell != nullptr) {
+                if (!children_done) {
+                    stack.emplace_back(object, true);
+                    stack.emplace_back(cell->GetSecond(), false);
+                    stack.emplace_back(cell->GetFirst(), false);
+                    continue;
+                }
+                auto kind = cell->IsConstant() ? CompiledKind::CONSTANT_CELL : CompiledKind::CELL;
+                Emit(object, {kind, IndexOf(cell->GetFirst()), IndexOf(cell->GetSecond())});
+            } else if (auto number = As<Number>(object); number != nullptr) {
+                EmitAtom(object, &number_nodes_, number->GetValue(),
+                         {CompiledKind::NUMBER, 0, number->GetValue()});
+            } else if (auto symbol = As<Symbol>(object); symbol != nullptr) {
+                auto name = AddName(symbol->GetName());
+                EmitAtom(object, &symbol_nodes_, name, {CompiledKind::SYMBOL, name, 0});
+            } else if (auto string = As<String>(object); string != nullptr) {
+                auto name = AddName(string->GetValue());
+                EmitAtom(object, &string_nodes_, name, {CompiledKind::STRING, name, 0});
+            } else if (auto boolean = As<Boolean>(object); boolean != nullptr) {
+                Emit(object, {CompiledKind::BOOLEAN, 0, boolean->GetValue()});
+            } else if (auto flonum = As<Flonum>(object); flonum != nullptr) {
+                auto bits = std::bit_cast<int64_t>(flonum->GetValue());
+                EmitAtom(object, &flonum_nodes_, bits, {CompiledKind::FLONUM, 0, bits});
+            } else if (auto big = As<BigInteger>(object); big != nullptr) {
+                auto name = AddName(big->GetValue().ToString());
+                EmitAtom(object, &big_number_nodes_, name, {CompiledKind::BIG_NUMBER, name, 0});
+            } else {
+                throw RuntimeError("object can't be compiled");
+            }
+        }
+        return IndexOf(root);
+    }
+};
+
+template <typename T>
+const T* ViewArray(std::string_view image, size_t* offset, size_t count) {
+    if (count > (image.size() - *offset) / sizeof(T)) {
+        throw RuntimeError("truncated compiled program");
+    }
+    auto* data = reinterpret_cast<const T*>(image.data() + *offset);
+    *offset += count * sizeof(T);
+    return data;
+}
+
+}  // namespace
+
+void WriteCompiled(const std::vector<ObjectPtr>& forms, std::ostream* out) {
+    CompiledWriter writer;
+    for (const auto& form : forms) {
+        writer.AddForm(form);
+    }
+    writer.Write(out);
+}
+
+void CompileForms(Tokenizer* tokenizer, std::ostream* out) {
+    CompiledWriter writer;
+    while (!tokenizer->IsEnd()) {
+        writer.AddForm(Read(tokenizer));
+    }
+    writer.Write(out);
+}
+
+std::vector<ObjectPtr> ReadCompiled(std::string_view image) {
+    size_t offset = 0;
+    CompiledHeader header;
+    std::memcpy(&header, ViewArray<char>(image, &offset, sizeof(header)), sizeof(header));
+    if (std::memcmp(header.magic, kCompiledMagic, sizeof(header.magic)) != 0 ||
+        header.version != kCompiledVersion) {
+        throw RuntimeError("not a compiled program");
+    }
+
+    const auto* names = ViewArray<CompiledName>(image, &offset, header.name_count);
+    const auto* nodes = ViewArray<CompiledNode>(image, &offset, header.node_count);
+    const auto* forms = ViewArray<uint32_t>(image, &offset, header.form_count);
+    std::string_view names_blob{ViewArray<char>(image, &offset, header.names_size),
+                                header.names_size};
+
+    auto name_at = [&](uint32_t index) {
+        if (index >= header.name_count ||
+            names[index].offset + static_cast<uint64_t>(names[index].length) > names_blob.size()) {
+            throw RuntimeError("corrupted compiled program");
+        }
+        return names_blob.substr(names[index].offset, names[index].length);
+    };
+
+    std::vector<ObjectPtr> objects(header.node_count);
+    auto object_at = [&](uint64_t index, size_t limit) -> ObjectPtr {
+        if (index == kCompiledNil) {
+            return nullptr;
+        }
+        if (index >= limit) {
+            throw RuntimeError("corrupted compiled program");
+        }
+        return objects[index];
+    };
+
+    for (size_t i = 0; i < header.node_count; ++i) {
+        const auto& node = nodes[i];
+        switch (node.kind) {
+            case CompiledKind::NUMBER:
+                objects[i] = MakeNode<Number>(node.value);
+                break;
+            case CompiledKind::SYMBOL:
+                objects[i] = MakeNode<Symbol>(std::string(name_at(node.index)));
+                break;
+            case CompiledKind::STRING:
+                objects[i] = MakeNode<String>(std::string(name_at(node.index)));
+                break;
+            case CompiledKind::BOOLEAN:
+                objects[i] = MakeNode<Boolean>(node.value != 0);
+                break;
+            case CompiledKind::FLONUM:
+                objects[i] = MakeNode<Flonum>(std::bit_cast<double>(node.value));
+                break;
+            case CompiledKind::BIG_NUMBER:
+                objects[i] = MakeInteger(BigInt::FromString(name_at(node.index)));
+                break;
+            case CompiledKind::CELL:
+            case CompiledKind::CONSTANT_CELL: {
+                auto cell = MakeNode<Cell>();
+                cell->SetFirst(object_at(node.index, i));
+                cell->SetSecond(object_at(node.value, i));
+                if (node.kind == CompiledKind::CONSTANT_CELL) {
+                    cell->MarkConstant();
+                }
+                objects[i] = std::move(cell);
+                break;
+            }
+            default:
+                throw RuntimeError("corrupted compiled program");
+        }
+    }
+
+    std::vector<ObjectPtr> answer;
+    answer.reserve(header.form_count);
+    for (size_t i = 0; i < header.form_count; ++i) {
+        answer.push_back(object_at(forms[i], header.node_count));
+    }
+    return answer;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include <object.h>
+#include <tokenizer.h>
+
+// Precompiled program format (.scmc): the parsed ASTs of a program's top-level forms,
+// stored so that loading is a single forward pass over fixed-size records.
+//
+// Layout, in host byte order:
+//   CompiledHeader
+//   CompiledName[name_count]  (offset, length) into the names blob; shared by symbols and strings
+//   CompiledNode[node_count]  in post-order, so children always precede their parents
+//   uint32_t[form_count]      root node of every top-level form
+//   char[names_size]          names blob
+//
+// Equal atoms share one node, so every distinct symbol, number and string loads as a single
+// shared object. Vectors can't be compiled.
+
+inline constexpr char kCompiledMagic[4] = {'S', 'C', 'M', 'C'};
+inline constexpr uint32_t kCompiledVersion = 1;
+inline constexpr uint32_t kCompiledNil = UINT32_MAX;
+
+struct CompiledHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t name_count;
+    uint32_t node_count;
+    uint32_t form_count;
+    uint32_t reserved;
+    uint64_t names_size;
+};
+
+struct CompiledName {
+    uint32_t offset;
+    uint32_t length;
+};
+
+enum class CompiledKind : uint32_t {
+    NUMBER,
+    SYMBOL,
+    STRING,
+    BOOLEAN,
+    CELL,
+    CONSTANT_CELL,
+    FLONUM,
+    BIG_NUMBER,
+};
+
+struct CompiledNode {
+    CompiledKind kind;
+    // Name index for symbols, strings and big numbers (their decimal digits), car node index
+    // for cells. Shared constants (see ConstantPool) are stored as CONSTANT_CELL and load
+    // immutable.
+    uint32_t index;
+    // Value for numbers and booleans, the bits of the double for flonums, cdr node index for
+    // cells.
+    int64_t value;
+};
+
+void WriteCompiled(const std::vector<ObjectPtr>& forms, std::ostream* out);
+std::vector<ObjectPtr> ReadCompiled(std::string_view image);
+
+// Parses every top-level form the tokenizer yields and writes them as a .scmc image.
+void CompileForms(Tokenizer* tokenizer, std::ostream* out);
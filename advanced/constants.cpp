@@ -0,0 +1,116 @@
+#include "constants.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace {
+
+// Expired entries are swept once the tables could have doubled since the last sweep.
+constexpr size_t kMinPurgeInterval = 1024;
+
+template <typename Table, typename Key>
+ObjectPtr FindOrInsert(Table* table, Key&& key, const ObjectPtr& candidate, size_t* inserts) {
+    auto [it, inserted] = table->try_emplace(std::forward<Key>(key), candidate);
+    if (!inserted) {
+        if (auto existing = it->second.lock(); existing != nullptr) {
+            return existing;
+        }
+        it->second = candidate;
+    }
+    ++*inserts;
+    return candidate;
+}
+
+}  // namespace
+
+size_t ConstantPool::PairHash::operator()(
+    const std::pair<const Object*, const Object*>& key) const {
+    size_t first = std::hash<const Object*>{}(key.first);
+    size_t second = std::hash<const Object*>{}(key.second);
+    return first ^ (second + 0x9e3779b97f4a7c15ULL + (first << 6) + (first >> 2));
+}
+
+ObjectPtr ConstantPool::Intern(const ObjectPtr& datum) {
+    std::lock_guard lock{mutex_};
+
+    // Post-order walk with explicit stacks: children are interned before their cell.
+    std::vector<std::pair<ObjectPtr, bool>> pending{{datum, false}};
+    std::vector<ObjectPtr> interned;
+    while (!pending.empty()) {
+        auto [object, children_done] = std::move(pending.back());
+        pending.pop_back();
+
+        auto cell = As<Cell>(object);
+        if (cell == nullptr) {
+            interned.push_back(InternAtom(object));
+        } else if (!children_done) {
+            pending.emplace_back(object, true);
+            pending.emplace_back(cell->GetSecond(), false);
+            pending.emplace_back(cell->GetFirst(), false);
+        } else {
+            auto second = std::move(interned.back());
+            interned.pop_back();
+            auto first = std::move(interned.back());
+            interned.pop_back();
+            interned.push_back(InternCell(cell, std::move(first), std::move(second)));
+        }
+    }
+
+    if (inserts_since_purge_ >= std::max(kMinPurgeInterval, TotalSize())) {
+        PurgeExpired();
+    }
+    return interned.back();
+}
+
+size_t ConstantPool::Size() {
+    std::lock_guard lock{mutex_};
+    PurgeExpired();
+    return TotalSize();
+}
+
+size_t ConstantPool::TotalSize() const {
+    return numbers_.size() + symbols_.size() + strings_.size() + cells_.size();
+}
+
+ObjectPtr ConstantPool::InternAtom(const ObjectPtr& atom) {
+    if (auto number = As<Number>(atom); number != nullptr) {
+        return FindOrInsert(&numbers_, number->GetValue(), atom, &inserts_since_purge_);
+    }
+    if (auto symbol = As<Symbol>(atom); symbol != nullptr) {
+        return FindOrInsert(&symbols_, symbol->GetName(), atom, &inserts_since_purge_);
+    }
+    if (auto string = As<String>(atom); string != nullptr) {
+        return FindOrInsert(&strings_, string->GetValue(), atom, &inserts_since_purge_);
+    }
+    return atom;
+}
+
+ObjectPtr ConstantPool::InternCell(const std::shared_ptr<Cell>& cell, ObjectPtr first,
+                                   ObjectPtr second) {
+    auto key = std::make_pair(first.get(), second.get());
+    if (auto it = cells_.find(key); it != cells_.end()) {
+        if (auto existing = it->second.lock(); existing != nullptr) {
+            return existing;
+        }
+    }
+
+    // The cell is fresh from the reader, so it can become the canonical instance itself.
+    cell->SetFirst(std::move(first));
+    cell->SetSecond(std::move(second));
+    cell->MarkConstant();
+    cells_.insert_or_assign(key, cell);
+    ++inserts_since_purge_;
+    return cell;
+}
+
+void ConstantPool::PurgeExpired() {
+    auto purge = [](auto* table) {
+        std::erase_if(*table, [](const auto& entry) { return entry.second.expired(); });
+    };
+    purge(&numbers_);
+    purge(&symbols_);
+    purge(&strings_);
+    purge(&cells_);
+    inserts_since_purge_ = 0;
+}
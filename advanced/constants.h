@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <object.h>
+
+// Hash-consing table for quoted constants. Interning a datum replaces every subtree with the
+// single canonical instance of structurally equal data, so identical literals read anywhere
+// share one representation. Canonical cells are marked constant, and set-car!/set-cdr!
+// refuse to modify them.
+//
+// The pool only keeps weak references: a constant is dropped once no program uses it.
+// Interning is thread-safe.
+class ConstantPool {
+public:
+    // Returns the canonical instance of a freshly read datum. Cells of the datum that have
+    // no canonical instance yet become canonical themselves.
+    ObjectPtr Intern(const ObjectPtr& datum);
+
+    // Number of live canonical objects.
+    size_t Size();
+
+private:
+    struct PairHash {
+        size_t operator()(const std::pair<const Object*, const Object*>& key) const;
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<IntType, std::weak_ptr<Object>> numbers_;
+    std::unordered_map<std::string, std::weak_ptr<Object>> symbols_;
+    std::unordered_map<std::string, std::weak_ptr<Object>> strings_;
+    // Children of canonical cells are canonical themselves, so cells are keyed by their
+    // children's identity.
+    std::unordered_map<std::pair<const Object*, const Object*>, std::weak_ptr<Object>, PairHash>
+        cells_;
+    size_t inserts_since_purge_ = 0;
+
+    ObjectPtr InternAtom(const ObjectPtr& atom);
+    ObjectPtr InternCell(const std::shared_ptr<Cell>& cell, ObjectPtr first, ObjectPtr second);
+    size_t TotalSize() const;
+    void PurgeExpired();
+};
@@ -20,4 +20,9 @@ struct InvalidArgsCount : public RuntimeError {
 
 struct NameError : public std::runtime_error {
     using std::runtime_error::runtime_error;
-};
\ No newline at end of file
+};
+
+// Raised at the next yield point of an evaluation whose cancellation was requested, see async.h.
+struct Cancelled : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
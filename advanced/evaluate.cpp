@@ -1,6 +1,9 @@
 #include "evaluate.h"
 #include <funcs.h>
 #include <representation.h>
+#include <parser.h>
+#include <flat_ast.h>
+#include <serializer.h>
 
 ObjectPtr Evaluate(const ObjectPtr& program_ast, const std::shared_ptr<ScopesCollection>& scopes) {
     if (program_ast == nullptr) {
@@ -11,9 +14,22 @@ ObjectPtr Evaluate(const ObjectPtr& program_ast, const std::shared_ptr<ScopesCol
 }
 
 std::string Serialize(const ObjectPtr& root) {
-    if (root == nullptr) {
-        return "()";
-    }
+    std::string answer;
+    SerializeTo(root, &answer);
+    return answer;
+}
 
-    return root->Serialize();
-}
\ No newline at end of file
+ObjectPtr EvaluateForms(Tokenizer* tokenizer, const std::shared_ptr<ScopesCollection>& scopes,
+                        const ReadOptions& read_options,
+                        const std::function<void(const ObjectPtr&)>& on_result) {
+    ObjectPtr last_result;
+    while (!tokenizer->IsEnd()) {
+        auto form_ast = Read(tokenizer, read_options);
+        last_result = read_options.flat ? FlatProgram({form_ast}).Evaluate(scopes)
+                                        : Evaluate(form_ast, scopes);
+        if (on_result) {
+            on_result(last_result);
+        }
+    }
+    return last_result;
+}
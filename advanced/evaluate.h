@@ -1,7 +1,17 @@
 #pragma once
 
+#include <functional>
+
 #include <object.h>
 #include <scope.h>
+#include <tokenizer.h>
+#include <parser.h>
 
 ObjectPtr Evaluate(const ObjectPtr& program_ast, const std::shared_ptr<ScopesCollection>& scopes);
-std::string Serialize(const ObjectPtr& root);
\ No newline at end of file
+std::string Serialize(const ObjectPtr& root);
+
+// Reads and evaluates top-level forms until the tokenizer is exhausted, dropping each form
+// after evaluation. Returns the result of the last form.
+ObjectPtr EvaluateForms(Tokenizer* tokenizer, const std::shared_ptr<ScopesCollection>& scopes,
+                        const ReadOptions& read_options = {},
+                        const std::function<void(const ObjectPtr&)>& on_result = {});
@@ -0,0 +1,218 @@
+#include "flat_ast.h"
+
+#include <deque>
+#include <limits>
+#include <evaluate.h>
+#include <funcs.h>
+#include <representation.h>
+#include <vector.h>
+
+namespace {
+
+// Argument lists are collected into buffers shared by all calls at the same nesting depth, so
+// evaluating a call doesn't allocate once the buffers have grown.
+struct ArgumentStack {
+    std::deque<std::vector<ObjectPtr>> buffers;
+    size_t depth = 0;
+};
+
+thread_local ArgumentStack argument_stack;
+
+class ArgumentBuffer {
+public:
+    ArgumentBuffer() {
+        if (argument_stack.depth == argument_stack.buffers.size()) {
+            argument_stack.buffers.emplace_back();
+        }
+        buffer_ = &argument_stack.buffers[argument_stack.depth++];
+    }
+
+    ArgumentBuffer(const ArgumentBuffer&) = delete;
+    ArgumentBuffer& operator=(const ArgumentBuffer&) = delete;
+
+    ~ArgumentBuffer() {
+        buffer_->clear();
+        --argument_stack.depth;
+    }
+
+    std::vector<ObjectPtr>& Get() {
+        return *buffer_;
+    }
+
+private:
+    std::vector<ObjectPtr>* buffer_;
+};
+
+bool IsQuoteSymbol(const ObjectPtr& object) {
+    auto symbol = As<Symbol>(object);
+    return symbol != nullptr && symbol->GetName() == "quote";
+}
+
+}  // namespace
+
+FlatProgram::FlatProgram(const std::vector<ObjectPtr>& forms) {
+    std::vector<uint32_t> pending;
+    for (const auto& form : forms) {
+        roots_.push_back(static_cast<uint32_t>(nodes_.size()));
+        nodes_.push_back({.kind = FlatNodeKind::DATUM, .first = 0, .argument_count = 0,
+                          .object = form});
+        pending.push_back(roots_.back());
+    }
+
+    // Breadth-first, so the children of every call are allocated as one block.
+    for (size_t i = 0; i < pending.size(); ++i) {
+        Fill(pending[i], nodes_[pending[i]].object, &pending);
+    }
+}
+
+void FlatProgram::Fill(uint32_t index, const ObjectPtr& object, std::vector<uint32_t>* pending) {
+    if (object == nullptr || Is<Number>(object) || Is<BigInteger>(object) || Is<Flonum>(object) ||
+        Is<String>(object) || Is<Boolean>(object) || Is<Vector>(object)) {
+        nodes_[index].kind = FlatNodeKind::CONSTANT;
+        return;
+    }
+    if (Is<Symbol>(object)) {
+        nodes_[index].kind = FlatNodeKind::VARIABLE;
+        return;
+    }
+    if (!Is<Cell>(object)) {
+        return;
+    }
+
+    auto elements = Flatten(object);
+    if (elements.back() != nullptr) {
+        // Improper lists are left to Cell::Evaluate, which reports the error.
+        return;
+    }
+    elements.pop_back();
+
+    if (nodes_.size() + elements.size() > std::numeric_limits<uint32_t>::max()) {
+        throw RuntimeError("program is too large");
+    }
+
+    auto first = static_cast<uint32_t>(nodes_.size());
+    nodes_[index].kind = FlatNodeKind::CALL;
+    nodes_[index].first = first;
+    nodes_[index].argument_count = static_cast<uint32_t>(elements.size() - 1);
+
+    bool quoted = elements.size() == 2 && IsQuoteSymbol(elements.front());
+    for (size_t i = 0; i < elements.size(); ++i) {
+        nodes_.push_back({.kind = FlatNodeKind::DATUM, .first = 0, .argument_count = 0,
+                          .object = std::move(elements[i])});
+        // Quoted data stays a single DATUM node, whatever its shape.
+        if (!(quoted && i == 1)) {
+            pending->push_back(first + i);
+        }
+    }
+}
+
+ObjectPtr FlatProgram::Evaluate(const std::shared_ptr<ScopesCollection>& scopes) const {
+    ObjectPtr result;
+    for (auto root : roots_) {
+        result = EvaluateNode(root, scopes);
+    }
+    return result;
+}
+
+ObjectPtr FlatProgram::EvaluateNode(uint32_t index,
+                                    const std::shared_ptr<ScopesCollection>& scopes) const {
+    const auto& node = nodes_[index];
+    switch (node.kind) {
+        case FlatNodeKind::CONSTANT:
+            return node.object;
+        case FlatNodeKind::VARIABLE: {
+            const auto& name = static_cast<const Symbol&>(*node.object).GetName();
+            ObjectPtr value;
+            if (!scopes->Lookup(name, &value)) {
+                throw NameError("no such object");
+            }
+            return value;
+        }
+        case FlatNodeKind::CALL:
+            return EvaluateCall(node, scopes);
+        case FlatNodeKind::DATUM:
+            return ::Evaluate(node.object, scopes);
+    }
+    return nullptr;
+}
+
+ObjectPtr FlatProgram::EvaluateCall(const FlatNode& node,
+                                    const std::shared_ptr<ScopesCollection>& scopes) const {
+    auto function = As<IFunction>(EvaluateNode(node.first, scopes));
+    if (function == nullptr) {
+        throw RuntimeError("not a function");
+    }
+    auto arguments = node.first + 1;
+    auto count = node.argument_count;
+
+    if (auto* evaluating = dynamic_cast<EvaluatingArgumentFunction*>(function.get())) {
+        ArgumentBuffer buffer;
+        auto& values = buffer.Get();
+        for (uint32_t i = 0; i < count; ++i) {
+            values.push_back(EvaluateNode(arguments + i, scopes));
+        }
+        return evaluating->CallEvaluated(values, scopes);
+    }
+
+    if (auto* lambda = dynamic_cast<Lambda*>(function.get())) {
+        if (count != lambda->GetArity()) {
+            throw InvalidArgsCount(FormatString("expected", lambda->GetArity(), "got", count));
+        }
+        ArgumentBuffer buffer;
+        auto& values = buffer.Get();
+        for (uint32_t i = 0; i < count; ++i) {
+            values.push_back(EvaluateNode(arguments + i, scopes));
+        }
+        return lambda->Invoke(values, scopes);
+    }
+
+    if (dynamic_cast<QuoteFunction*>(function.get()) != nullptr && count == 1) {
+        return nodes_[arguments].object;
+    }
+
+    if (dynamic_cast<If*>(function.get()) != nullptr && (count == 2 || count == 3)) {
+        if (ToBool(EvaluateNode(arguments, scopes))) {
+            return EvaluateNode(arguments + 1, scopes);
+        }
+        return count == 3 ? EvaluateNode(arguments + 2, scopes) : nullptr;
+    }
+
+    if (auto* junction = dynamic_cast<BoolExpressionEvaluator*>(function.get());
+        junction != nullptr && count > 0) {
+        ObjectPtr value;
+        for (uint32_t i = 0; i < count; ++i) {
+            value = EvaluateNode(arguments + i, scopes);
+            if (ToBool(value) == junction->GetExpected()) {
+                break;
+            }
+        }
+        return value;
+    }
+
+    if (dynamic_cast<Set*>(function.get()) != nullptr && count == 2 &&
+        nodes_[arguments].kind == FlatNodeKind::VARIABLE) {
+        const auto& name = static_cast<const Symbol&>(*nodes_[arguments].object).GetName();
+        ObjectPtr value;
+        if (!scopes->Lookup(name, &value)) {
+            throw NameError("no such object");
+        }
+        scopes->Set(name, EvaluateNode(arguments + 1, scopes), false);
+        return nullptr;
+    }
+
+    // Other special forms, and the error cases of the ones above, get their arguments as Cells.
+    return ToAst(function->Call(GetRawArguments(node), scopes));
+}
+
+std::vector<ObjectPtr> FlatProgram::GetRawArguments(const FlatNode& node) const {
+    std::vector<ObjectPtr> arguments;
+    arguments.reserve(node.argument_count);
+    for (uint32_t i = 0; i < node.argument_count; ++i) {
+        arguments.push_back(nodes_[node.first + 1 + i].object);
+    }
+    return arguments;
+}
+
+FlatProgram ReadFlat(Tokenizer* tokenizer, const ReadOptions& options) {
+    return FlatProgram({Read(tokenizer, options)});
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <object.h>
+#include <scope.h>
+#include <tokenizer.h>
+#include <parser.h>
+
+// Flat representation of programs for evaluation. All nodes of a program live in one contiguous
+// array; the head and the arguments of a call are stored next to each other, so a call node only
+// keeps the index of its head and the number of arguments.
+//
+// Every node keeps the object it was built from. Quoted data and the arguments of special forms
+// the evaluator doesn't know are handed out as these real Cell values.
+
+enum class FlatNodeKind : uint8_t {
+    CONSTANT,  // self-evaluating: number, string, boolean, vector or ()
+    VARIABLE,  // symbol lookup
+    CALL,      // proper list: head at `first`, arguments at first + 1 .. first + argument_count
+    DATUM,     // anything else (improper lists, quoted data), evaluated as a tree
+};
+
+struct FlatNode {
+    FlatNodeKind kind;
+    uint32_t first;
+    uint32_t argument_count;
+    ObjectPtr object;
+};
+
+class FlatProgram {
+public:
+    // Every form becomes a root of the program; roots are evaluated in order.
+    explicit FlatProgram(const std::vector<ObjectPtr>& forms);
+
+    // Evaluates the roots and returns the result of the last one.
+    ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) const;
+
+    const std::vector<FlatNode>& GetNodes() const {
+        return nodes_;
+    }
+    const std::vector<uint32_t>& GetRoots() const {
+        return roots_;
+    }
+
+private:
+    std::vector<FlatNode> nodes_;
+    std::vector<uint32_t> roots_;
+
+    void Fill(uint32_t index, const ObjectPtr& object, std::vector<uint32_t>* pending);
+
+    ObjectPtr EvaluateNode(uint32_t index, const std::shared_ptr<ScopesCollection>& scopes) const;
+    ObjectPtr EvaluateCall(const FlatNode& node,
+                           const std::shared_ptr<ScopesCollection>& scopes) const;
+    std::vector<ObjectPtr> GetRawArguments(const FlatNode& node) const;
+};
+
+// Reads one form and flattens it.
+FlatProgram ReadFlat(Tokenizer* tokenizer, const ReadOptions& options = {});
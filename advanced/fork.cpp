@@ -0,0 +1,6 @@
+#include "fork.h"
+
+std::atomic<uint32_t> fork_generation = 0;
+
+thread_local constinit ForkOverlay* current_fork = nullptr;
+thread_local constinit uint32_t current_fork_generation = 0;
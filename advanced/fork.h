@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Copy-on-write state of forked interpreters (see Interpreter::Fork).
+//
+// Every scope, cell and vector records the fork generation current when it was created. Fork
+// starts a new generation; from then on the parent and the child both treat older ones as
+// shared and read-only. Writes to them go to the writer's ForkOverlay instead, and reads
+// consult the overlay first. Evaluation installs the overlay of its interpreter for the thread
+// with ForkScope; scopes, cells and vectors created afterwards belong to one interpreter and
+// are modified in place.
+
+class Object;
+class Cell;
+class Scope;
+class Vector;
+
+extern std::atomic<uint32_t> fork_generation;
+
+inline uint32_t GetForkGeneration() {
+    return fork_generation.load(std::memory_order_relaxed);
+}
+
+class ForkOverlay {
+public:
+    using Children = std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>;
+    using Elements = std::vector<std::shared_ptr<Object>>;
+
+    // Objects created before generation are shared; 0 shares nothing.
+    uint32_t GetGeneration() const {
+        return generation_;
+    }
+    void SetGeneration(uint32_t generation) {
+        generation_ = generation;
+    }
+
+    std::shared_ptr<Object>* FindBinding(const Scope* scope, const std::string& key) {
+        auto it = bindings_.find(scope);
+        if (it == bindings_.end()) {
+            return nullptr;
+        }
+        auto binding = it->second.find(key);
+        return binding != it->second.end() ? &binding->second : nullptr;
+    }
+    void SetBinding(const Scope* scope, const std::string& key, std::shared_ptr<Object> value) {
+        bindings_[scope].insert_or_assign(key, std::move(value));
+    }
+
+    const Children* FindChildren(const Cell* cell) const {
+        auto it = cells_.find(cell);
+        return it != cells_.end() ? &it->second : nullptr;
+    }
+    void SetChildren(const Cell* cell, Children children) {
+        cells_.insert_or_assign(cell, std::move(children));
+    }
+
+    Elements* FindElements(const Vector* vector) {
+        auto it = vectors_.find(vector);
+        return it != vectors_.end() ? &it->second : nullptr;
+    }
+    // A shared vector is copied whole on its first write.
+    Elements* SetElements(const Vector* vector, Elements elements) {
+        return &vectors_.insert_or_assign(vector, std::move(elements)).first->second;
+    }
+
+private:
+    uint32_t generation_ = 0;
+    // Keyed by address: shared objects are kept alive by the interpreters that share them.
+    std::unordered_map<const Scope*, std::unordered_map<std::string, std::shared_ptr<Object>>>
+        bindings_;
+    std::unordered_map<const Cell*, Children> cells_;
+    std::unordered_map<const Vector*, Elements> vectors_;
+};
+
+// The overlay of the interpreter evaluating on this thread, and its generation.
+extern thread_local constinit ForkOverlay* current_fork;
+extern thread_local constinit uint32_t current_fork_generation;
+
+class ForkScope {
+public:
+    explicit ForkScope(ForkOverlay* overlay)
+        : previous_(current_fork), previous_generation_(current_fork_generation) {
+        current_fork = overlay;
+        current_fork_generation = overlay->GetGeneration();
+    }
+
+    ForkScope(const ForkScope&) = delete;
+    ForkScope& operator=(const ForkScope&) = delete;
+
+    ~ForkScope() {
+        current_fork = previous_;
+        current_fork_generation = previous_generation_;
+    }
+
+private:
+    ForkOverlay* previous_;
+    uint32_t previous_generation_;
+};
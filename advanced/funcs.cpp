@@ -1,18 +1,75 @@
 #include "funcs.h"
 
+#include <iostream>
+#include <limits>
+
+#include "async.h"
 #include "evaluate.h"
+#include "flat_ast.h"
+#include "host_vector.h"
+#include "lazy_body.h"
+#include "mapped_file.h"
+#include "memory_stream.h"
+#include "port.h"
+#include "promise.h"
 #include "representation.h"
+#include "vector.h"
+
+BigInt Adder::operator()(const BigInt& first, const BigInt& second) const {
+    return first + second;
+}
+
+BigInt Subtracter::operator()(const BigInt& first, const BigInt& second) const {
+    return first - second;
+}
+
+BigInt Multiplier::operator()(const BigInt& first, const BigInt& second) const {
+    return first * second;
+}
+
+bool Divider::operator()(IntType first, IntType second, IntType* result) const {
+    if (second == 0) {
+        throw RuntimeError("division by zero");
+    }
+    if (first == std::numeric_limits<IntType>::min() && second == -1) {
+        return false;
+    }
+    *result = first / second;
+    return true;
+}
+
+BigInt Divider::operator()(const BigInt& first, const BigInt& second) const {
+    return first / second;
+}
+
+bool Maxer::operator()(IntType first, IntType second, IntType* result) const {
+    *result = std::max(first, second);
+    return true;
+}
 
-IntType Maxer::operator()(IntType first, IntType second) {
+BigInt Maxer::operator()(const BigInt& first, const BigInt& second) const {
     return std::max(first, second);
 }
 
-IntType Miner::operator()(IntType first, IntType second) {
+bool Miner::operator()(IntType first, IntType second, IntType* result) const {
+    *result = std::min(first, second);
+    return true;
+}
+
+BigInt Miner::operator()(const BigInt& first, const BigInt& second) const {
     return std::min(first, second);
 }
 
-IntType Abser::operator()(IntType number) {
-    return std::abs(number);
+bool Abser::operator()(IntType number, IntType* result) const {
+    if (number == std::numeric_limits<IntType>::min()) {
+        return false;
+    }
+    *result = std::abs(number);
+    return true;
+}
+
+BigInt Abser::operator()(const BigInt& number) const {
+    return number.Abs();
 }
 
 const Number& GetNumber(const ObjectPtr& object) {
@@ -24,6 +81,64 @@ const Number& GetNumber(const ObjectPtr& object) {
     return *number;
 }
 
+double GetDouble(const ObjectPtr& object) {
+    if (auto* number = dynamic_cast<const Number*>(object.get())) {
+        return static_cast<double>(number->GetValue());
+    }
+    if (auto* flonum = dynamic_cast<const Flonum*>(object.get())) {
+        return flonum->GetValue();
+    }
+    return GetBigInt(object).ToDouble();
+}
+
+IntType CompareIntegers(const ObjectPtr& first, const ObjectPtr& second) {
+    auto order = GetBigInt(first) <=> GetBigInt(second);
+    return order < 0 ? -1 : order > 0 ? 1 : 0;
+}
+
+std::vector<ObjectPtr> IsNumber::DoCall(const std::vector<ObjectPtr>& args,
+                                        const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+
+    const auto& arg = args.front();
+    return {MakeNode<Boolean>(Is<Number>(arg) || Is<BigInteger>(arg) || Is<Flonum>(arg))};
+}
+
+std::vector<ObjectPtr> Sqrt::DoCall(const std::vector<ObjectPtr>& args,
+                                    const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+
+    auto value = GetDouble(args.front());
+    if (value < 0) {
+        throw RuntimeError("expected non-negative number");
+    }
+    if (auto* number = dynamic_cast<const Number*>(args.front().get())) {
+        // The double root is off by at most one.
+        auto square = static_cast<uint64_t>(number->GetValue());
+        auto root = static_cast<uint64_t>(std::sqrt(value));
+        for (auto candidate : {root - 1, root, root + 1}) {
+            if (candidate * candidate == square) {
+                return {MakeNode<Number>(static_cast<IntType>(candidate))};
+            }
+        }
+    } else if (auto* big = dynamic_cast<const BigInteger*>(args.front().get())) {
+        auto root = big->GetValue().Sqrt();
+        if (root * root == big->GetValue()) {
+            return {MakeInteger(std::move(root))};
+        }
+        // Beyond the range of double the value is infinite, but its root may not be.
+        return {MakeNode<Flonum>(std::isinf(value) ? root.ToDouble() : std::sqrt(value))};
+    }
+    return {MakeNode<Flonum>(std::sqrt(value))};
+}
+
+std::vector<ObjectPtr> FlonumFunction::DoCall(const std::vector<ObjectPtr>& args,
+                                              const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+
+    return {MakeNode<Flonum>(function_(GetDouble(args.front())))};
+}
+
 std::vector<ObjectPtr> IsBoolean::DoCall(const std::vector<ObjectPtr>& args,
                                          const std::shared_ptr<ScopesCollection>&) {
     AssertArgsCountEqual(args, 1);
@@ -73,6 +188,9 @@ std::vector<ObjectPtr> IsPair::DoCall(const std::vector<ObjectPtr>& args,
                                       const std::shared_ptr<ScopesCollection>&) {
     AssertArgsCountEqual(args, 1);
 
+    if (auto view = As<HostVector>(args.front())) {
+        return {MakeNode<Boolean>(view->GetElements().size() == 2)};
+    }
     auto flattened = Flatten(args.front());
     if (!flattened.empty() && flattened.back() == nullptr) {
         flattened.pop_back();
@@ -91,6 +209,9 @@ std::vector<ObjectPtr> IsList::DoCall(const std::vector<ObjectPtr>& args,
                                       const std::shared_ptr<ScopesCollection>&) {
     AssertArgsCountEqual(args, 1);
 
+    if (Is<HostVector>(args.front())) {
+        return {MakeNode<Boolean>(true)};
+    }
     auto flattened = Flatten(args.front());
     return {MakeNode<Boolean>(flattened.empty() || flattened.back() == nullptr)};
 }
@@ -112,6 +233,9 @@ std::vector<ObjectPtr> Car::DoCall(const std::vector<ObjectPtr>& args,
                                    const std::shared_ptr<ScopesCollection>&) {
     AssertArgsCountEqual(args, 1);
 
+    if (auto view = As<HostVector>(args.front())) {
+        return {view->GetFirst()};
+    }
     auto cell = As<Cell>(args.front());
     if (cell == nullptr) {
         throw RuntimeError("not a list");
@@ -124,6 +248,9 @@ std::vector<ObjectPtr> Cdr::DoCall(const std::vector<ObjectPtr>& args,
                                    const std::shared_ptr<ScopesCollection>&) {
     AssertArgsCountEqual(args, 1);
 
+    if (auto view = As<HostVector>(args.front())) {
+        return {view->GetTail(1)};
+    }
     auto cell = As<Cell>(args.front());
     if (cell == nullptr) {
         throw RuntimeError("not a list");
@@ -143,34 +270,82 @@ bool IsInBounds(IntType index, size_t size) {
     return index >= 0 && static_cast<size_t>(index) < size;
 }
 
+// The list without its first count elements, found by walking its pairs rather than copying
+// them; throws RuntimeError if the list is shorter.
+ObjectPtr GetListTail(ObjectPtr list, IntType count) {
+    if (count < 0) {
+        throw RuntimeError("index out of bounds");
+    }
+    for (; count > 0; --count) {
+        if (auto view = As<HostVector>(list)) {
+            if (static_cast<size_t>(count) > view->GetElements().size()) {
+                throw RuntimeError("index out of bounds");
+            }
+            return view->GetTail(count);
+        }
+        auto cell = As<Cell>(list);
+        if (cell == nullptr) {
+            throw RuntimeError("index out of bounds");
+        }
+        list = cell->GetSecond();
+    }
+    return list;
+}
+
 std::vector<ObjectPtr> ListRef::DoCall(const std::vector<ObjectPtr>& args,
                                        const std::shared_ptr<ScopesCollection>&) {
     AssertArgsCountEqual(args, 2);
 
-    auto flattened = Flatten(args.front());
-    auto index_num = GetNumber(args.back());
-    IntType index = index_num.GetValue();
-
-    if (!IsInBounds(index, flattened.size() - 1)) {
+    if (auto view = As<HostVector>(args.front())) {
+        IntType index = GetNumber(args.back()).GetValue();
+        if (!IsInBounds(index, view->GetElements().size())) {
+            throw RuntimeError("index out of bounds");
+        }
+        return {MakeNode<Number>(view->GetElements()[index])};
+    }
+    auto tail = GetListTail(args.front(), GetNumber(args.back()).GetValue());
+    if (auto view = As<HostVector>(tail)) {
+        return {view->GetFirst()};
+    }
+    auto cell = As<Cell>(tail);
+    if (cell == nullptr) {
         throw RuntimeError("index out of bounds");
     }
 
-    return {flattened[index]};
+    return {cell->GetFirst()};
 }
 
 std::vector<ObjectPtr> ListTail::DoCall(const std::vector<ObjectPtr>& args,
                                         const std::shared_ptr<ScopesCollection>&) {
     AssertArgsCountEqual(args, 2);
 
-    auto flattened = Flatten(args.front());
-    auto index_num = GetNumber(args.back());
-    IntType index = index_num.GetValue();
+    if (auto view = As<HostVector>(args.front())) {
+        IntType index = GetNumber(args.back()).GetValue();
+        if (!IsInBounds(index, view->GetElements().size() + 1)) {
+            throw RuntimeError("index out of bounds");
+        }
+        return {view->GetTail(index)};
+    }
+    return {GetListTail(args.front(), GetNumber(args.back()).GetValue())};
+}
 
-    if (!IsInBounds(index, flattened.size())) {
-        throw RuntimeError("index out of bounds");
+std::vector<ObjectPtr> Length::DoCall(const std::vector<ObjectPtr>& args,
+                                      const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+
+    IntType length = 0;
+    auto current = args.front();
+    while (auto cell = As<Cell>(current)) {
+        ++length;
+        current = cell->GetSecond();
+    }
+    if (auto view = As<HostVector>(current)) {
+        length += static_cast<IntType>(view->GetElements().size());
+    } else if (current != nullptr) {
+        throw RuntimeError("not a list");
     }
 
-    return {flattened.begin() + index, flattened.end()};
+    return {MakeNode<Number>(length)};
 }
 
 std::vector<ObjectPtr> If::DoCall(const std::vector<ObjectPtr>& args,
@@ -179,11 +354,11 @@ std::vector<ObjectPtr> If::DoCall(const std::vector<ObjectPtr>& args,
 
     bool condition = ToBool(::Evaluate(args.front(), scopes));
     if (condition) {
-        return Flatten(::Evaluate(args[1], scopes));
+        return {::Evaluate(args[1], scopes)};
     }
 
     if (!condition && args.size() > 2) {
-        return Flatten(::Evaluate(args[2], scopes));
+        return {::Evaluate(args[2], scopes)};
     }
 
     return {nullptr};
@@ -205,7 +380,7 @@ struct ScopeSetArgs {
 };
 
 ScopeSetArgs MakeScopeSetArgs(const std::vector<ObjectPtr>& args,
-                              const std::shared_ptr<ScopesCollection>& scopes) {
+                              const std::shared_ptr<ScopesCollection>& scopes, bool flat_bodies) {
     AssertArgsCountAtLeast<SyntaxError>(args, 1);
 
     if (auto cell = As<Cell>(args.front()); cell != nullptr) {
@@ -219,7 +394,7 @@ ScopeSetArgs MakeScopeSetArgs(const std::vector<ObjectPtr>& args,
         std::vector<ObjectPtr> lambda_args = {args.begin() + 1, args.end()};
         lambda_args.insert(lambda_args.begin(), arguments_list);
 
-        auto lambda = std::make_shared<Lambda>(lambda_args, scopes);
+        auto lambda = std::make_shared<Lambda>(lambda_args, scopes, flat_bodies);
         return {.key = func_name->GetName(), .value = lambda, .in_last_scope = true};
     }
 
@@ -235,7 +410,7 @@ ScopeSetArgs MakeScopeSetArgs(const std::vector<ObjectPtr>& args,
 
 std::vector<ObjectPtr> Define::DoCall(const std::vector<ObjectPtr>& args,
                                       const std::shared_ptr<ScopesCollection>& scopes) {
-    auto scope_set_args = MakeScopeSetArgs(args, scopes);
+    auto scope_set_args = MakeScopeSetArgs(args, scopes, flat_bodies_);
 
     scopes->Set(scope_set_args.key, scope_set_args.value, scope_set_args.in_last_scope);
     return {nullptr};
@@ -247,7 +422,8 @@ std::vector<ObjectPtr> Set::DoCall(const std::vector<ObjectPtr>& args,
 
     auto symbol = GetSymbol(args.front());
 
-    if (scopes->Get(symbol->GetName()) == nullptr) {
+    ObjectPtr value;
+    if (!scopes->Lookup(symbol->GetName(), &value)) {
         throw NameError("no such object");
     }
 
@@ -257,15 +433,24 @@ std::vector<ObjectPtr> Set::DoCall(const std::vector<ObjectPtr>& args,
     return {nullptr};
 }
 
-std::vector<ObjectPtr> SetCar::DoCall(const std::vector<ObjectPtr>& args,
-                                      const std::shared_ptr<ScopesCollection>&) {
-    AssertArgsCountEqual(args, 2);
-
-    auto cell = As<Cell>(args.front());
+std::shared_ptr<Cell> GetMutablePair(const ObjectPtr& object) {
+    auto cell = As<Cell>(object);
     if (cell == nullptr) {
         throw RuntimeError("not a pair");
     }
+    if (cell->IsConstant()) {
+        throw RuntimeError("can't modify a shared constant");
+    }
+
+    cell->MarkMutated();
+    return cell;
+}
+
+std::vector<ObjectPtr> SetCar::DoCall(const std::vector<ObjectPtr>& args,
+                                      const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 2);
 
+    auto cell = GetMutablePair(args.front());
     cell->SetFirst(args[1]);
     return {nullptr};
 }
@@ -274,62 +459,144 @@ std::vector<ObjectPtr> SetCdr::DoCall(const std::vector<ObjectPtr>& args,
                                       const std::shared_ptr<ScopesCollection>&) {
     AssertArgsCountEqual(args, 2);
 
-    auto cell = As<Cell>(args.front());
-    if (cell == nullptr) {
-        throw RuntimeError("not a pair");
-    }
-
+    auto cell = GetMutablePair(args.front());
     cell->SetSecond(args[1]);
     return {nullptr};
 }
 
-std::vector<ObjectPtr> Lambda::DoCall(const std::vector<ObjectPtr>& args,
-                                      const std::shared_ptr<ScopesCollection>& scopes) {
-    AssertArgsCountEqual(args, arguments_list_.size());
+Lambda::Lambda(std::vector<ObjectPtr> args, const std::shared_ptr<ScopesCollection>& scopes,
+               bool flat_body)
+    : captured_scopes_(scopes), flat_body_(flat_body) {
+    AssertArgsCountAtLeast<SyntaxError>(args, 2);
+
+    auto flattened_args_list = Flatten(args.front());
+    flattened_args_list.pop_back();
+    std::vector<std::shared_ptr<Symbol>> arguments_list;
+    arguments_list.reserve(flattened_args_list.size());
+    for (const auto& ptr : flattened_args_list) {
+        auto symbol = As<Symbol>(ptr);
+        if (symbol == nullptr) {
+            throw SyntaxError("argument should be a symbol");
+        }
+
+        arguments_list.push_back(std::move(symbol));
+    }
+    arguments_list_ = std::move(arguments_list);
+
+    body_ = {args.begin() + 1, args.end()};
+}
+
+Lambda::~Lambda() = default;
+
+void Lambda::PrepareBody() {
+    if (body_.size() == 1) {
+        if (auto lazy = As<DeferredBody>(body_.front())) {
+            body_ = lazy->ReadForms();
+        }
+    }
+    if (flat_body_) {
+        flat_program_ = std::make_unique<FlatProgram>(body_);
+    }
+}
+
+ObjectPtr Lambda::Invoke(const std::vector<ObjectPtr>& values,
+                         const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(values, arguments_list_.size());
+    CheckCancelled();
 
     std::unordered_map<std::string, std::shared_ptr<Object>> args_symbols;
     for (size_t i = 0; i < arguments_list_.size(); ++i) {
-        args_symbols[arguments_list_[i]->GetName()] = ::Evaluate(args[i], scopes);
+        args_symbols[arguments_list_[i]->GetName()] = values[i];
     }
     auto args_scope = std::make_shared<Scope>(args_symbols, nullptr);
     auto lambda_scopes =
         std::make_shared<ScopesCollection>(std::vector<std::shared_ptr<Scope>>{args_scope});
+    // Lexical scoping only: appending the caller's scopes as well made the list grow with
+    // every call made from a delayed body, so a stream slowed down as it was walked.
     lambda_scopes->AddScopes(captured_scopes_);
-    lambda_scopes->AddScopes(scopes);
 
-    for (size_t i = 0; i < body_.size(); ++i) {
-        auto res = ::Evaluate(body_[i], lambda_scopes);
-        if (i + 1 == body_.size()) {
-            return {res};
-        }
+    std::call_once(prepare_once_, [this] { PrepareBody(); });
+    if (flat_program_ != nullptr) {
+        return flat_program_->Evaluate(lambda_scopes);
     }
 
-    return {nullptr};
+    ObjectPtr res;
+    for (const auto& form : body_) {
+        res = ::Evaluate(form, lambda_scopes);
+    }
+    return res;
+}
+
+std::vector<ObjectPtr> Lambda::DoCall(const std::vector<ObjectPtr>& args,
+                                      const std::shared_ptr<ScopesCollection>& scopes) {
+    AssertArgsCountEqual(args, arguments_list_.size());
+
+    std::vector<ObjectPtr> values;
+    values.reserve(args.size());
+    for (const auto& arg : args) {
+        values.push_back(::Evaluate(arg, scopes));
+    }
+    return {Invoke(values, scopes)};
 }
 
 std::vector<ObjectPtr> LambdaMaker::DoCall(const std::vector<ObjectPtr>& args,
                                            const std::shared_ptr<ScopesCollection>& scopes) {
-    return {std::make_shared<Lambda>(args, scopes)};
+    return {std::make_shared<Lambda>(args, scopes, flat_bodies_)};
+}
+
+// The interpreter's global scope: the one among scopes and their parents that is chained to
+// the builtins.
+std::shared_ptr<Scope> FindGlobalScope(const std::shared_ptr<ScopesCollection>& scopes) {
+    auto builtins = GetBuiltinsScope();
+    for (const auto& scope : scopes->GetScopes()) {
+        for (auto cur = scope; cur != nullptr; cur = cur->GetParent()) {
+            if (cur->GetParent() == builtins) {
+                return cur;
+            }
+        }
+    }
+    throw RuntimeError("no global environment");
+}
+
+std::vector<ObjectPtr> Load::DoCall(const std::vector<ObjectPtr>& args,
+                                    const std::shared_ptr<ScopesCollection>& scopes) {
+    AssertArgsCountEqual(args, 1);
+
+    auto path = As<String>(args.front());
+    if (path == nullptr) {
+        throw RuntimeError("expected file name string");
+    }
+
+    auto options = read_options_;
+    options.source = MapSourceFile(path->GetValue());
+    MemoryStream stream{options.source->text};
+    Tokenizer tokenizer{&stream};
+    auto global = std::make_shared<ScopesCollection>(
+        std::vector<std::shared_ptr<Scope>>{FindGlobalScope(scopes)});
+    EvaluateForms(&tokenizer, global, options);
+
+    return {nullptr};
 }
 
 std::shared_ptr<Scope> CreateBuiltinsScope() {
     return std::make_shared<Scope>(
         std::unordered_map<std::string, std::shared_ptr<Object>>{
-            {"number?", MakeNode<IsType<Number>>()},
-            {"<", MakeNode<Comparison<std::less<IntType>>>(std::less<IntType>{})},
-            {"=", MakeNode<Comparison<std::equal_to<IntType>>>(std::equal_to<IntType>{})},
-            {">", MakeNode<Comparison<std::greater<IntType>>>(std::greater<IntType>{})},
-            {"<=", MakeNode<Comparison<std::less_equal<IntType>>>(std::less_equal<IntType>{})},
-            {">=",
-             MakeNode<Comparison<std::greater_equal<IntType>>>(std::greater_equal<IntType>{})},
-            {"+", MakeNode<BinaryApplier<std::plus<IntType>>>(std::plus<IntType>{}, Number(0))},
-            {"-", MakeNode<BinaryApplier<std::minus<IntType>>>(std::minus<IntType>{})},
-            {"/", MakeNode<BinaryApplier<std::divides<IntType>>>(std::divides<IntType>{})},
-            {"*", MakeNode<BinaryApplier<std::multiplies<IntType>>>(std::multiplies<IntType>{},
-                                                                    Number(1))},
+            {"number?", MakeNode<IsNumber>()},
+            {"<", MakeNode<Comparison<std::less<>>>(std::less<>{})},
+            {"=", MakeNode<Comparison<std::equal_to<>>>(std::equal_to<>{})},
+            {">", MakeNode<Comparison<std::greater<>>>(std::greater<>{})},
+            {"<=", MakeNode<Comparison<std::less_equal<>>>(std::less_equal<>{})},
+            {">=", MakeNode<Comparison<std::greater_equal<>>>(std::greater_equal<>{})},
+            {"+", MakeNode<BinaryApplier<Adder>>(Adder{}, Number(0))},
+            {"-", MakeNode<BinaryApplier<Subtracter>>(Subtracter{})},
+            {"/", MakeNode<BinaryApplier<Divider>>(Divider{})},
+            {"*", MakeNode<BinaryApplier<Multiplier>>(Multiplier{}, Number(1))},
             {"max", MakeNode<BinaryApplier<Maxer>>(Maxer{})},
             {"min", MakeNode<BinaryApplier<Miner>>(Miner{})},
             {"abs", MakeNode<UnaryApplier<Abser>>(Abser{})},
+            {"floor", MakeNode<UnaryApplier<Floorer>>(Floorer{})},
+            {"sqrt", MakeNode<Sqrt>()},
+            {"exp", MakeNode<FlonumFunction>([](double value) { return std::exp(value); })},
 
             {"boolean?", MakeNode<IsBoolean>()},
             {"quote", MakeNode<QuoteFunction>()},
@@ -347,6 +614,17 @@ std::shared_ptr<Scope> CreateBuiltinsScope() {
             {"list", MakeNode<List>()},
             {"list-ref", MakeNode<ListRef>()},
             {"list-tail", MakeNode<ListTail>()},
+            {"length", MakeNode<Length>()},
+
+            {"vector?", MakeNode<IsType<Vector>>()},
+            {"make-vector", MakeNode<MakeVector>()},
+            {"vector", MakeNode<VectorOf>()},
+            {"vector-ref", MakeNode<VectorRef>()},
+            {"vector-set!", MakeNode<VectorSet>()},
+            {"vector-length", MakeNode<VectorLength>()},
+            {"vector-fill!", MakeNode<VectorFill>()},
+            {"list->vector", MakeNode<ListToVector>()},
+            {"vector->list", MakeNode<VectorToList>()},
 
             {"if", MakeNode<If>()},
             {"define", MakeNode<Define>()},
@@ -356,10 +634,57 @@ std::shared_ptr<Scope> CreateBuiltinsScope() {
             {"set-cdr!", MakeNode<SetCdr>()},
 
             {"lambda", MakeNode<LambdaMaker>()},
+
+            {"string?", MakeNode<IsType<String>>()},
+            {"load", MakeNode<Load>()},
+
+            {"current-output-port",
+             MakeNode<CurrentPort>(std::make_shared<OutputPort>(&std::cout))},
+            {"current-input-port", MakeNode<CurrentPort>(std::make_shared<InputPort>(&std::cin))},
+            {"display", MakeNode<WriteValue>(true)},
+            {"write", MakeNode<WriteValue>(false)},
+            {"newline", MakeNode<Newline>()},
+            {"flush-output-port", MakeNode<FlushOutputPort>()},
+            {"read-char", MakeNode<ReadFromPort>(&InputPort::ReadChar)},
+            {"peek-char", MakeNode<ReadFromPort>(&InputPort::PeekChar)},
+            {"read-line", MakeNode<ReadFromPort>(&InputPort::ReadLine)},
+            {"read", MakeNode<ReadFromPort>(&InputPort::ReadDatum)},
+            {"open-input-file", MakeNode<OpenFilePort>(false)},
+            {"open-output-file", MakeNode<OpenFilePort>(true)},
+            {"open-input-string", MakeNode<OpenInputString>()},
+            {"open-output-string", MakeNode<OpenOutputString>()},
+            {"get-output-string", MakeNode<GetOutputString>()},
+            {"close-port", MakeNode<ClosePort>()},
+            {"close-input-port", MakeNode<ClosePort>()},
+            {"close-output-port", MakeNode<ClosePort>()},
+            {"input-port?", MakeNode<IsType<InputPort>>()},
+            {"output-port?", MakeNode<IsType<OutputPort>>()},
+            {"eof-object?", MakeNode<IsType<EofObject>>()},
+
+            {"delay", MakeNode<Delay>(false)},
+            {"delay-force", MakeNode<Delay>(true)},
+            {"force", MakeNode<ForcePromise>()},
+            {"make-promise", MakeNode<MakePromise>()},
+            {"promise?", MakeNode<IsType<Promise>>()},
+            {"cons-stream", MakeNode<ConsStream>()},
+            {"stream-car", MakeNode<StreamCar>()},
+            {"stream-cdr", MakeNode<StreamCdr>()},
+            {"stream-pair?", MakeNode<IsStreamPair>()},
+            {"stream-null?", MakeNode<IsNull>()},
+            {"stream-map", MakeNode<StreamMap>()},
+            {"stream-filter", MakeNode<StreamFilter>()},
+            {"stream-take", MakeNode<StreamTake>()},
+            {"stream-ref", MakeNode<StreamRef>()},
+            {"stream->list", MakeNode<StreamToList>()},
+            {"stream-for-each", MakeNode<StreamForEach>()},
         },
         nullptr);
 }
 std::shared_ptr<Scope> GetBuiltinsScope() {
-    static std::shared_ptr<Scope> kBuiltins = CreateBuiltinsScope();
+    static std::shared_ptr<Scope> kBuiltins = [] {
+        auto builtins = CreateBuiltinsScope();
+        builtins->Freeze();
+        return builtins;
+    }();
     return kBuiltins;
 }
\ No newline at end of file
@@ -1,15 +1,20 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <sstream>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <optional>
+#include <bigint.h>
 #include <object.h>
 #include "representation.h"
+#include <parser.h>
 
 template <typename... Args>
 std::string FormatString(const std::string& format, Args&&... args) {
@@ -51,16 +56,85 @@ void AssertArgsCountBetween(const std::vector<ObjectPtr>& args, size_t start, si
     }
 }
 
+// Arithmetic for BinaryApplier and UnaryApplier. The IntType overloads store the result in
+// *result and return false if it doesn't fit; the operation is then redone on BigInts. The
+// double overloads are used once a Flonum is involved.
+struct Adder {
+    bool operator()(IntType first, IntType second, IntType* result) const {
+        return !__builtin_add_overflow(first, second, result);
+    }
+    BigInt operator()(const BigInt& first, const BigInt& second) const;
+    double operator()(double first, double second) const {
+        return first + second;
+    }
+};
+
+struct Subtracter {
+    bool operator()(IntType first, IntType second, IntType* result) const {
+        return !__builtin_sub_overflow(first, second, result);
+    }
+    BigInt operator()(const BigInt& first, const BigInt& second) const;
+    double operator()(double first, double second) const {
+        return first - second;
+    }
+};
+
+struct Multiplier {
+    bool operator()(IntType first, IntType second, IntType* result) const {
+        return !__builtin_mul_overflow(first, second, result);
+    }
+    BigInt operator()(const BigInt& first, const BigInt& second) const;
+    double operator()(double first, double second) const {
+        return first * second;
+    }
+};
+
+// Truncates integers and throws RuntimeError on their division by zero; divides Flonums
+// exactly as doubles.
+struct Divider {
+    bool operator()(IntType first, IntType second, IntType* result) const;
+    BigInt operator()(const BigInt& first, const BigInt& second) const;
+    double operator()(double first, double second) const {
+        return first / second;
+    }
+};
+
 struct Maxer {
-    IntType operator()(IntType first, IntType second);
+    bool operator()(IntType first, IntType second, IntType* result) const;
+    BigInt operator()(const BigInt& first, const BigInt& second) const;
+    double operator()(double first, double second) const {
+        return std::max(first, second);
+    }
 };
 
 struct Miner {
-    IntType operator()(IntType first, IntType second);
+    bool operator()(IntType first, IntType second, IntType* result) const;
+    BigInt operator()(const BigInt& first, const BigInt& second) const;
+    double operator()(double first, double second) const {
+        return std::min(first, second);
+    }
 };
 
 struct Abser {
-    IntType operator()(IntType number);
+    bool operator()(IntType number, IntType* result) const;
+    BigInt operator()(const BigInt& number) const;
+    double operator()(double number) const {
+        return std::abs(number);
+    }
+};
+
+// Integers are their own floor.
+struct Floorer {
+    bool operator()(IntType number, IntType* result) const {
+        *result = number;
+        return true;
+    }
+    BigInt operator()(const BigInt& number) const {
+        return number;
+    }
+    double operator()(double number) const {
+        return std::floor(number);
+    }
 };
 
 template <typename Type>
@@ -83,6 +157,12 @@ public:
                                   const std::shared_ptr<ScopesCollection>& scopes);
 };
 
+class IsNumber : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
 template <typename Comparator>
 class Comparison : public EvaluatingArgumentFunction {
 public:
@@ -98,16 +178,31 @@ private:
 
 const Number& GetNumber(const ObjectPtr& object);
 
+// The value of any number as a double; throws RuntimeError for other objects.
+double GetDouble(const ObjectPtr& object);
+
+// Negative, zero or positive as first is less than, equal to or greater than second; both
+// must be integers.
+IntType CompareIntegers(const ObjectPtr& first, const ObjectPtr& second);
+
 template <typename Comparator>
 std::vector<ObjectPtr> Comparison<Comparator>::DoCall(const std::vector<ObjectPtr>& args,
                                                       const std::shared_ptr<ScopesCollection>&) {
     bool answer = true;
 
     for (size_t i = 0; i + 1 < args.size(); ++i) {
-        const auto& left = GetNumber(args[i]);
-        const auto& right = GetNumber(args[i + 1]);
+        auto* left = dynamic_cast<const Number*>(args[i].get());
+        auto* right = dynamic_cast<const Number*>(args[i + 1].get());
+        bool holds;
+        if (left != nullptr && right != nullptr) {
+            holds = comparator_(left->GetValue(), right->GetValue());
+        } else if (Is<Flonum>(args[i]) || Is<Flonum>(args[i + 1])) {
+            holds = comparator_(GetDouble(args[i]), GetDouble(args[i + 1]));
+        } else {
+            holds = comparator_(CompareIntegers(args[i], args[i + 1]), 0);
+        }
 
-        if (!comparator_(left.GetValue(), right.GetValue())) {
+        if (!holds) {
             answer = false;
             break;
         }
@@ -143,13 +238,48 @@ std::vector<ObjectPtr> BinaryApplier<Op>::DoCall(const std::vector<ObjectPtr>& a
         return {MakeNode<Number>(default_value_.value())};
     }
 
-    auto answer = GetNumber(args.front());
+    // Fixnums are combined without allocating; the first overflow switches to BigInts. The
+    // first Flonum switches to doubles, which are kept unboxed as well.
+    IntType answer = 0;
+    std::optional<BigInt> big_answer;
+    std::optional<double> float_answer;
+    if (auto* number = dynamic_cast<const Number*>(args.front().get())) {
+        answer = number->GetValue();
+    } else if (auto* flonum = dynamic_cast<const Flonum*>(args.front().get())) {
+        float_answer = flonum->GetValue();
+    } else {
+        big_answer = GetBigInt(args.front());
+    }
 
     for (size_t i = 1; i < args.size(); ++i) {
-        auto right = GetNumber(args[i]);
-        answer = Number(op_(answer.GetValue(), right.GetValue()));
+        if (!big_answer.has_value() && !float_answer.has_value()) {
+            auto* right = dynamic_cast<const Number*>(args[i].get());
+            IntType result;
+            if (right != nullptr && op_(answer, right->GetValue(), &result)) {
+                answer = result;
+                continue;
+            }
+        }
+        if (!float_answer.has_value() && Is<Flonum>(args[i])) {
+            float_answer =
+                big_answer.has_value() ? big_answer->ToDouble() : static_cast<double>(answer);
+        }
+        if (float_answer.has_value()) {
+            float_answer = op_(*float_answer, GetDouble(args[i]));
+            continue;
+        }
+        if (!big_answer.has_value()) {
+            big_answer = BigInt(answer);
+        }
+        big_answer = op_(*big_answer, GetBigInt(args[i]));
     }
 
+    if (float_answer.has_value()) {
+        return {MakeNode<Flonum>(*float_answer)};
+    }
+    if (big_answer.has_value()) {
+        return {MakeInteger(std::move(*big_answer))};
+    }
     return {MakeNode<Number>(answer)};
 }
 
@@ -170,11 +300,39 @@ template <typename Op>
 std::vector<ObjectPtr> UnaryApplier<Op>::DoCall(const std::vector<ObjectPtr>& args,
                                                 const std::shared_ptr<ScopesCollection>&) {
     AssertArgsCountEqual(args, 1);
-    auto answer = GetNumber(args.front());
-    answer = Number(op_(answer.GetValue()));
-    return {MakeNode<Number>(answer)};
+    if (auto* number = dynamic_cast<const Number*>(args.front().get())) {
+        IntType result;
+        if (op_(number->GetValue(), &result)) {
+            return {MakeNode<Number>(result)};
+        }
+    }
+    if (auto* flonum = dynamic_cast<const Flonum*>(args.front().get())) {
+        return {MakeNode<Flonum>(op_(flonum->GetValue()))};
+    }
+    return {MakeInteger(op_(GetBigInt(args.front())))};
 }
 
+// Exact for the squares of integers, a Flonum otherwise; throws RuntimeError for negative
+// numbers.
+class Sqrt : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+// Applies a function of one double; the result is always a Flonum.
+class FlonumFunction : public EvaluatingArgumentFunction {
+public:
+    FlonumFunction(double (*function)(double)) : function_(function) {
+    }
+
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+
+private:
+    double (*function_)(double);
+};
+
 class QuoteFunction : public UnevaluatingArgumentFunction {
 public:
     std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
@@ -191,6 +349,11 @@ class BoolExpressionEvaluator : public UnevaluatingArgumentFunction {
 public:
     BoolExpressionEvaluator(bool expected);
 
+    // The value that stops evaluation: false for and, true for or.
+    bool GetExpected() const {
+        return expected_;
+    }
+
     std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
                                   const std::shared_ptr<ScopesCollection>& scopes);
 
@@ -252,6 +415,12 @@ public:
                                   const std::shared_ptr<ScopesCollection>& scopes);
 };
 
+class Length : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
 class If : public UnevaluatingArgumentFunction {
 public:
     std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
@@ -260,8 +429,16 @@ public:
 
 class Define : public UnevaluatingArgumentFunction {
 public:
+    Define() = default;
+    // If flat_bodies is set, functions defined with (define (f ...) ...) run flat (see Lambda).
+    Define(bool flat_bodies) : flat_bodies_(flat_bodies) {
+    }
+
     std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
                                   const std::shared_ptr<ScopesCollection>& scopes);
+
+private:
+    bool flat_bodies_ = false;
 };
 
 class Set : public UnevaluatingArgumentFunction {
@@ -282,27 +459,38 @@ public:
                                   const std::shared_ptr<ScopesCollection>& scopes);
 };
 
+class FlatProgram;
+
 class Lambda : public UnevaluatingArgumentFunction {
 public:
-    Lambda(std::vector<ObjectPtr> args, const std::shared_ptr<ScopesCollection>& scopes)
-        : captured_scopes_(scopes) {
-        AssertArgsCountAtLeast<SyntaxError>(args, 2);
-
-        auto flattened_args_list = Flatten(args.front());
-        flattened_args_list.pop_back();
-        std::vector<std::shared_ptr<Symbol>> arguments_list;
-        arguments_list.reserve(flattened_args_list.size());
-        for (const auto& ptr : flattened_args_list) {
-            auto symbol = As<Symbol>(ptr);
-            if (symbol == nullptr) {
-                throw SyntaxError("argument should be a symbol");
-            }
+    // If flat_body is set, the body is flattened on the first call and evaluated as a
+    // FlatProgram.
+    Lambda(std::vector<ObjectPtr> args, const std::shared_ptr<ScopesCollection>& scopes,
+           bool flat_body = false);
+    ~Lambda() override;
+
+    size_t GetArity() const {
+        return arguments_list_.size();
+    }
 
-            arguments_list.push_back(std::move(symbol));
-        }
-        arguments_list_ = std::move(arguments_list);
+    // Runs the body with already evaluated arguments. The body is lexically scoped: names not
+    // bound by the arguments resolve in the scopes captured when the lambda was made, never in
+    // the caller's scopes.
+    ObjectPtr Invoke(const std::vector<ObjectPtr>& values,
+                     const std::shared_ptr<ScopesCollection>& scopes);
 
-        body_ = {args.begin() + 1, args.end()};
+    const std::vector<std::shared_ptr<Symbol>>& GetArguments() const {
+        return arguments_list_;
+    }
+    // The body forms, or a single DeferredBody before the first call.
+    const std::vector<ObjectPtr>& GetBody() const {
+        return body_;
+    }
+    const std::shared_ptr<ScopesCollection>& GetCapturedScopes() const {
+        return captured_scopes_;
+    }
+    bool HasFlatBody() const {
+        return flat_body_;
     }
 
     std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
@@ -312,12 +500,40 @@ private:
     std::shared_ptr<ScopesCollection> captured_scopes_;
     std::vector<std::shared_ptr<Symbol>> arguments_list_;
     std::vector<ObjectPtr> body_;
+    bool flat_body_;
+    std::once_flag prepare_once_;
+    std::unique_ptr<FlatProgram> flat_program_;
+
+    // Reads a lazy body and flattens the body if needed; runs before the first call.
+    void PrepareBody();
 };
 
 class LambdaMaker : public UnevaluatingArgumentFunction {
 public:
+    LambdaMaker() = default;
+    LambdaMaker(bool flat_bodies) : flat_bodies_(flat_bodies) {
+    }
+
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+
+private:
+    bool flat_bodies_ = false;
+};
+
+// Evaluates every form of a source file in the global environment of the calling interpreter,
+// even when called from a procedure; the file is memory-mapped.
+class Load : public EvaluatingArgumentFunction {
+public:
+    Load() = default;
+    Load(ReadOptions read_options) : read_options_(std::move(read_options)) {
+    }
+
     std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
                                   const std::shared_ptr<ScopesCollection>& scopes);
+
+private:
+    ReadOptions read_options_;
 };
 
 std::shared_ptr<Scope> CreateBuiltinsScope();
@@ -0,0 +1,33 @@
+#include "host_vector.h"
+
+#include <string>
+
+ObjectPtr HostVector::GetFirst() const {
+    return MakeNode<Number>(elements_.front());
+}
+
+ObjectPtr HostVector::GetTail(size_t count) const {
+    return MakeHostList(elements_.subspan(count), owner_);
+}
+
+std::string HostVector::Serialize() {
+    std::string answer = "(";
+    for (size_t i = 0; i < elements_.size(); ++i) {
+        if (i > 0) {
+            answer += ' ';
+        }
+        answer += std::to_string(elements_[i]);
+    }
+    return answer + ")";
+}
+
+ObjectPtr HostVector::Evaluate(const std::shared_ptr<ScopesCollection>&) {
+    throw RuntimeError("not a function");
+}
+
+ObjectPtr MakeHostList(std::span<const IntType> elements, std::shared_ptr<const void> owner) {
+    if (elements.empty()) {
+        return nullptr;
+    }
+    return MakeNode<HostVector>(elements, std::move(owner));
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <object.h>
+
+// Read-only list view over integers owned by the host. Builtins that walk lists (car, cdr,
+// length, list-ref, list-tail, ...) work on it directly; elements are boxed one at a time
+// when they are taken out.
+//
+// Lifetime contract: the elements are not copied. Unless `owner` keeps them alive, the host
+// must keep the memory valid and unchanged for as long as the interpreter can reach the view
+// or any tail of it taken with cdr or list-tail.
+class HostVector : public Object {
+public:
+    HostVector(std::span<const IntType> elements, std::shared_ptr<const void> owner)
+        : elements_(elements), owner_(std::move(owner)) {
+    }
+
+    std::span<const IntType> GetElements() const {
+        return elements_;
+    }
+
+    ObjectPtr GetFirst() const;
+    // The view without its first `count` elements, or () if nothing is left.
+    ObjectPtr GetTail(size_t count) const;
+
+    std::string Serialize() override;
+    ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) override;
+
+private:
+    std::span<const IntType> elements_;
+    std::shared_ptr<const void> owner_;
+};
+
+// Views of empty spans are ().
+ObjectPtr MakeHostList(std::span<const IntType> elements,
+                       std::shared_ptr<const void> owner = nullptr);
@@ -0,0 +1,614 @@
+#include "image.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <bigint.h>
+#include <error.h>
+#include <evaluate.h>
+#include <funcs.h>
+#include <lazy_body.h>
+#include <mapped_file.h>
+#include <representation.h>
+
+namespace {
+
+// Objects the image can't hold by value; they are referred to by their name in the
+// environment.
+bool IsEnvironmentObject(const ObjectPtr& object) {
+    return object != nullptr && !Is<Number>(object) && !Is<Flonum>(object) &&
+           !Is<BigInteger>(object) && !Is<Symbol>(object) && !Is<String>(object) &&
+           !Is<Boolean>(object) && !Is<Cell>(object) && !Is<Lambda>(object);
+}
+
+class ImageWriter {
+public:
+    ImageWriter(const std::shared_ptr<Scope>& global,
+                const std::unordered_set<std::string>& host_names)
+        : host_names_(host_names) {
+        for (const auto& [name, value] : GetBuiltinsScope()->GetObjects()) {
+            builtin_names_.try_emplace(value.get(), name);
+        }
+        for (const auto& name : host_names) {
+            ObjectPtr value;
+            if (global->GetObjects().contains(name) && global->Lookup(name, &value) &&
+                IsEnvironmentObject(value)) {
+                host_object_names_.insert_or_assign(value.get(), name);
+            }
+        }
+        AddScope(global);
+    }
+
+    void Write(std::ostream* out) {
+        for (size_t i = 0; i < scopes_.size(); ++i) {
+            AddBindings(i);
+        }
+
+        ImageHeader header{};
+        std::memcpy(header.magic, kImageMagic, sizeof(header.magic));
+        header.version = kImageVersion;
+        header.name_count = static_cast<uint32_t>(names_.size());
+        header.node_count = static_cast<uint32_t>(nodes_.size());
+        header.link_count = static_cast<uint32_t>(links_.size());
+        header.scope_count = static_cast<uint32_t>(scopes_.size());
+        header.binding_count = static_cast<uint32_t>(bindings_.size());
+        header.names_size = names_blob_.size();
+
+        WriteArray(out, &header, 1);
+        WriteArray(out, names_.data(), names_.size());
+        WriteArray(out, nodes_.data(), nodes_.size());
+        WriteArray(out, links_.data(), links_.size());
+        WriteArray(out, scopes_.data(), scopes_.size());
+        WriteArray(out, bindings_.data(), bindings_.size());
+        WriteArray(out, names_blob_.data(), names_blob_.size());
+    }
+
+private:
+    const std::unordered_set<std::string>& host_names_;
+    std::vector<ImageName> names_;
+    std::string names_blob_;
+    std::vector<ImageNode> nodes_;
+    std::vector<uint32_t> links_;
+    std::vector<ImageScope> scopes_;
+    std::vector<ImageBinding> bindings_;
+
+    std::unordered_map<const Object*, std::string> builtin_names_;
+    std::unordered_map<const Object*, std::string> host_object_names_;
+    std::unordered_map<std::string, uint32_t> name_indices_;
+    std::unordered_map<uint32_t, uint32_t> symbol_nodes_;
+    std::unordered_map<uint32_t, uint32_t> string_nodes_;
+    std::unordered_map<int64_t, uint32_t> number_nodes_;
+    std::unordered_map<int64_t, uint32_t> flonum_nodes_;
+    std::unordered_map<uint32_t, uint32_t> big_number_nodes_;
+    // Hold the written objects and scopes, so their addresses can't be reused.
+    std::unordered_map<ObjectPtr, uint32_t> node_indices_;
+    std::unordered_map<std::shared_ptr<ScopesCollection>, uint32_t> scope_list_indices_;
+    std::unordered_map<std::shared_ptr<Scope>, uint32_t> scope_indices_;
+    std::vector<std::shared_ptr<Scope>> scope_objects_;
+    // Cells and lambdas whose operands are still to be written.
+    std::vector<std::pair<ObjectPtr, uint32_t>> pending_;
+
+    template <typename T>
+    static void WriteArray(std::ostream* out, const T* data, size_t count) {
+        out->write(reinterpret_cast<const char*>(data),
+                   static_cast<std::streamsize>(count * sizeof(T)));
+    }
+
+    uint32_t AddName(const std::string& name) {
+        auto [it, inserted] = name_indices_.try_emplace(name, names_.size());
+        if (inserted) {
+            names_.push_back({static_cast<uint32_t>(names_blob_.size()),
+                              static_cast<uint32_t>(name.size())});
+            names_blob_ += name;
+        }
+        return it->second;
+    }
+
+    uint32_t Emit(ImageNode node) {
+        nodes_.push_back(node);
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    template <typename Key>
+    uint32_t EmitAtom(std::unordered_map<Key, uint32_t>* atom_nodes, Key key, ImageNode node) {
+        if (auto it = atom_nodes->find(key); it != atom_nodes->end()) {
+            return it->second;
+        }
+        auto index = Emit(node);
+        atom_nodes->emplace(key, index);
+        return index;
+    }
+
+    void AddBindings(size_t index) {
+        auto scope = scope_objects_[index];
+        std::vector<std::pair<std::string, ObjectPtr>> objects(scope->GetObjects().begin(),
+                                                               scope->GetObjects().end());
+        std::sort(objects.begin(), objects.end(),
+                  [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+        auto first_binding = static_cast<uint32_t>(bindings_.size());
+        for (const auto& [name, value] : objects) {
+            if (index == 0 && host_names_.contains(name) && IsEnvironmentObject(value)) {
+                // Provided by the restoring interpreter.
+                continue;
+            }
+            bindings_.push_back({AddName(name), AddObject(value)});
+        }
+        scopes_[index] = {.parent = AddScope(scope->GetParent()),
+                          .first_binding = first_binding,
+                          .binding_count = static_cast<uint32_t>(bindings_.size() - first_binding),
+                          .reserved = 0};
+    }
+
+    uint32_t AddScope(const std::shared_ptr<Scope>& scope) {
+        if (scope == nullptr) {
+            return kImageNil;
+        }
+        if (scope == GetBuiltinsScope()) {
+            return kImageBuiltins;
+        }
+        auto [it, inserted] = scope_indices_.try_emplace(scope, scopes_.size());
+        if (inserted) {
+            // Bindings are added by Write, one scope after another.
+            scopes_.emplace_back();
+            scope_objects_.push_back(scope);
+        }
+        return it->second;
+    }
+
+    uint32_t AddScopeList(const std::shared_ptr<ScopesCollection>& scopes) {
+        if (auto it = scope_list_indices_.find(scopes); it != scope_list_indices_.end()) {
+            return it->second;
+        }
+        std::vector<uint32_t> indices;
+        if (scopes != nullptr) {
+            for (const auto& scope : scopes->GetScopes()) {
+                indices.push_back(AddScope(scope));
+            }
+        }
+        auto index = Emit({ImageKind::SCOPES, static_cast<uint32_t>(links_.size()),
+                           static_cast<int64_t>(indices.size())});
+        links_.insert(links_.end(), indices.begin(), indices.end());
+        scope_list_indices_.emplace(scopes, index);
+        return index;
+    }
+
+    // Writes the object and everything it reaches, with an explicit work list.
+    uint32_t AddObject(const ObjectPtr& root) {
+        auto index = IndexOf(root);
+        while (!pending_.empty()) {
+            auto [object, node] = std::move(pending_.back());
+            pending_.pop_back();
+            if (auto cell = As<Cell>(object)) {
+                auto first = IndexOf(cell->GetFirst());
+                auto second = IndexOf(cell->GetSecond());
+                nodes_[node].index = first;
+                nodes_[node].value = second;
+            } else {
+                FillLambda(static_cast<const Lambda&>(*object), node);
+            }
+        }
+        return index;
+    }
+
+    void FillLambda(const Lambda& lambda, uint32_t node) {
+        std::vector<ObjectPtr> arguments(lambda.GetArguments().begin(),
+                                         lambda.GetArguments().end());
+        auto body = lambda.GetBody();
+        if (body.size() == 1) {
+            if (auto deferred = As<DeferredBody>(body.front())) {
+                body = deferred->ReadForms();
+            }
+        }
+
+        uint32_t operands[] = {AddList(arguments), AddList(body),
+                               AddScopeList(lambda.GetCapturedScopes())};
+        nodes_[node].index = static_cast<uint32_t>(links_.size());
+        links_.insert(links_.end(), std::begin(operands), std::end(operands));
+    }
+
+    // A fresh proper list of the items.
+    uint32_t AddList(const std::vector<ObjectPtr>& items) {
+        uint32_t list = kImageNil;
+        for (auto it = items.rbegin(); it != items.rend(); ++it) {
+            auto item = IndexOf(*it);
+            list = Emit({ImageKind::CELL, item, list});
+        }
+        return list;
+    }
+
+    // Node of the object; cells and lambdas get their node at once and are filled in later.
+    uint32_t IndexOf(const ObjectPtr& object) {
+        if (object == nullptr) {
+            return kImageNil;
+        }
+        if (auto it = node_indices_.find(object); it != node_indices_.end()) {
+            return it->second;
+        }
+
+        uint32_t index;
+        if (auto number = As<Number>(object)) {
+            index = EmitAtom(&number_nodes_, number->GetValue(),
+                             {ImageKind::NUMBER, 0, number->GetValue()});
+        } else if (auto symbol = As<Symbol>(object)) {
+            auto name = AddName(symbol->GetName());
+            index = EmitAtom(&symbol_nodes_, name, {ImageKind::SYMBOL, name, 0});
+        } else if (auto string = As<String>(object)) {
+            auto name = AddName(string->GetValue());
+            index = EmitAtom(&string_nodes_, name, {ImageKind::STRING, name, 0});
+        } else if (auto boolean = As<Boolean>(object)) {
+            index = Emit({ImageKind::BOOLEAN, 0, boolean->GetValue()});
+        } else if (auto flonum = As<Flonum>(object)) {
+            auto bits = std::bit_cast<int64_t>(flonum->GetValue());
+            index = EmitAtom(&flonum_nodes_, bits, {ImageKind::FLONUM, 0, bits});
+        } else if (auto big = As<BigInteger>(object)) {
+            auto name = AddName(big->GetValue().ToString());
+            index = EmitAtom(&big_number_nodes_, name, {ImageKind::BIG_NUMBER, name, 0});
+        } else if (auto cell = As<Cell>(object)) {
+            auto kind = cell->IsConstant()  ? ImageKind::CONSTANT_CELL
+                        : cell->IsMutated() ? ImageKind::MUTATED_CELL
+                                            : ImageKind::CELL;
+            index = Emit({kind, kImageNil, kImageNil});
+            pending_.emplace_back(object, index);
+        } else if (auto lambda = As<Lambda>(object)) {
+            index = Emit({ImageKind::LAMBDA, 0, lambda->HasFlatBody()});
+            pending_.emplace_back(object, index);
+        } else if (auto it = host_object_names_.find(object.get());
+                   it != host_object_names_.end()) {
+            // The host's binding shadows the builtin of the same name.
+            index = Emit({ImageKind::ENVIRONMENT, AddName(it->second), 0});
+        } else if (auto it = builtin_names_.find(object.get()); it != builtin_names_.end()) {
+            index = Emit({ImageKind::BUILTIN, AddName(it->second), 0});
+        } else {
+            throw RuntimeError("object can't be saved in an image: " + object->Serialize());
+        }
+        node_indices_.emplace(object, index);
+        return index;
+    }
+};
+
+template <typename T>
+const T* ViewArray(std::string_view image, size_t* offset, size_t count) {
+    if (count > (image.size() - *offset) / sizeof(T)) {
+        throw RuntimeError("truncated image");
+    }
+    auto* data = reinterpret_cast<const T*>(image.data() + *offset);
+    *offset += count * sizeof(T);
+    return data;
+}
+
+// A mapped image. Objects are decoded on demand and remembered while they are alive, so every
+// record is restored as one object however it is reached.
+class ImageHeap : public std::enable_shared_from_this<ImageHeap> {
+public:
+    ImageHeap(const std::string& path, const std::shared_ptr<Scope>& global)
+        : file_(path), global_(global) {
+        auto image = file_.GetText();
+        size_t offset = 0;
+        std::memcpy(&header_, ViewArray<char>(image, &offset, sizeof(header_)), sizeof(header_));
+        if (std::memcmp(header_.magic, kImageMagic, sizeof(header_.magic)) != 0 ||
+            header_.version != kImageVersion) {
+            throw RuntimeError("not an image: " + path);
+        }
+
+        names_ = ViewArray<ImageName>(image, &offset, header_.name_count);
+        nodes_ = ViewArray<ImageNode>(image, &offset, header_.node_count);
+        links_ = ViewArray<uint32_t>(image, &offset, header_.link_count);
+        scopes_ = ViewArray<ImageScope>(image, &offset, header_.scope_count);
+        bindings_ = ViewArray<ImageBinding>(image, &offset, header_.binding_count);
+        names_blob_ = {ViewArray<char>(image, &offset, header_.names_size), header_.names_size};
+        if (header_.scope_count == 0) {
+            throw RuntimeError("corrupted image");
+        }
+
+        objects_.resize(header_.node_count);
+        scope_objects_.resize(header_.scope_count);
+    }
+
+    void Restore() {
+        std::lock_guard lock{mutex_};
+        Pending pending;
+        pending.scopes.emplace_back(global_.lock(), 0);
+        Link(&pending);
+    }
+
+    std::vector<ObjectPtr> ReadBody(uint32_t index) {
+        std::lock_guard lock{mutex_};
+        Pending pending;
+        std::vector<ObjectPtr> forms;
+        for (auto item : ListItems(index)) {
+            forms.push_back(Make(item, &pending));
+        }
+        Link(&pending);
+        return forms;
+    }
+
+private:
+    // Objects created but not linked yet: cells get their children and scopes their bindings
+    // once the objects they refer to exist, which allows cycles.
+    struct Pending {
+        std::vector<std::pair<std::shared_ptr<Cell>, uint32_t>> cells;
+        std::vector<std::pair<std::shared_ptr<Scope>, uint32_t>> scopes;
+    };
+
+    MappedFile file_;
+    // Weak: the global scope holds closures, which hold their bodies, which hold the heap.
+    std::weak_ptr<Scope> global_;
+    ImageHeader header_;
+    const ImageName* names_;
+    const ImageNode* nodes_;
+    const uint32_t* links_;
+    const ImageScope* scopes_;
+    const ImageBinding* bindings_;
+    std::string_view names_blob_;
+
+    std::mutex mutex_;
+    std::vector<std::weak_ptr<Object>> objects_;
+    std::vector<std::weak_ptr<Scope>> scope_objects_;
+    std::unordered_map<uint32_t, std::weak_ptr<ScopesCollection>> scope_lists_;
+
+    std::string_view NameAt(uint32_t index) const {
+        if (index >= header_.name_count ||
+            names_[index].offset + static_cast<uint64_t>(names_[index].length) >
+                names_blob_.size()) {
+            throw RuntimeError("corrupted image");
+        }
+        return names_blob_.substr(names_[index].offset, names_[index].length);
+    }
+
+    const ImageNode& NodeAt(uint32_t index) const {
+        if (index >= header_.node_count) {
+            throw RuntimeError("corrupted image");
+        }
+        return nodes_[index];
+    }
+
+    const uint32_t* LinksAt(uint32_t first, uint64_t count) const {
+        if (first > header_.link_count || count > header_.link_count - first) {
+            throw RuntimeError("corrupted image");
+        }
+        return links_ + first;
+    }
+
+    // Items of a proper list, read from the records.
+    std::vector<uint32_t> ListItems(uint32_t index) const {
+        std::vector<uint32_t> items;
+        while (index != kImageNil) {
+            const auto& node = NodeAt(index);
+            if ((node.kind != ImageKind::CELL && node.kind != ImageKind::CONSTANT_CELL &&
+                 node.kind != ImageKind::MUTATED_CELL) ||
+                items.size() >= header_.node_count) {
+                throw RuntimeError("corrupted image");
+            }
+            items.push_back(node.index);
+            index = static_cast<uint32_t>(node.value);
+        }
+        return items;
+    }
+
+    void Link(Pending* pending) {
+        while (!pending->cells.empty() || !pending->scopes.empty()) {
+            if (!pending->cells.empty()) {
+                auto [cell, index] = std::move(pending->cells.back());
+                pending->cells.pop_back();
+                const auto& node = NodeAt(index);
+                cell->SetFirst(Make(node.index, pending));
+                cell->SetSecond(Make(static_cast<uint32_t>(node.value), pending));
+                continue;
+            }
+            auto [scope, index] = std::move(pending->scopes.back());
+            pending->scopes.pop_back();
+            const auto& record = scopes_[index];
+            if (record.first_binding > header_.binding_count ||
+                record.binding_count > header_.binding_count - record.first_binding) {
+                throw RuntimeError("corrupted image");
+            }
+            for (uint32_t i = 0; i < record.binding_count; ++i) {
+                const auto& binding = bindings_[record.first_binding + i];
+                scope->Set(std::string(NameAt(binding.name)), Make(binding.node, pending), true);
+            }
+        }
+    }
+
+    ObjectPtr Make(uint32_t index, Pending* pending) {
+        if (index == kImageNil) {
+            return nullptr;
+        }
+        const auto& node = NodeAt(index);
+        if (auto object = objects_[index].lock()) {
+            return object;
+        }
+
+        ObjectPtr object;
+        switch (node.kind) {
+            case ImageKind::NUMBER:
+                object = MakeNode<Number>(node.value);
+                break;
+            case ImageKind::SYMBOL:
+                object = MakeNode<Symbol>(std::string(NameAt(node.index)));
+                break;
+            case ImageKind::STRING:
+                object = MakeNode<String>(std::string(NameAt(node.index)));
+                break;
+            case ImageKind::BOOLEAN:
+                object = MakeNode<Boolean>(node.value != 0);
+                break;
+            case ImageKind::FLONUM:
+                object = MakeNode<Flonum>(std::bit_cast<double>(node.value));
+                break;
+            case ImageKind::BIG_NUMBER:
+                object = MakeInteger(BigInt::FromString(NameAt(node.index)));
+                break;
+            case ImageKind::CELL:
+            case ImageKind::CONSTANT_CELL:
+            case ImageKind::MUTATED_CELL: {
+                auto cell = MakeNode<Cell>();
+                if (node.kind == ImageKind::CONSTANT_CELL) {
+                    cell->MarkConstant();
+                } else if (node.kind == ImageKind::MUTATED_CELL) {
+                    cell->MarkMutated();
+                }
+                pending->cells.emplace_back(cell, index);
+                object = std::move(cell);
+                break;
+            }
+            case ImageKind::ENVIRONMENT: {
+                std::string name{NameAt(node.index)};
+                auto global = global_.lock();
+                if (global == nullptr || !global->Lookup(name, &object)) {
+                    throw RuntimeError("image refers to undefined " + name);
+                }
+                break;
+            }
+            case ImageKind::BUILTIN: {
+                std::string name{NameAt(node.index)};
+                const auto& builtins = GetBuiltinsScope()->GetObjects();
+                auto it = builtins.find(name);
+                if (it == builtins.end()) {
+                    throw RuntimeError("image refers to undefined builtin " + name);
+                }
+                object = it->second;
+                break;
+            }
+            case ImageKind::LAMBDA:
+                object = MakeLambda(node, pending);
+                break;
+            default:
+                throw RuntimeError("corrupted image");
+        }
+        objects_[index] = object;
+        return object;
+    }
+
+    ObjectPtr MakeLambda(const ImageNode& node, Pending* pending);
+
+    std::shared_ptr<ScopesCollection> MakeScopeList(uint32_t index, Pending* pending) {
+        const auto& node = NodeAt(index);
+        if (node.kind != ImageKind::SCOPES) {
+            throw RuntimeError("corrupted image");
+        }
+        auto& cached = scope_lists_[index];
+        if (auto scopes = cached.lock()) {
+            return scopes;
+        }
+
+        const auto* links = LinksAt(node.index, static_cast<uint64_t>(node.value));
+        std::vector<std::shared_ptr<Scope>> scopes;
+        for (int64_t i = 0; i < node.value; ++i) {
+            auto scope = MakeScope(links[i], pending);
+            if (scope == nullptr) {
+                throw RuntimeError("corrupted image");
+            }
+            scopes.push_back(std::move(scope));
+        }
+        auto collection = std::make_shared<ScopesCollection>(scopes);
+        cached = collection;
+        return collection;
+    }
+
+    std::shared_ptr<Scope> MakeScope(uint32_t index, Pending* pending) {
+        if (index == kImageNil) {
+            return nullptr;
+        }
+        if (index == kImageBuiltins) {
+            return GetBuiltinsScope();
+        }
+        if (index == 0) {
+            // Its bindings are restored by Restore.
+            return global_.lock();
+        }
+        if (index >= header_.scope_count) {
+            throw RuntimeError("corrupted image");
+        }
+        if (auto scope = scope_objects_[index].lock()) {
+            return scope;
+        }
+
+        // Frames have no parent; only the global scope chains to the builtins.
+        std::shared_ptr<Scope> parent;
+        switch (scopes_[index].parent) {
+            case kImageNil:
+                break;
+            case kImageBuiltins:
+                parent = GetBuiltinsScope();
+                break;
+            case 0:
+                parent = global_.lock();
+                break;
+            default:
+                throw RuntimeError("corrupted image");
+        }
+        auto scope = std::make_shared<Scope>(std::unordered_map<std::string, ObjectPtr>{}, parent);
+        scope_objects_[index] = scope;
+        pending->scopes.emplace_back(scope, index);
+        return scope;
+    }
+};
+
+// Body of a restored function, decoded from the image on the first call.
+class ImageBody : public DeferredBody {
+public:
+    ImageBody(std::shared_ptr<ImageHeap> heap, uint32_t index)
+        : heap_(std::move(heap)), index_(index) {
+    }
+
+    std::vector<ObjectPtr> ReadForms() const override {
+        return heap_->ReadBody(index_);
+    }
+
+    std::string Serialize() override {
+        std::string text;
+        for (const auto& form : ReadForms()) {
+            text += (text.empty() ? "" : " ") + ::Serialize(form);
+        }
+        return text;
+    }
+
+    ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) override {
+        ObjectPtr result;
+        for (const auto& form : ReadForms()) {
+            result = ::Evaluate(form, scopes);
+        }
+        return result;
+    }
+
+private:
+    std::shared_ptr<ImageHeap> heap_;
+    uint32_t index_;
+};
+
+ObjectPtr ImageHeap::MakeLambda(const ImageNode& node, Pending* pending) {
+    const auto* links = LinksAt(node.index, 3);
+
+    std::vector<ObjectPtr> arguments;
+    for (auto item : ListItems(links[0])) {
+        const auto& argument = NodeAt(item);
+        if (argument.kind != ImageKind::SYMBOL) {
+            throw RuntimeError("corrupted image");
+        }
+        arguments.push_back(MakeNode<Symbol>(std::string(NameAt(argument.index))));
+    }
+    arguments.push_back(nullptr);
+
+    auto body = std::make_shared<ImageBody>(shared_from_this(), links[1]);
+    return std::make_shared<Lambda>(std::vector<ObjectPtr>{ToAst(arguments), std::move(body)},
+                                    MakeScopeList(links[2], pending), node.value != 0);
+}
+
+}  // namespace
+
+void WriteImage(const std::shared_ptr<Scope>& global,
+                const std::unordered_set<std::string>& host_names, std::ostream* out) {
+    ImageWriter writer{global, host_names};
+    writer.Write(out);
+}
+
+void RestoreImage(const std::string& path, const std::shared_ptr<Scope>& global) {
+    std::make_shared<ImageHeap>(path, global)->Restore();
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+
+#include <scope.h>
+
+// Heap image format (.scmi): the bindings of an interpreter's global scope and everything they
+// reach (data, closures and the frames the closures captured), so a warmed environment can be
+// restored in another process without re-running its definitions.
+//
+// Objects refer to each other by record index, never by address, so the image is position
+// independent: it is mapped read-only and shared between processes through the page cache.
+// Restoring decodes the global bindings; function bodies are decoded on their first call, so
+// the pages holding the code of functions that are never called are never touched.
+//
+// Layout, in host byte order:
+//   ImageHeader
+//   ImageName[name_count]        (offset, length) into the names blob
+//   ImageNode[node_count]
+//   uint32_t[link_count]         operand lists of LAMBDA and SCOPES nodes
+//   ImageScope[scope_count]      scope 0 is the global scope
+//   ImageBinding[binding_count]  the bindings of every scope
+//   char[names_size]             names blob
+//
+// Builtins and host bindings of the global scope (see Interpreter::Register and
+// Interpreter::Define) are stored by name. Builtins are looked up among the builtins, so a
+// program's binding of the same name doesn't replace them; host bindings are looked up in the
+// restoring interpreter, which has to provide them.
+
+inline constexpr char kImageMagic[4] = {'S', 'C', 'M', 'I'};
+inline constexpr uint32_t kImageVersion = 1;
+inline constexpr uint32_t kImageNil = UINT32_MAX;
+// Parent or member of scope lists that stands for the builtins scope.
+inline constexpr uint32_t kImageBuiltins = UINT32_MAX - 1;
+
+struct ImageHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t name_count;
+    uint32_t node_count;
+    uint32_t link_count;
+    uint32_t scope_count;
+    uint32_t binding_count;
+    uint32_t reserved;
+    uint64_t names_size;
+};
+
+struct ImageName {
+    uint32_t offset;
+    uint32_t length;
+};
+
+enum class ImageKind : uint32_t {
+    NUMBER,
+    SYMBOL,
+    STRING,
+    BOOLEAN,
+    CELL,
+    CONSTANT_CELL,
+    ENVIRONMENT,   // name of a host object, or of a builtin in images of older versions
+    LAMBDA,        // links: argument list node, body list node, SCOPES node; value: flat body
+    SCOPES,        // links: scope indices, in lookup order
+    MUTATED_CELL,  // changed by set-car!/set-cdr!, so possibly part of a cycle
+    FLONUM,
+    BIG_NUMBER,    // name: the decimal digits
+    BUILTIN,       // name of a builtin
+};
+
+struct ImageNode {
+    ImageKind kind;
+    // Name index for symbols, strings, big numbers, builtins and host objects, car node index
+    // for cells, first link for LAMBDA and SCOPES.
+    uint32_t index;
+    // Value for numbers and booleans, the bits of the double for flonums, cdr node index for
+    // cells, link count for SCOPES.
+    int64_t value;
+};
+
+struct ImageScope {
+    // Scope index, kImageBuiltins or kImageNil.
+    uint32_t parent;
+    uint32_t first_binding;
+    uint32_t binding_count;
+    uint32_t reserved;
+};
+
+struct ImageBinding {
+    uint32_t name;
+    uint32_t node;
+};
+
+// Writes the image of global, whose parent must be the builtins scope. The global bindings
+// named in host_names belong to the host and are stored by name only.
+void WriteImage(const std::shared_ptr<Scope>& global,
+                const std::unordered_set<std::string>& host_names, std::ostream* out);
+
+// Maps the image at path and defines its global bindings in global.
+void RestoreImage(const std::string& path, const std::shared_ptr<Scope>& global);
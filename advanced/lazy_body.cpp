@@ -0,0 +1,53 @@
+#include "lazy_body.h"
+
+#include <evaluate.h>
+#include <mapped_file.h>
+#include <memory_stream.h>
+
+LazyBody::LazyBody(std::shared_ptr<const SourceText> source, size_t begin, size_t end,
+                   const ReadOptions& options)
+    : source_(std::move(source)), begin_(begin), end_(end), options_(options) {
+    options_.source = nullptr;
+}
+
+std::string_view LazyBody::GetText() const {
+    return source_->text.substr(begin_, end_ - begin_);
+}
+
+std::vector<ObjectPtr> LazyBody::ReadForms() const {
+    // Offsets of nested bodies are relative to this one.
+    auto options = options_;
+    options.source = std::make_shared<SourceText>(SourceText{source_->owner, GetText()});
+
+    MemoryStream stream{GetText()};
+    Tokenizer tokenizer{&stream};
+    std::vector<ObjectPtr> forms;
+    while (!tokenizer.IsEnd()) {
+        forms.push_back(Read(&tokenizer, options));
+    }
+    return forms;
+}
+
+std::string LazyBody::Serialize() {
+    return std::string(GetText());
+}
+
+ObjectPtr LazyBody::Evaluate(const std::shared_ptr<ScopesCollection>& scopes) {
+    ObjectPtr result;
+    for (const auto& form : ReadForms()) {
+        result = ::Evaluate(form, scopes);
+    }
+    return result;
+}
+
+std::shared_ptr<const SourceText> MapSourceFile(const std::string& path) {
+    auto file = std::make_shared<MappedFile>(path);
+    auto text = file->GetText();
+    return std::make_shared<SourceText>(SourceText{std::move(file), text});
+}
+
+std::shared_ptr<const SourceText> CopySourceText(std::string text) {
+    auto owner = std::make_shared<std::string>(std::move(text));
+    std::string_view view = *owner;
+    return std::make_shared<SourceText>(SourceText{std::move(owner), view});
+}
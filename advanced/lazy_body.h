@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <object.h>
+#include <parser.h>
+
+// Function body that is materialized when the function is first called; Lambda replaces it
+// with the forms it reads.
+class DeferredBody : public Object {
+public:
+    virtual std::vector<ObjectPtr> ReadForms() const = 0;
+};
+
+// Unread body of a lambda or function definition: a byte range of the source it came from
+// (see ReadOptions::lazy_bodies). Lambda reads it on the first call.
+class LazyBody : public DeferredBody {
+public:
+    LazyBody(std::shared_ptr<const SourceText> source, size_t begin, size_t end,
+             const ReadOptions& options);
+
+    std::string_view GetText() const;
+
+    // Reads the forms of the body; nested bodies are read lazily again.
+    std::vector<ObjectPtr> ReadForms() const override;
+
+    std::string Serialize() override;
+    // Only reached if lambda or define is rebound: evaluates the forms in order.
+    ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) override;
+
+private:
+    std::shared_ptr<const SourceText> source_;
+    size_t begin_;
+    size_t end_;
+    ReadOptions options_;
+};
+
+// Sources owning their text, for reading with lazy bodies.
+std::shared_ptr<const SourceText> MapSourceFile(const std::string& path);
+std::shared_ptr<const SourceText> CopySourceText(std::string text);
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <error.h>
+#include <server.h>
+
+// Usage: scheme_advanced_loadgen SOCKET [CLIENTS] [REQUESTS] [PROGRAM]
+// Opens CLIENTS sessions to a server started with scheme_advanced_repl --serve SOCKET; each
+// sends REQUESTS evaluations of PROGRAM, one at a time. Reports the throughput and the p50 and
+// p99 request latency.
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " SOCKET [CLIENTS] [REQUESTS] [PROGRAM]"
+                  << std::endl;
+        return 2;
+    }
+    std::string path = argv[1];
+    size_t clients = argc > 2 ? std::stoul(argv[2]) : 16;
+    size_t requests = argc > 3 ? std::stoul(argv[3]) : 10000;
+    std::string program = argc > 4 ? argv[4] : "(+ 1 2)";
+
+    std::vector<std::vector<double>> latencies(clients);
+    std::vector<size_t> errors(clients);
+    std::vector<std::string> failures(clients);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < clients; ++i) {
+        threads.emplace_back([&, i] {
+            try {
+                EvalClient client{path};
+                latencies[i].reserve(requests);
+                for (size_t j = 0; j < requests; ++j) {
+                    auto sent = std::chrono::steady_clock::now();
+                    auto response = client.Run(program);
+                    std::chrono::duration<double, std::micro> latency =
+                        std::chrono::steady_clock::now() - sent;
+                    latencies[i].push_back(latency.count());
+                    if (response.error != RunError::NONE) {
+                        ++errors[i];
+                    }
+                }
+            } catch (const RuntimeError& error) {
+                failures[i] = error.what();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::vector<double> all;
+    size_t error_count = 0;
+    for (size_t i = 0; i < clients; ++i) {
+        if (!failures[i].empty()) {
+            std::cerr << "client " << i << ": " << failures[i] << std::endl;
+            return 1;
+        }
+        all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+        error_count += errors[i];
+    }
+    if (all.empty()) {
+        return 0;
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&all](double fraction) {
+        return all[std::min(all.size() - 1, static_cast<size_t>(fraction * all.size()))];
+    };
+
+    std::cout << all.size() << " requests from " << clients << " clients in " << elapsed.count()
+              << " s: " << all.size() / elapsed.count() << " requests/s, p50 "
+              << percentile(0.5) << " us, p99 " << percentile(0.99) << " us, " << error_count
+              << " errors" << std::endl;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <istream>
+#include <streambuf>
+#include <string_view>
+
+// Input stream reading straight from caller-owned memory, without copying it into a buffer.
+// The memory must outlive the stream.
+class MemoryBuffer : public std::streambuf {
+public:
+    explicit MemoryBuffer(std::string_view text) {
+        Reset(text);
+    }
+
+    void Reset(std::string_view text) {
+        auto* begin = const_cast<char*>(text.data());
+        setg(begin, begin, begin + text.size());
+    }
+};
+
+class MemoryStream : public std::istream {
+public:
+    explicit MemoryStream(std::string_view text) : std::istream(nullptr), buffer_(text) {
+        rdbuf(&buffer_);
+    }
+
+    // Starts reading other memory, clearing the end-of-file state.
+    void Reset(std::string_view text) {
+        buffer_.Reset(text);
+        clear();
+    }
+
+private:
+    MemoryBuffer buffer_;
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <bigint.h>
+#include <error.h>
+#include <funcs.h>
+#include <object.h>
+
+// Builtins written as plain C++ callables. The signature of the callable is inspected at compile
+// time: calls get an arity check, arguments are converted to the parameter types and the result
+// is boxed back into an object.
+//
+// Supported parameter types are integral types (from numbers; values out of the type's range
+// raise RuntimeError), bool (any object, by its truth value), std::string (from strings) and
+// ObjectPtr (unchanged); results may also be void, which gives (). Unsigned results beyond
+// IntType are boxed as big integers.
+
+template <typename T, typename = void>
+struct NativeArgument;
+
+template <>
+struct NativeArgument<ObjectPtr> {
+    static const ObjectPtr& From(const ObjectPtr& object) {
+        return object;
+    }
+};
+
+template <>
+struct NativeArgument<bool> {
+    static bool From(const ObjectPtr& object) {
+        return ToBool(object);
+    }
+};
+
+template <typename T>
+struct NativeArgument<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+    static T From(const ObjectPtr& object) {
+        auto value = GetNumber(object).GetValue();
+        if (!std::in_range<T>(value)) {
+            throw RuntimeError("argument out of range");
+        }
+        return static_cast<T>(value);
+    }
+};
+
+template <>
+struct NativeArgument<std::string> {
+    static const std::string& From(const ObjectPtr& object) {
+        auto* string = dynamic_cast<String*>(object.get());
+        if (string == nullptr) {
+            throw RuntimeError("expected string");
+        }
+        return string->GetValue();
+    }
+};
+
+template <typename T>
+ObjectPtr BoxNative(T&& value) {
+    using Value = std::remove_cvref_t<T>;
+    if constexpr (std::is_same_v<Value, bool>) {
+        return MakeNode<Boolean>(value);
+    } else if constexpr (std::is_integral_v<Value>) {
+        if constexpr (std::is_unsigned_v<Value> && sizeof(Value) >= sizeof(IntType)) {
+            if (!std::in_range<IntType>(value)) {
+                auto wide = static_cast<uint64_t>(value);
+                return MakeInteger(BigInt::FromMagnitude(
+                    false, {static_cast<uint32_t>(wide), static_cast<uint32_t>(wide >> 32)}));
+            }
+        }
+        return MakeNode<Number>(static_cast<IntType>(value));
+    } else if constexpr (std::is_same_v<Value, std::string>) {
+        return MakeNode<String>(std::forward<T>(value));
+    } else if constexpr (std::is_convertible_v<Value, ObjectPtr>) {
+        return std::forward<T>(value);
+    } else {
+        static_assert(!sizeof(Value), "unsupported native result type");
+    }
+}
+
+template <typename Function, typename Result, typename... Args>
+class NativeFunction : public EvaluatingArgumentFunction {
+public:
+    explicit NativeFunction(Function function) : function_(std::move(function)) {
+    }
+
+    ObjectPtr CallEvaluated(const std::vector<ObjectPtr>& args,
+                            const std::shared_ptr<ScopesCollection>&) override {
+        if (args.size() != sizeof...(Args)) {
+            throw InvalidArgsCount(FormatString("expected", sizeof...(Args), "got", args.size()));
+        }
+        return Invoke(args, std::index_sequence_for<Args...>{});
+    }
+
+protected:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes) override {
+        return {CallEvaluated(args, scopes)};
+    }
+
+private:
+    Function function_;
+
+    template <size_t... Indices>
+    ObjectPtr Invoke(const std::vector<ObjectPtr>& args, std::index_sequence<Indices...>) {
+        if constexpr (std::is_void_v<Result>) {
+            function_(NativeArgument<std::remove_cvref_t<Args>>::From(args[Indices])...);
+            return nullptr;
+        } else {
+            return BoxNative(
+                function_(NativeArgument<std::remove_cvref_t<Args>>::From(args[Indices])...));
+        }
+    }
+};
+
+// Deduces the result and parameter types of function pointers and non-generic lambdas.
+template <typename T>
+struct NativeSignature : NativeSignature<decltype(&T::operator())> {};
+
+template <typename Result, typename... Args>
+struct NativeSignature<Result (*)(Args...)> {
+    template <typename Function>
+    using Type = NativeFunction<Function, Result, Args...>;
+};
+
+template <typename Class, typename Result, typename... Args>
+struct NativeSignature<Result (Class::*)(Args...) const> : NativeSignature<Result (*)(Args...)> {};
+
+template <typename Class, typename Result, typename... Args>
+struct NativeSignature<Result (Class::*)(Args...)> : NativeSignature<Result (*)(Args...)> {};
+
+template <typename Function>
+std::shared_ptr<IFunction> MakeNativeFunction(Function function) {
+    using Callable = std::decay_t<Function>;
+    using Native = typename NativeSignature<Callable>::template Type<Callable>;
+    return std::make_shared<Native>(std::move(function));
+}
@@ -1,8 +1,12 @@
 #include "object.h"
+#include <array>
+#include <charconv>
+#include <cmath>
 #include <vector>
 #include <memory>
 #include <evaluate.h>
 #include "representation.h"
+#include "serializer.h"
 
 std::vector<ObjectPtr> IFunction::Call(const std::vector<ObjectPtr>& args,
                                        const std::shared_ptr<ScopesCollection>& scopes) {
@@ -20,6 +24,11 @@ std::vector<ObjectPtr> EvaluatingArgumentFunction::Prepare(
     return answer;
 }
 
+ObjectPtr EvaluatingArgumentFunction::CallEvaluated(
+    const std::vector<ObjectPtr>& args, const std::shared_ptr<ScopesCollection>& scopes) {
+    return ToAst(DoCall(args, scopes));
+}
+
 std::vector<ObjectPtr> UnevaluatingArgumentFunction::Prepare(
     const std::vector<ObjectPtr>& args, const std::shared_ptr<ScopesCollection>&) {
     return args;
@@ -37,10 +46,53 @@ std::shared_ptr<Object> Object::Clone() {
     return shared_from_this();
 }
 
+const std::pair<ObjectPtr, ObjectPtr>& Cell::GetForkedChildren() const {
+    const auto* children = current_fork->FindChildren(this);
+    return children != nullptr ? *children : children_;
+}
+
+void ReleaseChildren(Object* object) {
+    std::vector<ObjectPtr> pending;
+    object->DetachChildren(&pending);
+    while (!pending.empty()) {
+        auto node = std::move(pending.back());
+        pending.pop_back();
+        node->DetachChildren(&pending);
+    }
+}
+
+Cell::~Cell() {
+    ReleaseChildren(this);
+}
+
+void Cell::DetachChildren(std::vector<ObjectPtr>* pending) {
+    for (auto* child : {&children_.first, &children_.second}) {
+        if (*child != nullptr && child->use_count() == 1) {
+            pending->push_back(std::move(*child));
+        }
+    }
+}
+
 std::string Number::Serialize() {
     return std::to_string(value_);
 }
 
+std::string Flonum::Serialize() {
+    if (std::isnan(value_)) {
+        return "+nan.0";
+    }
+    if (std::isinf(value_)) {
+        return value_ > 0 ? "+inf.0" : "-inf.0";
+    }
+    std::array<char, 32> buffer;
+    auto end = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value_).ptr;
+    std::string answer(buffer.data(), end);
+    if (answer.find_first_of(".e") == std::string::npos) {
+        answer += ".0";
+    }
+    return answer;
+}
+
 std::string Symbol::Serialize() {
     return name_;
 }
@@ -49,25 +101,27 @@ std::string Boolean::Serialize() {
     return value_ ? "#t" : "#f";
 }
 
-std::string Cell::Serialize() {
-    auto flattened = Flatten(Clone());
-    bool put_dot = flattened.back() != nullptr;
-    if (flattened.back() == nullptr) {
-        flattened.pop_back();
-    }
-
-    std::string answer = "(";
-    for (size_t i = 0; i < flattened.size(); ++i) {
-        answer += ::Serialize(flattened[i]);
-        if (i + 1 != flattened.size()) {
-            answer += " ";
-        }
-        if (i + 2 == flattened.size() && put_dot) {
-            answer += ". ";
+std::string String::Serialize() {
+    std::string answer = "\"";
+    for (char c : value_) {
+        if (c == '"' || c == '\\') {
+            answer += '\\';
+            answer += c;
+        } else if (c == '\n') {
+            answer += "\\n";
+        } else if (c == '\t') {
+            answer += "\\t";
+        } else {
+            answer += c;
         }
     }
-    answer += ")";
+    answer += '"';
+    return answer;
+}
 
+std::string Cell::Serialize() {
+    std::string answer;
+    SerializeTo(Clone(), &answer);
     return answer;
 }
 
@@ -79,9 +133,13 @@ ObjectPtr Number::Evaluate(const std::shared_ptr<ScopesCollection>&) {
     return Clone();
 }
 
+ObjectPtr Flonum::Evaluate(const std::shared_ptr<ScopesCollection>&) {
+    return Clone();
+}
+
 ObjectPtr Symbol::Evaluate(const std::shared_ptr<ScopesCollection>& scopes) {
-    auto value = scopes->Get(name_);
-    if (value == nullptr) {
+    ObjectPtr value;
+    if (!scopes->Lookup(name_, &value)) {
         throw NameError("no such object");
     }
     return value;
@@ -91,6 +149,10 @@ ObjectPtr Boolean::Evaluate(const std::shared_ptr<ScopesCollection>&) {
     return Clone();
 }
 
+ObjectPtr String::Evaluate(const std::shared_ptr<ScopesCollection>&) {
+    return Clone();
+}
+
 ObjectPtr Cell::Evaluate(const std::shared_ptr<ScopesCollection>& scope) {
     auto function_obj = ::Evaluate(GetFirst(), scope);
     auto arguments = Flatten(GetSecond());
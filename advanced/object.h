@@ -1,8 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <error.h>
+#include <fork.h>
 #include "scope_fwd.h"
 #include <vector>
 
@@ -16,8 +18,18 @@ public:
     ObjectPtr Clone();
     virtual std::string Serialize() = 0;
     virtual ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) = 0;
+
+    // Moves the children this object holds the last reference to onto pending; see
+    // ReleaseChildren.
+    virtual void DetachChildren(std::vector<ObjectPtr>*) {
+    }
 };
 
+// Destroys the children only object holds from a heap stack, so that dropping a long or
+// deeply nested structure does not recurse once per level. Containers call it from their
+// destructors.
+void ReleaseChildren(Object* object);
+
 using IntType = int64_t;
 
 class Number : public Object {
@@ -36,6 +48,25 @@ private:
     IntType value_;
 };
 
+// Inexact real number.
+class Flonum : public Object {
+public:
+    Flonum(double value) : value_(value) {
+    }
+
+    double GetValue() const {
+        return value_;
+    }
+
+    // Shortest text that reads back as the same value, always with a point or an exponent so
+    // it reads back as a Flonum.
+    std::string Serialize() override;
+    ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) override;
+
+private:
+    double value_;
+};
+
 class Symbol : public Object {
 public:
     Symbol(std::string name) : name_(std::move(name)) {
@@ -68,29 +99,98 @@ private:
     bool value_;
 };
 
+class String : public Object {
+public:
+    String(std::string value) : value_(std::move(value)) {
+    }
+
+    const std::string& GetValue() const {
+        return value_;
+    }
+
+    std::string Serialize() override;
+    ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) override;
+
+private:
+    std::string value_;
+};
+
 bool ToBool(const ObjectPtr& object);
 
 class Cell : public Object {
 public:
+    Cell() = default;
+    ~Cell() override;
+
     std::shared_ptr<Object> GetFirst() const {
+        if (IsForkShared()) [[unlikely]] {
+            return GetForkedChildren().first;
+        }
         return children_.first;
     }
     std::shared_ptr<Object> GetSecond() const {
+        if (IsForkShared()) [[unlikely]] {
+            return GetForkedChildren().second;
+        }
         return children_.second;
     }
 
+    // Borrowed view of both children, for traversals that don't keep them.
+    const std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>& GetChildren() const {
+        if (IsForkShared()) [[unlikely]] {
+            return GetForkedChildren();
+        }
+        return children_;
+    }
+
     void SetFirst(std::shared_ptr<Object> first) {
+        if (IsForkShared()) [[unlikely]] {
+            current_fork->SetChildren(this, {std::move(first), GetSecond()});
+            return;
+        }
         children_.first = std::move(first);
     }
     void SetSecond(std::shared_ptr<Object> second) {
+        if (IsForkShared()) [[unlikely]] {
+            current_fork->SetChildren(this, {GetFirst(), std::move(second)});
+            return;
+        }
         children_.second = std::move(second);
     }
 
+    // Shared quoted constants (see ConstantPool) must not be modified by programs.
+    bool IsConstant() const {
+        return constant_;
+    }
+    void MarkConstant() {
+        constant_ = true;
+    }
+
+    // Set once set-car! or set-cdr! is applied. Lists are built from existing objects, so
+    // only such pairs can close a cycle.
+    bool IsMutated() const {
+        return mutated_.load(std::memory_order_relaxed);
+    }
+    void MarkMutated() {
+        mutated_.store(true, std::memory_order_relaxed);
+    }
+
     std::string Serialize() override;
     ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) override;
+    void DetachChildren(std::vector<ObjectPtr>* pending) override;
 
 private:
     std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>> children_;
+    bool constant_ = false;
+    // Atomic: forks mark the pairs they share.
+    std::atomic<bool> mutated_ = false;
+    uint32_t generation_ = GetForkGeneration();
+
+    // Created before the fork of the evaluating interpreter; see fork.h.
+    bool IsForkShared() const {
+        return generation_ < current_fork_generation;
+    }
+    const std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>& GetForkedChildren() const;
 };
 
 class IFunction : public Object {
@@ -109,6 +209,13 @@ protected:
 };
 
 class EvaluatingArgumentFunction : public IFunction {
+public:
+    // Calls the function with arguments that are already evaluated and returns the result as
+    // one object. Functions with a single result may override this to skip DoCall's vector.
+    virtual ObjectPtr CallEvaluated(const std::vector<ObjectPtr>& args,
+                                    const std::shared_ptr<ScopesCollection>& scopes);
+
+private:
     std::vector<ObjectPtr> Prepare(const std::vector<ObjectPtr>& args,
                                    const std::shared_ptr<ScopesCollection>& scopes) override;
 };
@@ -0,0 +1,139 @@
+#include "parallel_reader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <iterator>
+#include <memory>
+
+#include <memory_stream.h>
+
+namespace {
+
+bool IsSpace(char c) {
+    return std::isspace(static_cast<unsigned char>(c));
+}
+
+// Whether a token starts at position i, given that i is outside any string literal.
+bool StartsToken(std::string_view source, size_t i) {
+    char c = source[i];
+    if (IsSpace(c) || c == ')') {
+        return false;
+    }
+    if (i == 0 || c == '"' || c == '\'') {
+        return true;
+    }
+    char prev = source[i - 1];
+    if (c == '(') {
+        // #( opens a vector as one token.
+        return prev != '#';
+    }
+    return IsSpace(prev) || prev == ')' || prev == '"';
+}
+
+}  // namespace
+
+std::vector<size_t> FindFormBoundaries(std::string_view source, size_t chunks) {
+    std::vector<size_t> boundaries;
+    if (chunks < 2) {
+        return boundaries;
+    }
+
+    size_t chunk_size = source.size() / chunks;
+    size_t next_target = chunk_size;
+    int64_t depth = 0;
+    bool in_string = false;
+    char last_significant = ' ';
+
+    for (size_t i = 0; i < source.size(); ++i) {
+        char c = source[i];
+        if (in_string) {
+            if (c == '\\') {
+                ++i;
+            } else if (c == '"') {
+                in_string = false;
+                last_significant = c;
+            }
+            continue;
+        }
+
+        if (i >= next_target && depth == 0 && last_significant != '\'' && StartsToken(source, i)) {
+            boundaries.push_back(i);
+            if (boundaries.size() + 1 == chunks) {
+                break;
+            }
+            next_target = i + chunk_size;
+        }
+
+        if (c == '(') {
+            ++depth;
+        } else if (c == ')') {
+            --depth;
+        } else if (c == '"') {
+            in_string = true;
+        }
+        if (!IsSpace(c)) {
+            last_significant = c;
+        }
+    }
+
+    return boundaries;
+}
+
+std::vector<ObjectPtr> ParallelRead(std::string_view source, const ParallelReadOptions& options) {
+    size_t chunks = std::min(std::max<size_t>(options.threads, 1),
+                             source.size() / std::max<size_t>(options.min_chunk_size, 1) + 1);
+    auto boundaries = FindFormBoundaries(source, chunks);
+    boundaries.insert(boundaries.begin(), 0);
+    boundaries.push_back(source.size());
+    chunks = boundaries.size() - 1;
+
+    std::vector<std::vector<ObjectPtr>> forms(chunks);
+    std::vector<std::exception_ptr> errors(chunks);
+    auto read_chunk = [&](size_t index) {
+        try {
+            auto chunk =
+                source.substr(boundaries[index], boundaries[index + 1] - boundaries[index]);
+            // Lazy bodies are ranges of what the tokenizer reads, i.e. of the chunk.
+            auto read_options = options.read;
+            if (read_options.source != nullptr) {
+                read_options.source =
+                    std::make_shared<SourceText>(SourceText{read_options.source->owner, chunk});
+            }
+            MemoryStream stream{chunk};
+            Tokenizer tokenizer{&stream};
+            while (!tokenizer.IsEnd()) {
+                forms[index].push_back(Read(&tokenizer, read_options));
+            }
+        } catch (...) {
+            errors[index] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (size_t i = 1; i < chunks; ++i) {
+        workers.emplace_back(read_chunk, i);
+    }
+    read_chunk(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::vector<ObjectPtr> answer;
+    size_t total = 0;
+    for (const auto& chunk_forms : forms) {
+        total += chunk_forms.size();
+    }
+    answer.reserve(total);
+    for (auto& chunk_forms : forms) {
+        std::move(chunk_forms.begin(), chunk_forms.end(), std::back_inserter(answer));
+    }
+    return answer;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <object.h>
+#include <parser.h>
+
+struct ParallelReadOptions {
+    size_t threads = std::thread::hardware_concurrency();
+    // Inputs are never split into chunks smaller than this, so small sources stay on the
+    // calling thread.
+    size_t min_chunk_size = 64 * 1024;
+    // read.source, if set, must hold the source being read; its owner has to keep it alive.
+    ReadOptions read;
+};
+
+// Finds up to chunks - 1 top-level form boundaries splitting source into roughly equal parts.
+// The scan tracks only bracket depth, string literals, quote prefixes and the #( of vectors.
+std::vector<size_t> FindFormBoundaries(std::string_view source, size_t chunks);
+
+// Reads every top-level form of source, parsing independent chunks on several threads.
+// Forms are returned in source order; if several chunks are malformed, the error of the
+// first one is rethrown, as a sequential Read would.
+std::vector<ObjectPtr> ParallelRead(std::string_view source,
+                                    const ParallelReadOptions& options = {});
@@ -0,0 +1,88 @@
+#include "parse_cache.h"
+
+#include <vector>
+
+namespace {
+
+// Rough heap footprint of an object read from source, control block included.
+constexpr size_t kObjectBytes = 64;
+
+size_t CountObjects(const ObjectPtr& root) {
+    size_t count = 0;
+    std::vector<const Object*> pending = {root.get()};
+    while (!pending.empty()) {
+        const auto* object = pending.back();
+        pending.pop_back();
+        if (object == nullptr) {
+            continue;
+        }
+        ++count;
+        if (const auto* cell = dynamic_cast<const Cell*>(object)) {
+            pending.push_back(cell->GetFirst().get());
+            pending.push_back(cell->GetSecond().get());
+        }
+    }
+    return count;
+}
+
+size_t EstimateBytes(const std::string& text, const ParsedProgram& program) {
+    size_t objects = CountObjects(program.ast);
+    if (program.flat != nullptr) {
+        objects += program.flat->GetNodes().size();
+    }
+    return sizeof(ParsedProgram) + text.size() + objects * kObjectBytes;
+}
+
+}  // namespace
+
+ParseCache::ParseCache(size_t max_entries, size_t max_bytes)
+    : max_entries_(max_entries),
+      max_bytes_(max_bytes),
+      constants_(std::make_shared<ConstantPool>()) {
+}
+
+std::shared_ptr<const ParsedProgram> ParseCache::Find(const std::string& text) {
+    auto it = index_.find(text);
+    if (it == index_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->program;
+}
+
+void ParseCache::Insert(const std::string& text, std::shared_ptr<const ParsedProgram> program) {
+    if (auto it = index_.find(text); it != index_.end()) {
+        bytes_ -= it->second->bytes;
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+
+    auto bytes = EstimateBytes(text, *program);
+    if (max_entries_ == 0 || bytes > max_bytes_) {
+        return;
+    }
+    entries_.push_front({text, std::move(program), bytes});
+    index_.emplace(entries_.front().text, entries_.begin());
+    bytes_ += bytes;
+    Evict();
+}
+
+ParseCacheStats ParseCache::GetStats() const {
+    ParseCacheStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.entries = entries_.size();
+    stats.bytes = bytes_;
+    return stats;
+}
+
+void ParseCache::Evict() {
+    while (entries_.size() > max_entries_ || bytes_ > max_bytes_) {
+        auto& oldest = entries_.back();
+        bytes_ -= oldest.bytes;
+        index_.erase(oldest.text);
+        entries_.pop_back();
+    }
+}
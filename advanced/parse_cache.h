@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <object.h>
+#include <constants.h>
+#include <flat_ast.h>
+
+// A program read by Interpreter::Run, ready to be evaluated again.
+struct ParsedProgram {
+    ObjectPtr ast;
+    // Set when the interpreter evaluates flat.
+    std::shared_ptr<const FlatProgram> flat;
+};
+
+struct ParseCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+// Bounded LRU cache of parsed programs keyed by their source text. Entry sizes are estimated
+// from the text and the number of objects read.
+//
+// Cached programs are evaluated many times, so their quoted data must not change: programs put
+// into the cache are read with the cache's ConstantPool, which makes literals immutable.
+class ParseCache {
+public:
+    ParseCache(size_t max_entries, size_t max_bytes);
+
+    // Returns nullptr on a miss.
+    std::shared_ptr<const ParsedProgram> Find(const std::string& text);
+    void Insert(const std::string& text, std::shared_ptr<const ParsedProgram> program);
+
+    const std::shared_ptr<ConstantPool>& GetConstants() const {
+        return constants_;
+    }
+    ParseCacheStats GetStats() const;
+
+private:
+    struct Entry {
+        std::string text;
+        std::shared_ptr<const ParsedProgram> program;
+        size_t bytes;
+    };
+
+    size_t max_entries_;
+    size_t max_bytes_;
+    std::shared_ptr<ConstantPool> constants_;
+
+    // Most recently used first. Keys point into the texts of the entries.
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+    size_t bytes_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+
+    void Evict();
+};
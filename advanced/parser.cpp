@@ -1,106 +1,279 @@
 #include <parser.h>
+#include <bigint.h>
+#include <lazy_body.h>
+#include <representation.h>
+#include <vector.h>
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
-    if (tokenizer->IsEnd()) {
-        throw SyntaxError("expect not an empty expression");
+#include <vector>
+
+namespace {
+
+// A list, vector or quote form that is still being read. The reader keeps these on an explicit
+// heap-allocated stack instead of recursing once per nesting level.
+struct ReadFrame {
+    // A VECTOR is read like a LIST and turned into a Vector when it is closed.
+    enum class Kind { LIST, AFTER_DOT, EXPECT_CLOSE, QUOTE, VECTOR };
+
+    Kind kind;
+    std::shared_ptr<Cell> root;
+    std::shared_ptr<Cell> tail;
+    size_t length = 0;
+    // Inside quoted data.
+    bool quoted = false;
+};
+
+std::shared_ptr<Cell> MakeQuoted(ObjectPtr quote_elem) {
+    auto rest_cell = std::make_shared<Cell>();
+    rest_cell->SetFirst(std::move(quote_elem));
+    auto quote_cell = std::make_shared<Cell>();
+    quote_cell->SetFirst(ReadQuote());
+    quote_cell->SetSecond(std::move(rest_cell));
+    return quote_cell;
+}
+
+// Interns the datum of a finished (quote datum) list in place.
+void InternQuoteForm(const std::shared_ptr<Cell>& list, ConstantPool* constants) {
+    auto head = As<Symbol>(list->GetFirst());
+    auto rest = As<Cell>(list->GetSecond());
+    if (head == nullptr || head->GetName() != "quote" || rest == nullptr ||
+        rest->GetSecond() != nullptr || rest->IsConstant()) {
+        return;
     }
-    Token token = tokenizer->GetToken();
-    switch (token.index()) {
-        case 0: {
-            auto& elem = std::get<ConstantToken>(token);
-            tokenizer->Next();
-            return std::make_shared<Number>(elem.value);
-        }
-        case 1: {
-            auto& bracket = std::get<BracketToken>(token);
-            if (bracket == BracketToken::OPEN) {
-                return ReadList(tokenizer);
-            } else {
-                throw SyntaxError("closing");
-            }
-        }
-        case 2: {
-            auto& elem = std::get<SymbolToken>(token);
-            tokenizer->Next();
-            return std::make_shared<Symbol>(std::move(elem.name));
-        }
-        case 3: {
-            tokenizer->Next();
-            if (tokenizer->IsEnd()) {
-                throw SyntaxError("empty");
-            }
-            auto quote_elem = Read(tokenizer);
-            auto quote_cell = std::make_shared<Cell>();
-            auto quote_symbol = std::make_shared<Symbol>("quote");
-            quote_cell->SetFirst(quote_symbol);
-            auto rest_cell = std::make_shared<Cell>();
-            rest_cell->SetFirst(quote_elem);
-            rest_cell->SetSecond(nullptr);
-            quote_cell->SetSecond(rest_cell);
-            return quote_cell;
-        }
-        case 4: {
-            throw SyntaxError("dot");
-        }
-        default:
-            throw SyntaxError("invalid");
+    rest->SetFirst(constants->Intern(rest->GetFirst()));
+}
+
+bool HasHead(const ReadFrame& frame, const std::string& name) {
+    auto head = frame.root != nullptr ? As<Symbol>(frame.root->GetFirst()) : nullptr;
+    return head != nullptr && head->GetName() == name;
+}
+
+// Elements of a list under construction are data if the list is quoted or is (quote ...).
+bool StartsData(const std::vector<ReadFrame>& frames) {
+    if (frames.empty()) {
+        return false;
     }
+    const auto& frame = frames.back();
+    return frame.quoted || frame.kind == ReadFrame::Kind::QUOTE || HasHead(frame, "quote");
 }
-std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
-    if (tokenizer->IsEnd()) {
-        throw SyntaxError("expect not an empty expression");
+
+// (lambda ARGS ...) and (define (NAME ...) ...) after their second element.
+bool ExpectsBody(const ReadFrame& frame) {
+    if (frame.quoted || frame.length != 2) {
+        return false;
     }
-    Token token_meow = tokenizer->GetToken();
-    if (auto* bracket = std::get_if<BracketToken>(&token_meow);
-        bracket != nullptr && *bracket != BracketToken::OPEN) {
-        throw SyntaxError("expected another bracket");
+    return HasHead(frame, "lambda") ||
+           (HasHead(frame, "define") && Is<Cell>(frame.tail->GetFirst()));
+}
+
+// Records the rest of the current list as a LazyBody, unless it is empty.
+ObjectPtr SkipBody(Tokenizer* tokenizer, const ReadOptions& options) {
+    auto [begin, end] = tokenizer->SkipToClosingBracket();
+    const auto& text = options.source->text;
+    if (end > text.size()) {
+        throw RuntimeError("source doesn't match the tokenizer input");
     }
-    std::shared_ptr<Cell> root;
-    std::shared_ptr<Cell> child;
-    tokenizer->Next();
-    while (!tokenizer->IsEnd()) {
-        Token token_gaf = tokenizer->GetToken();
-        if (auto* bracket = std::get_if<BracketToken>(&token_gaf);
-            bracket != nullptr && *bracket == BracketToken::CLOSE) {
-            if (child) {
-                child->SetSecond(nullptr);
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) {
+        ++begin;
+    }
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+        --end;
+    }
+    if (begin == end) {
+        return nullptr;
+    }
+    return std::make_shared<LazyBody>(options.source, begin, end, options);
+}
+
+bool IsClosingBracket(const Token& token) {
+    auto* bracket = std::get_if<BracketToken>(&token);
+    return bracket != nullptr && *bracket == BracketToken::CLOSE;
+}
+
+}  // namespace
+
+std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
+    return Read(tokenizer, ReadOptions{});
+}
+
+std::shared_ptr<Object> Read(Tokenizer* tokenizer, const ReadOptions& options) {
+    std::vector<ReadFrame> frames;
+    bool lazy = options.lazy_bodies && options.source != nullptr;
+
+    while (true) {
+        if (tokenizer->IsEnd()) {
+            if (frames.empty()) {
+                throw SyntaxError("expect not an empty expression");
             }
-            tokenizer->Next();
-            return root;
+            auto kind = frames.back().kind;
+            throw SyntaxError(kind == ReadFrame::Kind::LIST || kind == ReadFrame::Kind::VECTOR
+                                  ? "no closing bracket"
+                                  : "empty");
         }
-        if (auto* dot = std::get_if<DotToken>(&token_gaf); dot != nullptr) {
-            if (root == nullptr) {
-                throw SyntaxError("no dot in the beginning");
+        Token token = tokenizer->GetToken();
+        ObjectPtr value;
+
+        if (!frames.empty() && frames.back().kind == ReadFrame::Kind::EXPECT_CLOSE) {
+            if (!IsClosingBracket(token)) {
+                throw SyntaxError("no closing bracket no end of the token");
             }
             tokenizer->Next();
-            if (tokenizer->IsEnd()) {
-                throw SyntaxError("empty");
+            value = std::move(frames.back().root);
+            frames.pop_back();
+        } else if (!frames.empty() && frames.back().kind == ReadFrame::Kind::LIST &&
+                   IsClosingBracket(token)) {
+            tokenizer->Next();
+            if (options.constants != nullptr && frames.back().root != nullptr) {
+                InternQuoteForm(frames.back().root, options.constants.get());
             }
-            auto temp = Read(tokenizer);
-            child->SetSecond(std::move(temp));
-            if (tokenizer->IsEnd()) {
-                throw SyntaxError("empty");
+            value = std::move(frames.back().root);
+            frames.pop_back();
+        } else if (!frames.empty() && frames.back().kind == ReadFrame::Kind::VECTOR &&
+                   IsClosingBracket(token)) {
+            tokenizer->Next();
+            auto elements = Flatten(frames.back().root);
+            elements.pop_back();
+            if (options.constants != nullptr) {
+                for (auto& element : elements) {
+                    element = options.constants->Intern(element);
+                }
             }
-            auto token = tokenizer->GetToken();
-            if (auto* bracket = std::get_if<BracketToken>(&token);
-                bracket == nullptr || *bracket != BracketToken::CLOSE) {
-                throw SyntaxError("no closing bracket no end of the token");
+            auto vector = std::make_shared<Vector>(std::move(elements));
+            if (options.constants != nullptr) {
+                vector->MarkConstant();
+            }
+            value = std::move(vector);
+            frames.pop_back();
+        } else if (!frames.empty() && frames.back().kind == ReadFrame::Kind::LIST &&
+                   std::holds_alternative<DotToken>(token)) {
+            if (frames.back().root == nullptr) {
+                throw SyntaxError("no dot in the beginning");
             }
             tokenizer->Next();
-            return root;
-        }
-        auto elem = Read(tokenizer);
-        auto new_cell = std::make_shared<Cell>();
-        new_cell->SetFirst(elem);
-        if (!root) {
-            root = new_cell;
+            frames.back().kind = ReadFrame::Kind::AFTER_DOT;
+            continue;
         } else {
-            child->SetSecond(new_cell);
+            switch (token.index()) {
+                case 0: {
+                    auto& elem = std::get<ConstantToken>(token);
+                    tokenizer->Next();
+                    value = std::make_shared<Number>(elem.value);
+                    break;
+                }
+                case 1: {
+                    if (std::get<BracketToken>(token) != BracketToken::OPEN) {
+                        throw SyntaxError("closing");
+                    }
+                    if (frames.size() >= options.max_depth) {
+                        throw SyntaxError("nesting is too deep");
+                    }
+                    tokenizer->Next();
+                    bool quoted = StartsData(frames);
+                    frames.push_back({ReadFrame::Kind::LIST, nullptr, nullptr, 0, quoted});
+                    continue;
+                }
+                case 2: {
+                    auto& elem = std::get<SymbolToken>(token);
+                    tokenizer->Next();
+                    value = std::make_shared<Symbol>(std::move(elem.name));
+                    break;
+                }
+                case 3: {
+                    if (frames.size() >= options.max_depth) {
+                        throw SyntaxError("nesting is too deep");
+                    }
+                    tokenizer->Next();
+                    frames.push_back({ReadFrame::Kind::QUOTE, nullptr, nullptr, 0, true});
+                    continue;
+                }
+                case 4: {
+                    throw SyntaxError("dot");
+                }
+                case 5: {
+                    auto& elem = std::get<StringToken>(token);
+                    tokenizer->Next();
+                    value = std::make_shared<String>(std::move(elem.value));
+                    break;
+                }
+                case 6: {
+                    auto& elem = std::get<BigConstantToken>(token);
+                    value = MakeInteger(BigInt::FromString(elem.digits));
+                    tokenizer->Next();
+                    break;
+                }
+                case 7: {
+                    auto& elem = std::get<FloatConstantToken>(token);
+                    value = std::make_shared<Flonum>(elem.value);
+                    tokenizer->Next();
+                    break;
+                }
+                case 8: {
+                    if (frames.size() >= options.max_depth) {
+                        throw SyntaxError("nesting is too deep");
+                    }
+                    tokenizer->Next();
+                    // The elements are data, as if quoted.
+                    frames.push_back({ReadFrame::Kind::VECTOR, nullptr, nullptr, 0, true});
+                    continue;
+                }
+                default:
+                    throw SyntaxError("invalid");
+            }
+        }
+
+        // Hand the finished datum to the enclosing frames; quotes complete immediately.
+        while (true) {
+            if (frames.empty()) {
+                return value;
+            }
+            auto& frame = frames.back();
+            if (frame.kind == ReadFrame::Kind::QUOTE) {
+                if (options.constants != nullptr) {
+                    value = options.constants->Intern(value);
+                }
+                value = MakeQuoted(std::move(value));
+                frames.pop_back();
+                continue;
+            }
+            if (frame.kind == ReadFrame::Kind::AFTER_DOT) {
+                frame.tail->SetSecond(std::move(value));
+                frame.kind = ReadFrame::Kind::EXPECT_CLOSE;
+                break;
+            }
+            auto new_cell = std::make_shared<Cell>();
+            new_cell->SetFirst(std::move(value));
+            if (!frame.root) {
+                frame.root = new_cell;
+            } else {
+                frame.tail->SetSecond(new_cell);
+            }
+            frame.tail = std::move(new_cell);
+            ++frame.length;
+            if (lazy && ExpectsBody(frame)) {
+                if (auto body = SkipBody(tokenizer, options)) {
+                    auto body_cell = std::make_shared<Cell>();
+                    body_cell->SetFirst(std::move(body));
+                    frame.tail->SetSecond(body_cell);
+                    frame.tail = std::move(body_cell);
+                    ++frame.length;
+                }
+            }
+            break;
         }
-        child = new_cell;
     }
-    throw SyntaxError("no closing bracket");
 }
+
+std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
+    if (tokenizer->IsEnd()) {
+        throw SyntaxError("expect not an empty expression");
+    }
+    Token token = tokenizer->GetToken();
+    if (auto* bracket = std::get_if<BracketToken>(&token);
+        bracket == nullptr || *bracket != BracketToken::OPEN) {
+        throw SyntaxError("expected another bracket");
+    }
+    return Read(tokenizer);
+}
+
 std::shared_ptr<Symbol> ReadQuote() {
     return std::make_shared<Symbol>("quote");
-}
\ No newline at end of file
+}
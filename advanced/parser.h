@@ -1,12 +1,40 @@
 #pragma once
 
 #include <memory>
+#include <string_view>
 
 #include "object.h"
+#include <constants.h>
 #include <tokenizer.h>
 #include <utility>
 #include <error.h>
 #include <tokenizer.cpp>
+
+inline constexpr size_t kDefaultMaxReadDepth = 1'000'000;
+
+// Text being read, for readers that keep pointers into it. `text` must be exactly what the
+// tokenizer reads, from its first byte; `owner` keeps it alive.
+struct SourceText {
+    std::shared_ptr<const void> owner;
+    std::string_view text;
+};
+
+struct ReadOptions {
+    // Maximum nesting of lists and quotes; deeper input raises SyntaxError.
+    size_t max_depth = kDefaultMaxReadDepth;
+    // If set, quoted data ('x and (quote x)) is hash-consed into this pool.
+    std::shared_ptr<ConstantPool> constants;
+    // If set, readers that also evaluate (EvaluateForms, load) flatten every form before
+    // evaluating it (see flat_ast.h).
+    bool flat = false;
+    // If set together with source, the body of every lambda and (define (f ...) ...) form is
+    // only checked for balanced brackets and kept as a LazyBody range of the source; it is read
+    // on the first call. Errors inside a body are reported then.
+    bool lazy_bodies = false;
+    std::shared_ptr<const SourceText> source;
+};
+
 std::shared_ptr<Object> Read(Tokenizer* tokenizer);
+std::shared_ptr<Object> Read(Tokenizer* tokenizer, const ReadOptions& options);
 std::shared_ptr<Object> ReadList(Tokenizer* tokenizer);
-std::shared_ptr<Symbol> ReadQuote();
\ No newline at end of file
+std::shared_ptr<Symbol> ReadQuote();
@@ -0,0 +1,329 @@
+#include "port.h"
+
+#include <fstream>
+#include <type_traits>
+
+#include <memory_stream.h>
+#include <parser.h>
+#include <scope.h>
+#include <serializer.h>
+#include <tokenizer.h>
+
+namespace {
+
+constexpr size_t kPortBufferSize = 64 << 10;
+
+template <typename PortType>
+std::shared_ptr<PortType> GetPortArgument(const std::vector<ObjectPtr>& args, size_t index,
+                                          const std::shared_ptr<ScopesCollection>& scopes) {
+    if (index >= args.size()) {
+        if constexpr (std::is_same_v<PortType, OutputPort>) {
+            return GetCurrentOutputPort(scopes);
+        } else {
+            return GetCurrentInputPort(scopes);
+        }
+    }
+    auto port = As<PortType>(args[index]);
+    if (port == nullptr) {
+        throw RuntimeError(std::is_same_v<PortType, OutputPort> ? "expected output port"
+                                                                 : "expected input port");
+    }
+    return port;
+}
+
+template <typename PortType>
+std::shared_ptr<PortType> GetCurrentPort(const std::shared_ptr<ScopesCollection>& scopes,
+                                         const std::string& name) {
+    auto current = As<CurrentPort>(scopes->Get(name));
+    auto port = current != nullptr ? std::dynamic_pointer_cast<PortType>(current->GetPort())
+                                   : nullptr;
+    if (port == nullptr) {
+        throw RuntimeError(name + " doesn't give a port");
+    }
+    return port;
+}
+
+const std::string& GetStringArgument(const ObjectPtr& object, const char* what) {
+    auto string = As<String>(object);
+    if (string == nullptr) {
+        throw RuntimeError(std::string("expected ") + what);
+    }
+    return string->GetValue();
+}
+
+}  // namespace
+
+std::string Port::Serialize() {
+    return "#<port>";
+}
+
+ObjectPtr Port::Evaluate(const std::shared_ptr<ScopesCollection>&) {
+    return shared_from_this();
+}
+
+OutputPort::OutputPort(std::ostream* out) : out_(out) {
+    buffer_.reserve(kPortBufferSize);
+}
+
+std::shared_ptr<OutputPort> OutputPort::OpenFile(const std::string& path) {
+    auto file = std::make_unique<std::ofstream>(path, std::ios::binary);
+    if (!*file) {
+        throw RuntimeError("can't open file: " + path);
+    }
+    auto port = std::make_shared<OutputPort>(file.get());
+    port->owned_ = std::move(file);
+    return port;
+}
+
+std::shared_ptr<OutputPort> OutputPort::OpenString() {
+    return std::make_shared<OutputPort>(nullptr);
+}
+
+OutputPort::~OutputPort() {
+    if (out_ != nullptr && !closed_) {
+        out_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        out_->flush();
+    }
+}
+
+void OutputPort::Write(std::string_view text) {
+    std::lock_guard lock{mutex_};
+    CheckOpen();
+    buffer_ += text;
+    if (buffer_.size() >= kPortBufferSize) {
+        Drain();
+    }
+}
+
+void OutputPort::WriteValue(const ObjectPtr& value, bool display) {
+    std::lock_guard lock{mutex_};
+    CheckOpen();
+    if (auto string = As<String>(value); display && string != nullptr) {
+        buffer_ += string->GetValue();
+    } else {
+        SerializeTo(value, &buffer_);
+    }
+    if (buffer_.size() >= kPortBufferSize) {
+        Drain();
+    }
+}
+
+void OutputPort::Flush() {
+    std::lock_guard lock{mutex_};
+    CheckOpen();
+    if (out_ != nullptr) {
+        Drain();
+        out_->flush();
+    }
+}
+
+void OutputPort::Close() {
+    std::lock_guard lock{mutex_};
+    if (closed_) {
+        return;
+    }
+    if (out_ != nullptr) {
+        Drain();
+        out_->flush();
+    }
+    closed_ = true;
+    owned_.reset();
+}
+
+std::string OutputPort::GetString() const {
+    std::lock_guard lock{mutex_};
+    if (out_ != nullptr) {
+        throw RuntimeError("not a string port");
+    }
+    return buffer_;
+}
+
+void OutputPort::CheckOpen() const {
+    if (closed_) {
+        throw RuntimeError("port is closed");
+    }
+}
+
+void OutputPort::Drain() {
+    if (out_ == nullptr) {
+        return;
+    }
+    out_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+    if (!*out_) {
+        throw RuntimeError("can't write to port");
+    }
+}
+
+InputPort::InputPort(std::istream* in) : in_(in) {
+}
+
+std::shared_ptr<InputPort> InputPort::OpenFile(const std::string& path) {
+    auto file = std::make_unique<std::ifstream>(path, std::ios::binary);
+    if (!*file) {
+        throw RuntimeError("can't open file: " + path);
+    }
+    auto port = std::make_shared<InputPort>(file.get());
+    port->owned_ = std::move(file);
+    return port;
+}
+
+std::shared_ptr<InputPort> InputPort::OpenString(std::string text) {
+    auto port = std::make_shared<InputPort>(nullptr);
+    port->text_ = std::move(text);
+    port->owned_ = std::make_unique<MemoryStream>(port->text_);
+    port->in_ = port->owned_.get();
+    return port;
+}
+
+ObjectPtr InputPort::ReadChar() {
+    std::lock_guard lock{mutex_};
+    CheckOpen();
+    auto c = in_->get();
+    if (c == EOF) {
+        return GetEofObject();
+    }
+    return MakeNode<String>(std::string(1, static_cast<char>(c)));
+}
+
+ObjectPtr InputPort::PeekChar() {
+    std::lock_guard lock{mutex_};
+    CheckOpen();
+    auto c = in_->peek();
+    if (c == EOF) {
+        return GetEofObject();
+    }
+    return MakeNode<String>(std::string(1, static_cast<char>(c)));
+}
+
+ObjectPtr InputPort::ReadLine() {
+    std::lock_guard lock{mutex_};
+    CheckOpen();
+    std::string line;
+    if (!std::getline(*in_, line)) {
+        return GetEofObject();
+    }
+    return MakeNode<String>(std::move(line));
+}
+
+ObjectPtr InputPort::ReadDatum() {
+    std::lock_guard lock{mutex_};
+    CheckOpen();
+    // The tokenizer doesn't read ahead of the datum, so the rest stays in the stream.
+    Tokenizer tokenizer{in_};
+    if (tokenizer.IsEnd()) {
+        return GetEofObject();
+    }
+    return Read(&tokenizer);
+}
+
+void InputPort::Close() {
+    std::lock_guard lock{mutex_};
+    closed_ = true;
+    owned_.reset();
+}
+
+void InputPort::CheckOpen() const {
+    if (closed_) {
+        throw RuntimeError("port is closed");
+    }
+}
+
+std::string EofObject::Serialize() {
+    return "#<eof>";
+}
+
+ObjectPtr EofObject::Evaluate(const std::shared_ptr<ScopesCollection>&) {
+    return shared_from_this();
+}
+
+ObjectPtr GetEofObject() {
+    static ObjectPtr kEof = MakeNode<EofObject>();
+    return kEof;
+}
+
+std::vector<ObjectPtr> CurrentPort::DoCall(const std::vector<ObjectPtr>& args,
+                                           const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 0);
+    return {port_};
+}
+
+std::shared_ptr<OutputPort> GetCurrentOutputPort(
+    const std::shared_ptr<ScopesCollection>& scopes) {
+    return GetCurrentPort<OutputPort>(scopes, "current-output-port");
+}
+
+std::shared_ptr<InputPort> GetCurrentInputPort(const std::shared_ptr<ScopesCollection>& scopes) {
+    return GetCurrentPort<InputPort>(scopes, "current-input-port");
+}
+
+std::vector<ObjectPtr> WriteValue::DoCall(const std::vector<ObjectPtr>& args,
+                                          const std::shared_ptr<ScopesCollection>& scopes) {
+    AssertArgsCountBetween(args, 1, 2);
+    GetPortArgument<OutputPort>(args, 1, scopes)->WriteValue(args.front(), display_);
+    return {nullptr};
+}
+
+std::vector<ObjectPtr> Newline::DoCall(const std::vector<ObjectPtr>& args,
+                                       const std::shared_ptr<ScopesCollection>& scopes) {
+    AssertArgsCountBetween(args, 0, 1);
+    GetPortArgument<OutputPort>(args, 0, scopes)->Write("\n");
+    return {nullptr};
+}
+
+std::vector<ObjectPtr> FlushOutputPort::DoCall(const std::vector<ObjectPtr>& args,
+                                               const std::shared_ptr<ScopesCollection>& scopes) {
+    AssertArgsCountBetween(args, 0, 1);
+    GetPortArgument<OutputPort>(args, 0, scopes)->Flush();
+    return {nullptr};
+}
+
+std::vector<ObjectPtr> ReadFromPort::DoCall(const std::vector<ObjectPtr>& args,
+                                            const std::shared_ptr<ScopesCollection>& scopes) {
+    AssertArgsCountBetween(args, 0, 1);
+    auto port = GetPortArgument<InputPort>(args, 0, scopes);
+    return {(port.get()->*reader_)()};
+}
+
+std::vector<ObjectPtr> OpenFilePort::DoCall(const std::vector<ObjectPtr>& args,
+                                            const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+    const auto& path = GetStringArgument(args.front(), "file name string");
+    if (output_) {
+        return {OutputPort::OpenFile(path)};
+    }
+    return {InputPort::OpenFile(path)};
+}
+
+std::vector<ObjectPtr> OpenInputString::DoCall(const std::vector<ObjectPtr>& args,
+                                               const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+    return {InputPort::OpenString(GetStringArgument(args.front(), "string"))};
+}
+
+std::vector<ObjectPtr> OpenOutputString::DoCall(const std::vector<ObjectPtr>& args,
+                                                const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 0);
+    return {OutputPort::OpenString()};
+}
+
+std::vector<ObjectPtr> GetOutputString::DoCall(const std::vector<ObjectPtr>& args,
+                                               const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+    auto port = As<OutputPort>(args.front());
+    if (port == nullptr) {
+        throw RuntimeError("expected output port");
+    }
+    return {MakeNode<String>(port->GetString())};
+}
+
+std::vector<ObjectPtr> ClosePort::DoCall(const std::vector<ObjectPtr>& args,
+                                         const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+    auto port = As<Port>(args.front());
+    if (port == nullptr) {
+        throw RuntimeError("expected port");
+    }
+    port->Close();
+    return {nullptr};
+}
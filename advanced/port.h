@@ -0,0 +1,205 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <funcs.h>
+#include <object.h>
+
+// Buffered ports for display, write, newline, read-char, peek-char, read-line and read.
+//
+// Output ports collect writes in a buffer and hand it to their stream in large chunks, so
+// programs can stream output with memory bounded by the buffer and the largest single value
+// written. String output ports keep everything written instead. Input ports read through
+// their stream's own buffer. Ports may be used from several threads, as the standard ports
+// are shared by all interpreters; a value is never interleaved with other output.
+//
+// There is no character type: read-char and peek-char return one-character strings. At the
+// end of the input, reading procedures return the eof object.
+//
+// Procedures called without a port use the one returned by the current-output-port or
+// current-input-port binding, initially the process's standard output and input; see
+// Interpreter::SetOutput and Interpreter::SetInput.
+
+class Port : public Object {
+public:
+    bool IsClosed() const {
+        return closed_;
+    }
+    virtual void Close() = 0;
+
+    std::string Serialize() override;
+    ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) override;
+
+protected:
+    bool closed_ = false;
+};
+
+class OutputPort : public Port {
+public:
+    // Writes to out, which must outlive the port.
+    explicit OutputPort(std::ostream* out);
+    // Throws RuntimeError if path can't be opened.
+    static std::shared_ptr<OutputPort> OpenFile(const std::string& path);
+    // Collects the output, see GetString.
+    static std::shared_ptr<OutputPort> OpenString();
+    ~OutputPort() override;
+
+    void Write(std::string_view text);
+    // Appends the external representation of value, or for strings their contents if
+    // display is set.
+    void WriteValue(const ObjectPtr& value, bool display);
+    // Hands the buffered output to the stream and flushes the stream.
+    void Flush();
+    void Close() override;
+
+    // Everything written to a string port so far.
+    std::string GetString() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::unique_ptr<std::ostream> owned_;
+    // nullptr for string ports.
+    std::ostream* out_;
+    std::string buffer_;
+
+    void CheckOpen() const;
+    void Drain();
+};
+
+class InputPort : public Port {
+public:
+    // Reads from in, which must outlive the port.
+    explicit InputPort(std::istream* in);
+    // Throws RuntimeError if path can't be opened.
+    static std::shared_ptr<InputPort> OpenFile(const std::string& path);
+    static std::shared_ptr<InputPort> OpenString(std::string text);
+
+    // The eof object at the end of the input.
+    ObjectPtr ReadChar();
+    ObjectPtr PeekChar();
+    ObjectPtr ReadLine();
+    ObjectPtr ReadDatum();
+
+    void Close() override;
+
+private:
+    std::mutex mutex_;
+    std::string text_;
+    std::unique_ptr<std::istream> owned_;
+    std::istream* in_;
+
+    void CheckOpen() const;
+};
+
+class EofObject : public Object {
+public:
+    std::string Serialize() override;
+    ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) override;
+};
+
+ObjectPtr GetEofObject();
+
+// current-output-port and current-input-port.
+class CurrentPort : public EvaluatingArgumentFunction {
+public:
+    explicit CurrentPort(std::shared_ptr<Port> port) : port_(std::move(port)) {
+    }
+
+    const std::shared_ptr<Port>& GetPort() const {
+        return port_;
+    }
+
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+
+private:
+    std::shared_ptr<Port> port_;
+};
+
+// The port bound by current-output-port or current-input-port in scopes.
+std::shared_ptr<OutputPort> GetCurrentOutputPort(const std::shared_ptr<ScopesCollection>& scopes);
+std::shared_ptr<InputPort> GetCurrentInputPort(const std::shared_ptr<ScopesCollection>& scopes);
+
+// display and write.
+class WriteValue : public EvaluatingArgumentFunction {
+public:
+    explicit WriteValue(bool display) : display_(display) {
+    }
+
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+
+private:
+    bool display_;
+};
+
+class Newline : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+class FlushOutputPort : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+// read-char, peek-char, read-line and read.
+class ReadFromPort : public EvaluatingArgumentFunction {
+public:
+    using Reader = ObjectPtr (InputPort::*)();
+
+    explicit ReadFromPort(Reader reader) : reader_(reader) {
+    }
+
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+
+private:
+    Reader reader_;
+};
+
+// open-input-file and open-output-file.
+class OpenFilePort : public EvaluatingArgumentFunction {
+public:
+    explicit OpenFilePort(bool output) : output_(output) {
+    }
+
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+
+private:
+    bool output_;
+};
+
+class OpenInputString : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+class OpenOutputString : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+class GetOutputString : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+// close-port, close-input-port and close-output-port.
+class ClosePort : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
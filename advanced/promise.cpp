@@ -0,0 +1,356 @@
+#include "promise.h"
+
+#include <mutex>
+
+#include <async.h>
+#include <error.h>
+#include <evaluate.h>
+
+namespace {
+
+// Guards the states of all promises. Held only to read or update them, never while a promise
+// body runs.
+std::mutex promise_mutex;
+
+// Dropping a long forced stream frees a pair, its promise, the state and the next pair in
+// turn. States hand their values to this list instead, and the outermost one frees them in a
+// loop, so the recursion stays bounded.
+thread_local std::vector<ObjectPtr> pending_values;
+thread_local bool freeing_values = false;
+
+ObjectPtr CallProcedure(const ObjectPtr& function, const std::vector<ObjectPtr>& values,
+                        const std::shared_ptr<ScopesCollection>& scopes) {
+    if (auto* evaluating = dynamic_cast<EvaluatingArgumentFunction*>(function.get())) {
+        return evaluating->CallEvaluated(values, scopes);
+    }
+    if (auto* lambda = dynamic_cast<Lambda*>(function.get())) {
+        return lambda->Invoke(values, scopes);
+    }
+    throw RuntimeError("expected procedure");
+}
+
+// The pair of a non-empty stream, nullptr for the empty one.
+std::shared_ptr<Cell> GetStreamPair(const ObjectPtr& object) {
+    if (object == nullptr) {
+        return nullptr;
+    }
+    auto pair = As<Cell>(object);
+    if (pair == nullptr) {
+        throw RuntimeError("expected stream");
+    }
+    return pair;
+}
+
+std::shared_ptr<Cell> GetNonEmptyStreamPair(const ObjectPtr& object) {
+    auto pair = GetStreamPair(object);
+    if (pair == nullptr) {
+        throw RuntimeError("expected non-empty stream");
+    }
+    return pair;
+}
+
+ObjectPtr StreamRest(const std::shared_ptr<Cell>& pair) {
+    return Force(pair->GetSecond());
+}
+
+IntType GetCount(const ObjectPtr& object) {
+    auto count = GetNumber(object).GetValue();
+    if (count < 0) {
+        throw RuntimeError("expected non-negative count");
+    }
+    return count;
+}
+
+ObjectPtr MakeStreamPair(ObjectPtr first, Promise::Thunk rest) {
+    auto pair = MakeNode<Cell>();
+    pair->SetFirst(std::move(first));
+    pair->SetSecond(MakeNode<Promise>(std::move(rest)));
+    return pair;
+}
+
+ObjectPtr MapStream(ObjectPtr procedure, ObjectPtr stream,
+                    std::shared_ptr<ScopesCollection> scopes) {
+    auto pair = GetStreamPair(stream);
+    if (pair == nullptr) {
+        return nullptr;
+    }
+    auto first = CallProcedure(procedure, {pair->GetFirst()}, scopes);
+    return MakeStreamPair(std::move(first), [procedure = std::move(procedure),
+                                             rest = pair->GetSecond(),
+                                             scopes = std::move(scopes)] {
+        return MapStream(procedure, Force(rest), scopes);
+    });
+}
+
+ObjectPtr FilterStream(ObjectPtr predicate, ObjectPtr stream,
+                       std::shared_ptr<ScopesCollection> scopes) {
+    auto pair = GetStreamPair(stream);
+    stream = nullptr;
+    while (pair != nullptr && !ToBool(CallProcedure(predicate, {pair->GetFirst()}, scopes))) {
+        CheckCancelled();
+        pair = GetStreamPair(StreamRest(pair));
+    }
+    if (pair == nullptr) {
+        return nullptr;
+    }
+    return MakeStreamPair(pair->GetFirst(), [predicate = std::move(predicate),
+                                             rest = pair->GetSecond(),
+                                             scopes = std::move(scopes)] {
+        return FilterStream(predicate, Force(rest), scopes);
+    });
+}
+
+ObjectPtr TakeStream(IntType count, const ObjectPtr& stream) {
+    auto pair = GetStreamPair(stream);
+    if (count == 0 || pair == nullptr) {
+        return nullptr;
+    }
+    if (count == 1) {
+        // Don't force the rest of the source for the empty tail.
+        auto last = MakeNode<Cell>();
+        last->SetFirst(pair->GetFirst());
+        last->SetSecond(MakeNode<Promise>(ObjectPtr{}));
+        return last;
+    }
+    return MakeStreamPair(pair->GetFirst(), [count, rest = pair->GetSecond()] {
+        return TakeStream(count - 1, Force(rest));
+    });
+}
+
+}  // namespace
+
+struct Promise::State {
+    bool done = false;
+    bool delay_force = false;
+    ObjectPtr value;
+    ObjectPtr expression;
+    std::shared_ptr<ScopesCollection> scopes;
+    Thunk thunk;
+
+    State() = default;
+    State(const State&) = default;
+    State& operator=(const State&) = default;
+
+    ~State() {
+        if (value != nullptr && value.use_count() == 1) {
+            pending_values.push_back(std::move(value));
+        }
+        if (freeing_values) {
+            return;
+        }
+        freeing_values = true;
+        while (!pending_values.empty()) {
+            auto next = std::move(pending_values.back());
+            pending_values.pop_back();
+            next.reset();
+        }
+        freeing_values = false;
+    }
+};
+
+Promise::Promise(ObjectPtr expression, std::shared_ptr<ScopesCollection> scopes,
+                 bool delay_force)
+    : state_(std::make_shared<State>()) {
+    state_->delay_force = delay_force;
+    state_->expression = std::move(expression);
+    state_->scopes = std::move(scopes);
+}
+
+Promise::Promise(Thunk thunk) : state_(std::make_shared<State>()) {
+    state_->thunk = std::move(thunk);
+}
+
+Promise::Promise(ObjectPtr value) : state_(std::make_shared<State>()) {
+    state_->done = true;
+    state_->value = std::move(value);
+}
+
+ObjectPtr Promise::Force(const std::shared_ptr<Promise>& promise) {
+    while (true) {
+        CheckCancelled();
+        std::shared_ptr<State> state;
+        State body;
+        {
+            std::lock_guard lock(promise_mutex);
+            state = promise->state_;
+            if (state->done) {
+                return state->value;
+            }
+            body = *state;
+        }
+
+        auto result = body.thunk ? body.thunk() : ::Evaluate(body.expression, body.scopes);
+        std::shared_ptr<Promise> next;
+        if (body.delay_force) {
+            next = As<Promise>(result);
+            if (next == nullptr) {
+                throw RuntimeError("delay-force: expected promise");
+            }
+        }
+
+        State released;
+        std::lock_guard lock(promise_mutex);
+        // Forced again while the body ran.
+        if (state->done) {
+            return state->value;
+        }
+        released = *state;
+        if (next == nullptr) {
+            state->done = true;
+            state->value = std::move(result);
+            state->expression = nullptr;
+            state->scopes = nullptr;
+            state->thunk = nullptr;
+            return state->value;
+        }
+        // Continue with the body of the next promise in this loop, and let it share the state
+        // so its value is remembered once.
+        *state = *next->state_;
+        next->state_ = state;
+        if (state->done) {
+            return state->value;
+        }
+    }
+}
+
+std::string Promise::Serialize() {
+    return "#<promise>";
+}
+
+ObjectPtr Promise::Evaluate(const std::shared_ptr<ScopesCollection>&) {
+    return shared_from_this();
+}
+
+ObjectPtr Force(const ObjectPtr& object) {
+    if (auto promise = As<Promise>(object)) {
+        return Promise::Force(promise);
+    }
+    return object;
+}
+
+std::vector<ObjectPtr> Delay::DoCall(const std::vector<ObjectPtr>& args,
+                                     const std::shared_ptr<ScopesCollection>& scopes) {
+    AssertArgsCountEqual<SyntaxError>(args, 1);
+    return {MakeNode<Promise>(args.front(), scopes, delay_force_)};
+}
+
+std::vector<ObjectPtr> ForcePromise::DoCall(const std::vector<ObjectPtr>& args,
+                                            const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+    return {Force(args.front())};
+}
+
+std::vector<ObjectPtr> MakePromise::DoCall(const std::vector<ObjectPtr>& args,
+                                           const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+    if (Is<Promise>(args.front())) {
+        return {args.front()};
+    }
+    return {MakeNode<Promise>(args.front())};
+}
+
+std::vector<ObjectPtr> ConsStream::DoCall(const std::vector<ObjectPtr>& args,
+                                          const std::shared_ptr<ScopesCollection>& scopes) {
+    AssertArgsCountEqual<SyntaxError>(args, 2);
+    return {::Evaluate(args.front(), scopes), MakeNode<Promise>(args[1], scopes, false)};
+}
+
+std::vector<ObjectPtr> StreamCar::DoCall(const std::vector<ObjectPtr>& args,
+                                         const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+    return {GetNonEmptyStreamPair(args.front())->GetFirst()};
+}
+
+std::vector<ObjectPtr> StreamCdr::DoCall(const std::vector<ObjectPtr>& args,
+                                         const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+    return {StreamRest(GetNonEmptyStreamPair(args.front()))};
+}
+
+std::vector<ObjectPtr> IsStreamPair::DoCall(const std::vector<ObjectPtr>& args,
+                                            const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+    auto pair = As<Cell>(args.front());
+    return {MakeNode<Boolean>(pair != nullptr && Is<Promise>(pair->GetSecond()))};
+}
+
+std::vector<ObjectPtr> StreamFunction::DoCall(const std::vector<ObjectPtr>& args,
+                                              const std::shared_ptr<ScopesCollection>& scopes) {
+    std::vector<ObjectPtr> values;
+    values.reserve(args.size());
+    for (const auto& arg : args) {
+        values.push_back(::Evaluate(arg, scopes));
+    }
+    return {Apply(std::move(values), scopes)};
+}
+
+ObjectPtr StreamMap::Apply(std::vector<ObjectPtr> values,
+                           const std::shared_ptr<ScopesCollection>& scopes) {
+    AssertArgsCountEqual(values, 2);
+    return MapStream(std::move(values.front()), std::move(values[1]), scopes);
+}
+
+ObjectPtr StreamFilter::Apply(std::vector<ObjectPtr> values,
+                              const std::shared_ptr<ScopesCollection>& scopes) {
+    AssertArgsCountEqual(values, 2);
+    return FilterStream(std::move(values.front()), std::move(values[1]), scopes);
+}
+
+ObjectPtr StreamTake::Apply(std::vector<ObjectPtr> values,
+                            const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(values, 2);
+    return TakeStream(GetCount(values.front()), values[1]);
+}
+
+ObjectPtr StreamRef::Apply(std::vector<ObjectPtr> values,
+                           const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(values, 2);
+    auto index = GetCount(values[1]);
+    auto pair = GetNonEmptyStreamPair(values.front());
+    values.clear();
+    for (IntType i = 0; i < index; ++i) {
+        CheckCancelled();
+        pair = GetNonEmptyStreamPair(StreamRest(pair));
+    }
+    return pair->GetFirst();
+}
+
+ObjectPtr StreamToList::Apply(std::vector<ObjectPtr> values,
+                              const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountBetween(values, 1, 2);
+    auto count = values.size() == 2 ? GetCount(values.front()) : -1;
+    auto pair = GetStreamPair(values.back());
+    values.clear();
+
+    ObjectPtr list;
+    std::shared_ptr<Cell> tail;
+    for (IntType i = 0; pair != nullptr && i != count; ++i) {
+        CheckCancelled();
+        auto cell = MakeNode<Cell>();
+        cell->SetFirst(pair->GetFirst());
+        if (tail != nullptr) {
+            tail->SetSecond(cell);
+        } else {
+            list = cell;
+        }
+        tail = std::move(cell);
+        if (i + 1 != count) {
+            pair = GetStreamPair(StreamRest(pair));
+        }
+    }
+    return list;
+}
+
+ObjectPtr StreamForEach::Apply(std::vector<ObjectPtr> values,
+                               const std::shared_ptr<ScopesCollection>& scopes) {
+    AssertArgsCountEqual(values, 2);
+    auto procedure = std::move(values.front());
+    auto pair = GetStreamPair(values[1]);
+    values.clear();
+    while (pair != nullptr) {
+        CheckCancelled();
+        CallProcedure(procedure, {pair->GetFirst()}, scopes);
+        pair = GetStreamPair(StreamRest(pair));
+    }
+    return nullptr;
+}
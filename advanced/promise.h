@@ -0,0 +1,159 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <funcs.h>
+#include <object.h>
+
+// Promises and the streams built from them.
+//
+// (delay expr) makes a promise that evaluates expr on the first force and remembers the value.
+// (delay-force expr) is delay for an expr that yields another promise: forcing it forces that
+// promise in the same loop rather than recursively, so chains of delay-force run in constant
+// stack (R7RS 4.2.5). (make-promise value) makes an already forced promise.
+//
+// A stream is () or a pair whose cdr is a promise of a stream; (cons-stream a b) is
+// (cons a (delay b)). stream-map, stream-filter and stream-take build their results lazily
+// and stream-ref, stream->list and stream-for-each consume a stream element by element, all
+// of them iteratively. The consumers drop every pair they pass, so a pipeline over a generator
+// runs in constant memory as long as the program doesn't keep the head of the stream bound
+// elsewhere.
+//
+// Promises may be forced from several threads; the expression of a promise forced
+// concurrently may then run more than once, but all of them see the value stored first. A
+// promise shared with forks (see Interpreter::Fork) is remembered for all of them.
+
+class Promise : public Object {
+public:
+    using Thunk = std::function<ObjectPtr()>;
+
+    // Evaluates expression in scopes on the first force. delay_force is set for delay-force.
+    Promise(ObjectPtr expression, std::shared_ptr<ScopesCollection> scopes, bool delay_force);
+    // Calls thunk on the first force.
+    explicit Promise(Thunk thunk);
+    // Already forced.
+    explicit Promise(ObjectPtr value);
+
+    // Throws RuntimeError if a delay-force expression doesn't give a promise.
+    static ObjectPtr Force(const std::shared_ptr<Promise>& promise);
+
+    std::string Serialize() override;
+    ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) override;
+
+private:
+    struct State;
+
+    // Replaced by the state of the promise a delay-force gives, so forcing either of them
+    // later reuses the value.
+    std::shared_ptr<State> state_;
+};
+
+// force: forces promises, returns other objects unchanged.
+ObjectPtr Force(const ObjectPtr& object);
+
+// delay and delay-force.
+class Delay : public UnevaluatingArgumentFunction {
+public:
+    explicit Delay(bool delay_force) : delay_force_(delay_force) {
+    }
+
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+
+private:
+    bool delay_force_;
+};
+
+class ForcePromise : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+class MakePromise : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+class ConsStream : public UnevaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+class StreamCar : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+class StreamCdr : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+class IsStreamPair : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+// Stream procedures evaluate their own arguments and take ownership of the values: an
+// argument vector held by the caller for the whole call would keep the head of the stream,
+// and with it every pair forced so far, alive.
+class StreamFunction : public UnevaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+
+protected:
+    virtual ObjectPtr Apply(std::vector<ObjectPtr> values,
+                            const std::shared_ptr<ScopesCollection>& scopes) = 0;
+};
+
+// (stream-map proc stream)
+class StreamMap : public StreamFunction {
+protected:
+    ObjectPtr Apply(std::vector<ObjectPtr> values,
+                    const std::shared_ptr<ScopesCollection>& scopes) override;
+};
+
+// (stream-filter pred stream)
+class StreamFilter : public StreamFunction {
+protected:
+    ObjectPtr Apply(std::vector<ObjectPtr> values,
+                    const std::shared_ptr<ScopesCollection>& scopes) override;
+};
+
+// (stream-take n stream)
+class StreamTake : public StreamFunction {
+protected:
+    ObjectPtr Apply(std::vector<ObjectPtr> values,
+                    const std::shared_ptr<ScopesCollection>& scopes) override;
+};
+
+// (stream-ref stream k)
+class StreamRef : public StreamFunction {
+protected:
+    ObjectPtr Apply(std::vector<ObjectPtr> values,
+                    const std::shared_ptr<ScopesCollection>& scopes) override;
+};
+
+// (stream->list stream) or (stream->list n stream)
+class StreamToList : public StreamFunction {
+protected:
+    ObjectPtr Apply(std::vector<ObjectPtr> values,
+                    const std::shared_ptr<ScopesCollection>& scopes) override;
+};
+
+// (stream-for-each proc stream)
+class StreamForEach : public StreamFunction {
+protected:
+    ObjectPtr Apply(std::vector<ObjectPtr> values,
+                    const std::shared_ptr<ScopesCollection>& scopes) override;
+};
@@ -1,10 +1,138 @@
+#include <tokenizer.h>
+#include <csignal>
 #include <iostream>
+#include <string_view>
+#include <vector>
 
 #include <error.h>
 #include <scheme.h>
+#include <server.h>
 
-int main() {
+// Runs body and reports interpreter errors; returns false if one was caught.
+template <typename Body>
+bool ReportErrors(Body&& body) {
+    try {
+        body();
+        return true;
+    } catch (const SyntaxError& syntax_error) {
+        std::cerr << "Caught SyntaxError: " << syntax_error.what() << std::endl;
+    } catch (const NameError& name_error) {
+        std::cerr << "Caught NameError: " << name_error.what() << std::endl;
+    } catch (const RuntimeError& runtime_error) {
+        std::cerr << "Caught RuntimeError: " << runtime_error.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Caught unknown exception" << std::endl;
+    }
+    return false;
+}
+
+const char* GetErrorName(RunError error) {
+    switch (error) {
+        case RunError::SYNTAX:
+            return "SyntaxError";
+        case RunError::NAME:
+            return "NameError";
+        case RunError::RUNTIME:
+            return "RuntimeError";
+        case RunError::CANCELLED:
+            return "Cancelled";
+        default:
+            return "unknown exception";
+    }
+}
+
+// Evaluates stdin line by line in batches, printing exactly one line per input line.
+void RunBatches(Interpreter* interpreter) {
+    constexpr size_t kBatchSize = 4096;
+    std::vector<std::string> lines;
+    lines.reserve(kBatchSize);
+    std::string line;
+    bool more = true;
+    while (more) {
+        lines.clear();
+        while (lines.size() < kBatchSize) {
+            more = static_cast<bool>(std::getline(std::cin, line));
+            if (!more) {
+                break;
+            }
+            lines.push_back(std::move(line));
+        }
+        auto results = interpreter->RunBatch(lines);
+        interpreter->FlushOutput();
+        for (const auto& result : results) {
+            if (result.error == RunError::NONE) {
+                std::cout << "=> " << result.output << '\n';
+            } else {
+                std::cout << "Caught " << GetErrorName(result.error) << ": " << result.output
+                          << '\n';
+            }
+        }
+    }
+    std::cout.flush();
+}
+
+EvalServer* running_server = nullptr;
+
+void StopServer(int) {
+    running_server->Stop();
+}
+
+// Serves sessions on a Unix domain socket until SIGINT or SIGTERM; every session starts from
+// the environment built by the optional prelude file.
+int Serve(Interpreter* interpreter, const char* path, const char* prelude) {
+    if (prelude != nullptr && !ReportErrors([&] { interpreter->RunFile(prelude); })) {
+        return 1;
+    }
+    bool ok = ReportErrors([&] {
+        EvalServer server{path, interpreter};
+        running_server = &server;
+        std::signal(SIGINT, StopServer);
+        std::signal(SIGTERM, StopServer);
+        server.Run();
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        running_server = nullptr;
+    });
+    return ok ? 0 : 1;
+}
+
+// Usage:
+//   scheme_advanced_repl         line-by-line REPL, one expression per line
+//   scheme_advanced_repl --batch evaluate stdin line by line in batches; every line gives one
+//                                line of output, the result or the error
+//   scheme_advanced_repl --serve SOCKET [PRELUDE]
+//                                evaluation server on a Unix domain socket (see server.h)
+//   scheme_advanced_repl -       evaluate every form read from stdin, printing each result
+//   scheme_advanced_repl FILE    evaluate every form of FILE, printing the last result;
+//                                FILE may be a .scmc image from scheme_advanced_compile
+int main(int argc, char** argv) {
     Interpreter interpreter;
+
+    if (argc > 1) {
+        std::string_view source = argv[1];
+        if (source == "--batch") {
+            RunBatches(&interpreter);
+            return 0;
+        }
+        if (source == "--serve" && argc > 2) {
+            return Serve(&interpreter, argv[2], argc > 3 ? argv[3] : nullptr);
+        }
+        auto print_result = [&interpreter](const std::string& result) {
+            interpreter.FlushOutput();
+            std::cout << "=> " << result << std::endl;
+        };
+        bool ok = ReportErrors([&] {
+            if (source == "-") {
+                interpreter.RunStream(std::cin, print_result);
+            } else if (source.ends_with(".scmc")) {
+                print_result(interpreter.RunCompiled(argv[1]));
+            } else {
+                print_result(interpreter.RunFile(argv[1]));
+            }
+        });
+        return ok ? 0 : 1;
+    }
+
     std::string query;
 
     while (true) {
@@ -15,17 +143,10 @@ int main() {
             break;
         }
 
-        try {
+        ReportErrors([&] {
             auto result = interpreter.Run(query);
+            interpreter.FlushOutput();
             std::cout << "=> " << result << std::endl;
-        } catch (const SyntaxError& syntax_error) {
-            std::cerr << "Caught SyntaxError: " << syntax_error.what() << std::endl;
-        } catch (const NameError& name_error) {
-            std::cerr << "Caught NameError: " << name_error.what() << std::endl;
-        } catch (const RuntimeError& runtime_error) {
-            std::cerr << "Caught RuntimeError: " << runtime_error.what() << std::endl;
-        } catch (...) {
-            std::cerr << "Caught unknown exception" << std::endl;
-        }
+        });
     }
 }
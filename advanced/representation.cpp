@@ -1,9 +1,28 @@
 #include "representation.h"
+#include "host_vector.h"
+
+namespace {
+
+// Host views are proper lists of their elements.
+void AppendTail(const ObjectPtr& tail, std::vector<ObjectPtr>* answer) {
+    if (auto view = As<HostVector>(tail)) {
+        for (auto element : view->GetElements()) {
+            answer->push_back(MakeNode<Number>(element));
+        }
+        answer->push_back(nullptr);
+        return;
+    }
+    answer->push_back(tail);
+}
+
+}  // namespace
 
 std::vector<ObjectPtr> Flatten(const ObjectPtr& root) {
     std::shared_ptr<Cell> cur_cell = As<Cell>(root);
     if (cur_cell == nullptr) {
-        return {root};
+        std::vector<ObjectPtr> answer;
+        AppendTail(root, &answer);
+        return answer;
     }
 
     ObjectPtr next;
@@ -14,7 +33,7 @@ std::vector<ObjectPtr> Flatten(const ObjectPtr& root) {
         auto next = cur_cell->GetSecond();
         auto next_cell = As<Cell>(next);
         if (next_cell == nullptr) {
-            answer.push_back(next);
+            AppendTail(next, &answer);
             return answer;
         }
         cur_cell = next_cell;
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+enum class RunError { NONE, SYNTAX, NAME, RUNTIME, CANCELLED, UNKNOWN };
+
+struct RunResult {
+    RunError error = RunError::NONE;
+    // The serialized result, or the error message.
+    std::string output;
+};
@@ -1,25 +1,306 @@
 #include "scheme.h"
 #include "scope.h"
 #include <algorithm>
+#include <fstream>
 #include <sstream>
 #include <unordered_map>
 #include <tokenizer.h>
 #include <parser.h>
 #include <funcs.h>
 #include <evaluate.h>
+#include <compiled.h>
+#include <flat_ast.h>
+#include <image.h>
+#include <lazy_body.h>
+#include <mapped_file.h>
+#include <memory_stream.h>
+#include <port.h>
+#include <representation.h>
+#include <serializer.h>
 
-Interpreter::Interpreter()
-    : scope_(std::make_shared<Scope>(std::unordered_map<std::string, ObjectPtr>{},
+Interpreter::Interpreter() : Interpreter(InterpreterOptions{}) {
+}
+
+Interpreter::Interpreter(const InterpreterOptions& options)
+    : options_(options),
+      scope_(std::make_shared<Scope>(std::unordered_map<std::string, ObjectPtr>{},
                                      GetBuiltinsScope())) {
+    if (options.share_constants) {
+        read_options_.constants = std::make_shared<ConstantPool>();
+    }
+    if (options.flat_evaluation) {
+        read_options_.flat = true;
+        Define("define", MakeNode<::Define>(true));
+        Define("lambda", MakeNode<LambdaMaker>(true));
+    }
+    read_options_.lazy_bodies = options.lazy_bodies;
+    if (options.parse_cache_entries > 0) {
+        parse_cache_ =
+            std::make_unique<ParseCache>(options.parse_cache_entries, options.parse_cache_bytes);
+    }
+    if (options.share_constants || options.flat_evaluation || options.lazy_bodies) {
+        // Libraries loaded by this interpreter are read the same way.
+        Define("load", MakeNode<Load>(read_options_));
+    }
+}
+
+Interpreter::Interpreter(const Interpreter& parent, ForkTag)
+    : options_(parent.options_),
+      scope_(parent.scope_),
+      read_options_(parent.read_options_),
+      host_names_(parent.host_names_),
+      fork_(std::make_shared<ForkOverlay>(*parent.fork_)) {
+    if (options_.parse_cache_entries > 0) {
+        parse_cache_ =
+            std::make_unique<ParseCache>(options_.parse_cache_entries, options_.parse_cache_bytes);
+    }
+}
+
+Interpreter Interpreter::Fork() {
+    fork_->SetGeneration(fork_generation.fetch_add(1, std::memory_order_relaxed) + 1);
+    return Interpreter(*this, ForkTag{});
+}
+
+PreparedProgram::PreparedProgram(std::shared_ptr<Lambda> lambda,
+                                 std::shared_ptr<ScopesCollection> scopes,
+                                 std::shared_ptr<ForkOverlay> fork)
+    : lambda_(std::move(lambda)), scopes_(std::move(scopes)), fork_(std::move(fork)) {
 }
+
+std::string PreparedProgram::Execute(const std::vector<ObjectPtr>& arguments) const {
+    ForkScope fork{fork_.get()};
+    return Serialize(lambda_->Invoke(arguments, scopes_));
+}
+
+std::string PreparedProgram::Execute(std::initializer_list<IntType> arguments) const {
+    std::vector<ObjectPtr> values;
+    values.reserve(arguments.size());
+    for (auto value : arguments) {
+        values.push_back(MakeNode<Number>(value));
+    }
+    return Execute(values);
+}
+
 std::string Interpreter::Run(const std::string& program) {
-    std::stringstream string_stream{program};
-    Tokenizer tokenizer{&string_stream};
+    std::string output;
+    Run(program, &output);
+    return output;
+}
+
+void Interpreter::Run(const std::string& program, std::string* output) {
+    ForkScope fork{fork_.get()};
+    MemoryStream stream{{}};
+    auto result = EvaluateProgram(program, &stream, MakeScopes());
+    output->clear();
+    SerializeTo(result, output);
+}
 
-    auto program_ast = Read(&tokenizer);
-    auto scopes = std::shared_ptr<ScopesCollection>(
-        new ScopesCollection(std::vector<std::shared_ptr<Scope>>{scope_}));
-    auto evaluation_result_ast = Evaluate(program_ast, scopes);
+void Interpreter::RunEncoded(const std::string& program, std::string* output,
+                             const WireOptions& options) {
+    ForkScope fork{fork_.get()};
+    MemoryStream stream{{}};
+    auto result = EvaluateProgram(program, &stream, MakeScopes());
+    output->clear();
+    Encode(result, output, options);
+}
+
+std::vector<RunResult> Interpreter::RunBatch(std::span<const std::string> programs) {
+    std::vector<RunResult> results(programs.size());
+    MemoryStream stream{{}};
+    auto scopes = MakeScopes();
+
+    for (size_t i = 0; i < programs.size(); ++i) {
+        results[i] = RunCaptured(programs[i], &stream, scopes);
+    }
+    return results;
+}
+
+std::shared_ptr<AsyncRun> Interpreter::RunAsync(const std::string& program,
+                                                AsyncRun::CompletionCallback on_done) {
+    if (executor_ == nullptr) {
+        executor_ = std::make_unique<AsyncExecutor>([this](const std::string& source) {
+            MemoryStream stream{{}};
+            return RunCaptured(source, &stream, MakeScopes());
+        });
+    }
+    auto run = std::make_shared<AsyncRun>(program, std::move(on_done));
+    executor_->Submit(run);
+    return run;
+}
+
+RunResult Interpreter::RunCaptured(const std::string& program, MemoryStream* stream,
+                                   const std::shared_ptr<ScopesCollection>& scopes) {
+    ForkScope fork{fork_.get()};
+    RunResult result;
+    try {
+        result.output = Serialize(EvaluateProgram(program, stream, scopes));
+    } catch (const SyntaxError& error) {
+        result.error = RunError::SYNTAX;
+        result.output = error.what();
+    } catch (const NameError& error) {
+        result.error = RunError::NAME;
+        result.output = error.what();
+    } catch (const RuntimeError& error) {
+        result.error = RunError::RUNTIME;
+        result.output = error.what();
+    } catch (const Cancelled& error) {
+        result.error = RunError::CANCELLED;
+        result.output = error.what();
+    } catch (const std::exception& error) {
+        result.error = RunError::UNKNOWN;
+        result.output = error.what();
+    } catch (...) {
+        result.error = RunError::UNKNOWN;
+        result.output = "unknown error";
+    }
+    return result;
+}
+
+ObjectPtr Interpreter::EvaluateProgram(const std::string& program, MemoryStream* stream,
+                                       const std::shared_ptr<ScopesCollection>& scopes) {
+    if (parse_cache_ == nullptr && !read_options_.flat) {
+        return Evaluate(ReadProgram(program, read_options_, stream), scopes);
+    }
+
+    std::shared_ptr<const ParsedProgram> parsed;
+    if (parse_cache_ != nullptr) {
+        parsed = parse_cache_->Find(program);
+    }
+    if (parsed == nullptr) {
+        parsed = Parse(program, stream);
+        if (parse_cache_ != nullptr) {
+            parse_cache_->Insert(program, parsed);
+        }
+    }
+
+    return parsed->flat != nullptr ? parsed->flat->Evaluate(scopes) : Evaluate(parsed->ast, scopes);
+}
+
+void Interpreter::SaveImage(const std::string& path) const {
+    if (fork_->GetGeneration() != 0) {
+        throw RuntimeError("can't save an image of a forked interpreter");
+    }
+    std::ofstream out{path, std::ios::binary};
+    WriteImage(scope_, host_names_, &out);
+    out.close();
+    if (!out) {
+        throw RuntimeError("can't write image: " + path);
+    }
+}
+
+void Interpreter::LoadImage(const std::string& path) {
+    ForkScope fork{fork_.get()};
+    RestoreImage(path, scope_);
+}
 
-    return Serialize(evaluation_result_ast);
-}
\ No newline at end of file
+void Interpreter::Define(const std::string& name, ObjectPtr value) {
+    ForkScope fork{fork_.get()};
+    scope_->Set(name, std::move(value), true);
+    host_names_.insert(name);
+}
+
+void Interpreter::SetOutput(std::ostream* out) {
+    Define("current-output-port", MakeNode<CurrentPort>(std::make_shared<OutputPort>(out)));
+}
+
+void Interpreter::SetInput(std::istream* in) {
+    Define("current-input-port", MakeNode<CurrentPort>(std::make_shared<InputPort>(in)));
+}
+
+void Interpreter::FlushOutput() {
+    ForkScope fork{fork_.get()};
+    GetCurrentOutputPort(MakeScopes())->Flush();
+}
+
+ParseCacheStats Interpreter::GetParseCacheStats() const {
+    return parse_cache_ != nullptr ? parse_cache_->GetStats() : ParseCacheStats{};
+}
+
+std::string Interpreter::RunStream(std::istream& in, const ResultCallback& on_result) {
+    return RunStream(in, read_options_, on_result);
+}
+
+std::string Interpreter::RunStream(std::istream& in, const ReadOptions& read_options,
+                                   const ResultCallback& on_result) {
+    ForkScope fork{fork_.get()};
+    Tokenizer tokenizer{&in};
+
+    std::function<void(const ObjectPtr&)> serialize_result;
+    if (on_result) {
+        serialize_result = [&on_result](const ObjectPtr& result) { on_result(Serialize(result)); };
+    }
+
+    return Serialize(EvaluateForms(&tokenizer, MakeScopes(), read_options, serialize_result));
+}
+
+std::string Interpreter::RunFile(const std::string& path, const ResultCallback& on_result) {
+    auto options = read_options_;
+    options.source = MapSourceFile(path);
+    MemoryStream stream{options.source->text};
+    return RunStream(stream, options, on_result);
+}
+
+std::string Interpreter::RunCompiled(const std::string& path, const ResultCallback& on_result) {
+    ForkScope fork{fork_.get()};
+    MappedFile file{path};
+    auto forms = ReadCompiled(file.GetText());
+    auto scopes = MakeScopes();
+
+    ObjectPtr last_result;
+    for (auto& form : forms) {
+        last_result = read_options_.flat ? FlatProgram({form}).Evaluate(scopes)
+                                         : Evaluate(form, scopes);
+        form.reset();
+        if (on_result) {
+            on_result(Serialize(last_result));
+        }
+    }
+
+    return Serialize(last_result);
+}
+
+PreparedProgram Interpreter::Prepare(const std::string& program,
+                                     const std::vector<std::string>& parameters) {
+    std::vector<ObjectPtr> parameter_symbols;
+    for (const auto& name : parameters) {
+        parameter_symbols.push_back(MakeNode<Symbol>(name));
+    }
+    parameter_symbols.push_back(nullptr);
+
+    MemoryStream stream{{}};
+    auto scopes = MakeScopes();
+    auto lambda = std::make_shared<Lambda>(
+        std::vector<ObjectPtr>{ToAst(parameter_symbols),
+                               ReadProgram(program, read_options_, &stream)},
+        scopes, read_options_.flat);
+    return PreparedProgram(std::move(lambda), std::move(scopes), fork_);
+}
+
+ObjectPtr Interpreter::ReadProgram(const std::string& program, ReadOptions options,
+                                   MemoryStream* stream) {
+    if (options.lazy_bodies) {
+        options.source = CopySourceText(program);
+    }
+    stream->Reset(options.source != nullptr ? options.source->text : program);
+    Tokenizer tokenizer{stream};
+    return Read(&tokenizer, options);
+}
+
+std::shared_ptr<const ParsedProgram> Interpreter::Parse(const std::string& program,
+                                                        MemoryStream* stream) {
+    auto options = read_options_;
+    if (parse_cache_ != nullptr && options.constants == nullptr) {
+        options.constants = parse_cache_->GetConstants();
+    }
+
+    auto parsed = std::make_shared<ParsedProgram>();
+    parsed->ast = ReadProgram(program, options, stream);
+    if (options.flat) {
+        parsed->flat = std::make_shared<FlatProgram>(std::vector<ObjectPtr>{parsed->ast});
+    }
+    return parsed;
+}
+
+std::shared_ptr<ScopesCollection> Interpreter::MakeScopes() {
+    return std::make_shared<ScopesCollection>(std::vector<std::shared_ptr<Scope>>{scope_});
+}
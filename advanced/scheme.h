@@ -1,17 +1,169 @@
 #pragma once
 
+#include <functional>
+#include <initializer_list>
+#include <span>
+#include <istream>
+#include <ostream>
 #include <string>
+#include <unordered_set>
 #include "scope.h"
+#include <parser.h>
+#include <parse_cache.h>
+#include <native.h>
+#include <async.h>
+#include <fork.h>
+#include <run_result.h>
+#include <wire.h>
 #include <vector>
 #include <memory>
 #include "scope_fwd.h"
 
+struct InterpreterOptions {
+    // Hash-cons quoted constants of every program read, so structurally equal literals share
+    // one representation. Shared constants are immutable: set-car!/set-cdr! on them raise
+    // RuntimeError.
+    bool share_constants = false;
+    // Evaluate programs and function bodies in the flat representation (see flat_ast.h).
+    bool flat_evaluation = false;
+    // Read function bodies only when they are first called (see ReadOptions::lazy_bodies).
+    // Applies to Run, RunFile and load, which keep the source text alive while needed.
+    bool lazy_bodies = false;
+    // Keep up to this many programs parsed by Run, keyed by their text, and evict the least
+    // recently used ones beyond the memory estimate below. 0 disables the cache. Quoted data
+    // of cached programs is shared between runs and so is immutable, as with share_constants.
+    size_t parse_cache_entries = 0;
+    size_t parse_cache_bytes = 16 << 20;
+};
+
+class Lambda;
+class MemoryStream;
+
+// A program read once and run many times with different values of its parameters; see
+// Interpreter::Prepare.
+class PreparedProgram {
+public:
+    // Binds the arguments to the parameters in a fresh frame and evaluates the program.
+    std::string Execute(const std::vector<ObjectPtr>& arguments) const;
+    std::string Execute(std::initializer_list<IntType> arguments) const;
+
+private:
+    friend class Interpreter;
+
+    PreparedProgram(std::shared_ptr<Lambda> lambda, std::shared_ptr<ScopesCollection> scopes,
+                    std::shared_ptr<ForkOverlay> fork);
+
+    std::shared_ptr<Lambda> lambda_;
+    std::shared_ptr<ScopesCollection> scopes_;
+    std::shared_ptr<ForkOverlay> fork_;
+};
+
 class Interpreter {
 public:
+    using ResultCallback = std::function<void(const std::string&)>;
+
     Interpreter();
+    explicit Interpreter(const InterpreterOptions& options);
+
+    // Async runs refer to the interpreter by address, so it stays where it was created.
+    Interpreter(Interpreter&&) = delete;
+    Interpreter& operator=(Interpreter&&) = delete;
 
     std::string Run(const std::string& program);
+    // Like Run, but writes the result into output, replacing its contents and reusing its
+    // capacity.
+    void Run(const std::string& program, std::string* output);
+    // Like Run, but writes the result as a wire message (see wire.h), for callers that ship
+    // it to another process.
+    void RunEncoded(const std::string& program, std::string* output,
+                    const WireOptions& options = {});
+
+    // Runs every program like Run, sharing the reading and evaluation setup between them.
+    // Errors are reported per program instead of being thrown.
+    std::vector<RunResult> RunBatch(std::span<const std::string> programs);
+
+    // Queues program to be run like Run on a thread owned by the interpreter and returns at
+    // once. Programs run one at a time in submission order; on_done, if set, is called on that
+    // thread with the result. While runs are pending, the interpreter must not be used from
+    // other threads except through the returned handles. Destroying the interpreter cancels
+    // them.
+    std::shared_ptr<AsyncRun> RunAsync(const std::string& program,
+                                       AsyncRun::CompletionCallback on_done = {});
+
+    // Reads, evaluates and drops top-level forms one at a time and returns the result of the
+    // last one. If on_result is set, it receives the result of every form as it is evaluated.
+    std::string RunStream(std::istream& in, const ResultCallback& on_result = {});
+    std::string RunFile(const std::string& path, const ResultCallback& on_result = {});
+
+    // Evaluates a program precompiled by scheme_advanced_compile (see compiled.h).
+    std::string RunCompiled(const std::string& path, const ResultCallback& on_result = {});
+
+    // Reads program once; it then runs in this interpreter's environment as the body of a
+    // function of the given parameters.
+    PreparedProgram Prepare(const std::string& program,
+                            const std::vector<std::string>& parameters);
+
+    // Defines a builtin implemented by a C++ function or lambda, e.g.
+    // Register("dot", [](IntType a, IntType b) { return a * b; }). See native.h for the
+    // supported parameter and result types.
+    template <typename Function>
+    void Register(const std::string& name, Function function) {
+        Define(name, MakeNativeFunction(std::move(function)));
+    }
+
+    // Saves the global environment to a heap image (see image.h), which LoadImage restores
+    // in a fresh interpreter, possibly in another process. Functions and values registered by
+    // the host are not saved; the restoring interpreter must register them before LoadImage.
+    // Interpreters that took part in a Fork can't be saved.
+    void SaveImage(const std::string& path) const;
+    void LoadImage(const std::string& path);
+
+    // Returns a child interpreter that starts with this interpreter's global environment and
+    // heap. Nothing is copied: afterwards, the parent and the child see the shared state
+    // read-only, and each copies on write what it modifies (bindings, set! and set-car!/
+    // set-cdr! of shared pairs) into its own overlay, so changes stay private to the one
+    // making them. They may then be used concurrently from different threads. Must not be
+    // called while async runs are pending. The child can't be moved; keep it where it is
+    // initialized, e.g. with new Interpreter(parent.Fork()).
+    Interpreter Fork();
+
+    // Binds a value, e.g. a host list view (see host_vector.h), in the global environment.
+    void Define(const std::string& name, ObjectPtr value);
+
+    // Sets the ports that display, read and friends use when called without one (see port.h),
+    // initially the process's standard output and input. The streams must outlive the
+    // interpreter.
+    void SetOutput(std::ostream* out);
+    void SetInput(std::istream* in);
+    // Output ports buffer what is written; this hands it to the current output stream.
+    void FlushOutput();
+
+    // Zeroes if the parse cache is disabled.
+    ParseCacheStats GetParseCacheStats() const;
 
 private:
+    struct ForkTag {};
+
+    InterpreterOptions options_;
     std::shared_ptr<Scope> scope_;
-};
\ No newline at end of file
+    ReadOptions read_options_;
+    std::unique_ptr<ParseCache> parse_cache_;
+    // Global bindings made by the host rather than by programs; not saved in images.
+    std::unordered_set<std::string> host_names_;
+    // Installed for the thread while this interpreter evaluates; see fork.h.
+    std::shared_ptr<ForkOverlay> fork_ = std::make_shared<ForkOverlay>();
+    // Declared last: its thread uses the members above until it is joined.
+    std::unique_ptr<AsyncExecutor> executor_;
+
+    ObjectPtr ReadProgram(const std::string& program, ReadOptions options, MemoryStream* stream);
+    std::shared_ptr<const ParsedProgram> Parse(const std::string& program, MemoryStream* stream);
+    Interpreter(const Interpreter& parent, ForkTag);
+
+    RunResult RunCaptured(const std::string& program, MemoryStream* stream,
+                          const std::shared_ptr<ScopesCollection>& scopes);
+    ObjectPtr EvaluateProgram(const std::string& program, MemoryStream* stream,
+                              const std::shared_ptr<ScopesCollection>& scopes);
+    std::shared_ptr<ScopesCollection> MakeScopes();
+    std::string RunStream(std::istream& in, const ReadOptions& read_options,
+                          const ResultCallback& on_result);
+};
@@ -10,16 +10,40 @@ class Scope : public std::enable_shared_from_this<Scope> {
 public:
     Scope(const std::unordered_map<std::string, std::shared_ptr<Object>>& objects,
           const std::shared_ptr<Scope>& parent)
-        : objects_(objects), parent_(parent) {
+        : objects_(objects), parent_(parent), generation_(GetForkGeneration()) {
     }
 
     std::shared_ptr<Object> Get(const std::string& key) {
-        auto it = Find(key);
-        return it.has_value() ? it.value()->second : nullptr;
+        auto* value = Find(key, nullptr);
+        return value != nullptr ? *value : nullptr;
+    }
+
+    // Unlike Get, tells a name bound to () from an unbound one.
+    bool Lookup(const std::string& key, std::shared_ptr<Object>* value) {
+        auto* found = Find(key, nullptr);
+        if (found == nullptr) {
+            return false;
+        }
+        *value = *found;
+        return true;
     }
 
     bool ContainsInChain(const std::string& key) {
-        return Find(key).has_value();
+        return Find(key, nullptr) != nullptr;
+    }
+
+    // The bindings made in this scope itself; doesn't include those of a fork (see fork.h).
+    const std::unordered_map<std::string, std::shared_ptr<Object>>& GetObjects() const {
+        return objects_;
+    }
+    const std::shared_ptr<Scope>& GetParent() const {
+        return parent_;
+    }
+
+    // The bindings of a frozen scope, such as the builtins that all interpreters share, never
+    // change: setting one of them binds the name in the scope right below instead.
+    void Freeze() {
+        frozen_ = true;
     }
 
     void Set(const std::string& key, const std::shared_ptr<Object>& value, bool in_current_scope) {
@@ -28,10 +52,18 @@ public:
             return;
         }
 
-        auto it = Find(key);
-
-        if (it.has_value()) {
-            it.value()->second = value;
+        Scope* owner;
+        Scope* below;
+        auto* found = Find(key, &owner, &below);
+
+        if (found != nullptr) {
+            if (owner->frozen_) {
+                below->UpdateValue(key, value);
+            } else if (owner->IsForkShared()) {
+                current_fork->SetBinding(owner, key, value);
+            } else {
+                *found = value;
+            }
             return;
         }
 
@@ -43,21 +75,46 @@ private:
 
     std::shared_ptr<Scope> parent_;
 
-    std::optional<std::unordered_map<std::string, std::shared_ptr<Object>>::iterator> Find(
-        const std::string& key) {
-        auto cur = shared_from_this();
+    uint32_t generation_;
+    bool frozen_ = false;
+
+    // Created before the fork of the evaluating interpreter; see fork.h.
+    bool IsForkShared() const {
+        return generation_ < current_fork_generation;
+    }
 
-        while (cur) {
-            if (cur->objects_.contains(key)) {
-                return cur->objects_.find(key);
+    // *below is set to the scope whose parent is the owner, or to the owner if it is this.
+    std::shared_ptr<Object>* Find(const std::string& key, Scope** owner, Scope** below = nullptr) {
+        for (Scope *cur = this, *previous = this; cur != nullptr;
+             previous = cur, cur = cur->parent_.get()) {
+            std::shared_ptr<Object>* value = nullptr;
+            if (cur->IsForkShared()) {
+                value = current_fork->FindBinding(cur, key);
+            }
+            if (value == nullptr) {
+                if (auto it = cur->objects_.find(key); it != cur->objects_.end()) {
+                    value = &it->second;
+                }
+            }
+            if (value != nullptr) {
+                if (owner != nullptr) {
+                    *owner = cur;
+                }
+                if (below != nullptr) {
+                    *below = previous;
+                }
+                return value;
             }
-            cur = cur->parent_;
         }
 
-        return std::nullopt;
+        return nullptr;
     }
 
     void UpdateValue(const std::string& key, const std::shared_ptr<Object>& value) {
+        if (IsForkShared()) {
+            current_fork->SetBinding(this, key, value);
+            return;
+        }
         objects_.insert_or_assign(key, value);
     }
 };
@@ -75,14 +132,23 @@ public:
         }
     }
 
+    const std::vector<std::shared_ptr<Scope>>& GetScopes() const {
+        return scopes_;
+    }
+
     std::shared_ptr<Object> Get(const std::string& key) {
+        std::shared_ptr<Object> value;
+        Lookup(key, &value);
+        return value;
+    }
+
+    bool Lookup(const std::string& key, std::shared_ptr<Object>* value) {
         for (auto& scope : scopes_) {
-            auto res = scope->Get(key);
-            if (res != nullptr) {
-                return res;
+            if (scope->Lookup(key, value)) {
+                return true;
             }
         }
-        return nullptr;
+        return false;
     }
 
     void Set(const std::string& key, const std::shared_ptr<Object>& value, bool in_first_scope) {
@@ -0,0 +1,240 @@
+#include "serializer.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <error.h>
+#include <host_vector.h>
+#include <vector.h>
+
+namespace {
+
+constexpr size_t kFlushSize = 64 << 10;
+
+// Cycles are only possible through pairs changed by set-car!/set-cdr!. The search stops at
+// the first one, so it terminates on cyclic structure as well.
+bool ReachesMutatedPair(const Cell* root) {
+    std::vector<const Cell*> stack{root};
+    while (!stack.empty()) {
+        const auto* cell = stack.back();
+        stack.pop_back();
+        if (cell->IsMutated()) {
+            return true;
+        }
+        const auto& [first, second] = cell->GetChildren();
+        if (auto* next = dynamic_cast<const Cell*>(second.get())) {
+            stack.push_back(next);
+        }
+        if (auto* child = dynamic_cast<const Cell*>(first.get())) {
+            stack.push_back(child);
+        }
+    }
+    return false;
+}
+
+// Depth-first search for pairs reached again while they are being visited or, with `shared`,
+// reached again at all.
+std::unordered_map<const Cell*, int64_t> FindRevisitedPairs(const Cell* root, bool shared) {
+    enum class Visit : uint8_t { ACTIVE, DONE };
+    struct Step {
+        const Cell* cell;
+        uint8_t next_child;
+    };
+
+    std::unordered_map<const Cell*, int64_t> revisited;
+    std::unordered_map<const Cell*, Visit> visits;
+    std::vector<Step> stack;
+    auto enter = [&](const Cell* cell) {
+        if (cell == nullptr) {
+            return;
+        }
+        auto [it, inserted] = visits.try_emplace(cell, Visit::ACTIVE);
+        if (inserted) {
+            stack.push_back({cell, 0});
+        } else if (shared || it->second == Visit::ACTIVE) {
+            revisited.try_emplace(cell, -1);
+        }
+    };
+
+    enter(root);
+    while (!stack.empty()) {
+        auto& step = stack.back();
+        if (step.next_child == 2) {
+            visits[step.cell] = Visit::DONE;
+            stack.pop_back();
+            continue;
+        }
+        const auto& children = step.cell->GetChildren();
+        const auto& child = step.next_child++ == 0 ? children.first : children.second;
+        enter(dynamic_cast<const Cell*>(child.get()));
+    }
+    return revisited;
+}
+
+class Writer {
+public:
+    Writer(std::string* buffer, std::ostream* out) : buffer_(buffer), out_(out) {
+    }
+
+    void Write(const ObjectPtr& root) {
+        WriteItem(root, true);
+        while (!frames_.empty()) {
+            auto& frame = frames_.back();
+            if (frame.vector != nullptr) {
+                const auto& elements = frame.vector->GetElements();
+                if (frame.index < elements.size()) {
+                    if (frame.index > 0) {
+                        *buffer_ += ' ';
+                    }
+                    // May push a frame, so `frame` isn't used afterwards.
+                    WriteItem(elements[frame.index++], true);
+                    continue;
+                }
+                *buffer_ += ')';
+                open_vectors_.erase(frame.vector);
+                frames_.pop_back();
+                Flush(false);
+                continue;
+            }
+
+            if (frame.cell != nullptr) {
+                if (!frame.first) {
+                    *buffer_ += ' ';
+                }
+                frame.first = false;
+                const auto& first = frame.cell->GetChildren().first;
+                Advance(&frame);
+                // May push a frame, so `frame` isn't used afterwards.
+                WriteItem(first);
+                continue;
+            }
+
+            if (frame.tail != nullptr) {
+                auto tail = std::move(frame.tail);
+                frame.tail = nullptr;
+                if (auto* view = dynamic_cast<const HostVector*>(tail.get())) {
+                    // Host views are proper lists of their elements.
+                    for (auto element : view->GetElements()) {
+                        *buffer_ += ' ';
+                        *buffer_ += std::to_string(element);
+                    }
+                } else {
+                    *buffer_ += " . ";
+                    WriteItem(tail);
+                }
+                continue;
+            }
+
+            *buffer_ += ')';
+            frames_.pop_back();
+            Flush(false);
+        }
+    }
+
+    void Flush(bool all) {
+        if (out_ != nullptr && (all || buffer_->size() >= kFlushSize)) {
+            out_->write(buffer_->data(), static_cast<std::streamsize>(buffer_->size()));
+            buffer_->clear();
+        }
+    }
+
+private:
+    // A list being written: `cell` is the next pair of its spine, `tail` what ends it once
+    // the spine is done, unless it is (). Or a vector being written, from element `index` on.
+    struct Frame {
+        const Cell* cell;
+        ObjectPtr tail;
+        bool first;
+        const Vector* vector = nullptr;
+        size_t index = 0;
+    };
+
+    std::string* buffer_;
+    std::ostream* out_;
+    std::unordered_map<const Cell*, int64_t> labels_;
+    int64_t next_label_ = 0;
+    std::vector<Frame> frames_;
+    // Vector-set! can make a vector contain itself, which can't be written.
+    std::unordered_set<const Vector*> open_vectors_;
+
+    void WriteAtom(const ObjectPtr& object) {
+        if (object == nullptr) {
+            *buffer_ += "()";
+        } else {
+            *buffer_ += object->Serialize();
+        }
+        Flush(false);
+    }
+
+    // Lists reached from a vector are searched for cycles like the root is, since the search
+    // doesn't look into vectors.
+    void WriteItem(const ObjectPtr& object, bool find_labels = false) {
+        if (auto* cell = dynamic_cast<const Cell*>(object.get())) {
+            if (find_labels) {
+                labels_.merge(FindLabelledPairs(cell, false));
+            }
+            Open(cell);
+        } else if (auto* vector = dynamic_cast<const Vector*>(object.get())) {
+            OpenVector(vector);
+        } else {
+            WriteAtom(object);
+        }
+    }
+
+    void OpenVector(const Vector* vector) {
+        if (!open_vectors_.insert(vector).second) {
+            throw RuntimeError("can't write a vector that contains itself");
+        }
+        *buffer_ += "#(";
+        frames_.push_back({nullptr, nullptr, true, vector});
+    }
+
+    void Open(const Cell* cell) {
+        if (auto it = labels_.find(cell); it != labels_.end()) {
+            if (it->second >= 0) {
+                *buffer_ += '#' + std::to_string(it->second) + '#';
+                return;
+            }
+            it->second = next_label_++;
+            *buffer_ += '#' + std::to_string(it->second) + '=';
+        }
+        *buffer_ += '(';
+        frames_.push_back({cell, nullptr, true});
+    }
+
+    // Moves to the next pair of the spine; labelled pairs are written as a dotted tail.
+    void Advance(Frame* frame) {
+        const auto& next = frame->cell->GetChildren().second;
+        auto* next_cell = dynamic_cast<const Cell*>(next.get());
+        if (next_cell != nullptr && !labels_.contains(next_cell)) {
+            frame->cell = next_cell;
+            return;
+        }
+        frame->cell = nullptr;
+        frame->tail = next;
+    }
+};
+
+}  // namespace
+
+std::unordered_map<const Cell*, int64_t> FindLabelledPairs(const Cell* root, bool shared) {
+    if (!shared && !ReachesMutatedPair(root)) {
+        return {};
+    }
+    return FindRevisitedPairs(root, shared);
+}
+
+void SerializeTo(const ObjectPtr& root, std::string* out) {
+    Writer writer{out, nullptr};
+    writer.Write(root);
+}
+
+void SerializeTo(const ObjectPtr& root, std::ostream* out) {
+    std::string buffer;
+    buffer.reserve(kFlushSize);
+    Writer writer{&buffer, out};
+    writer.Write(root);
+    writer.Flush(true);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <object.h>
+
+// Writes the external representation of a value without recursion, so arbitrarily deep lists
+// and vectors can be written, and without building intermediate strings for nested lists.
+// Throws RuntimeError for a vector that contains itself.
+//
+// Pairs that are part of a cycle are written with datum labels, e.g. a list closed with
+// set-cdr! as #0=(1 2 . #0#). Shared pairs that don't form a cycle are written every time
+// they are reached.
+
+// Appends to out.
+void SerializeTo(const ObjectPtr& root, std::string* out);
+
+// Streams to out in chunks.
+void SerializeTo(const ObjectPtr& root, std::ostream* out);
+
+// Pairs of root that writers refer to by label: the targets of cycles, and with `shared` set
+// every pair reached more than once. They are mapped to -1, for the writer to number them in
+// the order it writes them.
+std::unordered_map<const Cell*, int64_t> FindLabelledPairs(const Cell* root, bool shared);
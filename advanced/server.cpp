@@ -0,0 +1,343 @@
+#include "server.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <span>
+
+#include <error.h>
+
+namespace {
+
+constexpr size_t kHeaderSize = 4;
+constexpr size_t kReadSize = 64 << 10;
+constexpr int kMaxEvents = 64;
+
+[[noreturn]] void ThrowSystemError(const std::string& what) {
+    throw RuntimeError(what + ": " + std::strerror(errno));
+}
+
+void AppendUint32(std::string* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out->push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+uint32_t ReadUint32(const char* data) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+sockaddr_un MakeAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw RuntimeError("socket path too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+void WriteFully(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        auto written = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("can't write to server");
+        }
+        offset += static_cast<size_t>(written);
+    }
+}
+
+void ReadFully(int fd, char* data, size_t size) {
+    size_t offset = 0;
+    while (offset < size) {
+        auto count = read(fd, data + offset, size - offset);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("can't read from server");
+        }
+        if (count == 0) {
+            throw RuntimeError("server closed the connection");
+        }
+        offset += static_cast<size_t>(count);
+    }
+}
+
+}  // namespace
+
+EvalServer::EvalServer(const std::string& path, Interpreter* base, const ServerOptions& options)
+    : path_(path), base_(base), options_(options) {
+    try {
+        Listen();
+    } catch (...) {
+        CloseDescriptors();
+        throw;
+    }
+}
+
+void EvalServer::Listen() {
+    auto address = MakeAddress(path_);
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (listen_fd_ < 0 || epoll_fd_ < 0 || stop_fd_ < 0) {
+        ThrowSystemError("can't create server");
+    }
+
+    unlink(path_.c_str());
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listen_fd_, SOMAXCONN) < 0) {
+        ThrowSystemError("can't listen on " + path_);
+    }
+
+    for (auto fd : {listen_fd_, stop_fd_}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ThrowSystemError("can't create server");
+        }
+    }
+}
+
+EvalServer::~EvalServer() {
+    for (auto& [fd, session] : sessions_) {
+        close(fd);
+    }
+    CloseDescriptors();
+    unlink(path_.c_str());
+}
+
+void EvalServer::CloseDescriptors() {
+    for (auto fd : {listen_fd_, epoll_fd_, stop_fd_}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+void EvalServer::Run() {
+    epoll_event events[kMaxEvents];
+    while (true) {
+        auto count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("epoll_wait failed");
+        }
+
+        for (int i = 0; i < count; ++i) {
+            auto fd = events[i].data.fd;
+            if (fd == stop_fd_) {
+                uint64_t value;
+                [[maybe_unused]] auto drained = read(stop_fd_, &value, sizeof(value));
+                return;
+            }
+            if (fd == listen_fd_) {
+                Accept();
+                continue;
+            }
+
+            auto* session = sessions_.at(fd).get();
+            bool open = true;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                open = ReadRequests(session);
+            }
+            if (open && (events[i].events & EPOLLOUT)) {
+                open = WriteResponses(session);
+            }
+            if (!open) {
+                Close(fd);
+            }
+        }
+    }
+}
+
+void EvalServer::Stop() {
+    uint64_t one = 1;
+    [[maybe_unused]] auto written = write(stop_fd_, &one, sizeof(one));
+}
+
+void EvalServer::Accept() {
+    while (true) {
+        auto fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR &&
+                errno != ECONNABORTED) {
+                ThrowSystemError("accept failed");
+            }
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return;
+        }
+
+        auto session = std::make_unique<Session>(fd, base_);
+        session->interpreter.SetOutput(&session->printed);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            continue;
+        }
+        sessions_.emplace(fd, std::move(session));
+    }
+}
+
+bool EvalServer::ReadRequests(Session* session) {
+    // One read per wakeup, so a busy session doesn't starve the others.
+    auto offset = session->input.size();
+    session->input.resize(offset + kReadSize);
+    auto count = read(session->fd, session->input.data() + offset, kReadSize);
+    session->input.resize(offset + static_cast<size_t>(std::max<ssize_t>(count, 0)));
+    if (count == 0) {
+        return false;
+    }
+    if (count < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+
+    size_t consumed = 0;
+    std::string program;
+    while (session->input.size() - consumed >= kHeaderSize) {
+        auto size = ReadUint32(session->input.data() + consumed);
+        if (size > options_.max_message_size) {
+            return false;
+        }
+        if (session->input.size() - consumed - kHeaderSize < size) {
+            break;
+        }
+        program.assign(session->input, consumed + kHeaderSize, size);
+        consumed += kHeaderSize + size;
+        Evaluate(session, program);
+    }
+    session->input.erase(0, consumed);
+
+    return WriteResponses(session);
+}
+
+bool EvalServer::WriteResponses(Session* session) {
+    auto& output = session->output;
+    while (session->output_offset < output.size()) {
+        auto written = send(session->fd, output.data() + session->output_offset,
+                            output.size() - session->output_offset, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return false;
+            }
+            if (!session->waiting_to_write) {
+                epoll_event event{};
+                event.events = EPOLLIN | EPOLLOUT;
+                event.data.fd = session->fd;
+                epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, session->fd, &event);
+                session->waiting_to_write = true;
+            }
+            return true;
+        }
+        session->output_offset += static_cast<size_t>(written);
+    }
+
+    output.clear();
+    session->output_offset = 0;
+    if (session->waiting_to_write) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = session->fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, session->fd, &event);
+        session->waiting_to_write = false;
+    }
+    return true;
+}
+
+void EvalServer::Evaluate(Session* session, const std::string& program) {
+    auto result = std::move(session->interpreter.RunBatch(std::span(&program, 1)).front());
+    try {
+        session->interpreter.FlushOutput();
+    } catch (const RuntimeError&) {
+        // The program rebound current-output-port; nothing was printed through it.
+    }
+    auto printed = session->printed.str();
+    session->printed.str({});
+
+    auto& output = session->output;
+    AppendUint32(&output, static_cast<uint32_t>(1 + 4 + printed.size() + result.output.size()));
+    output.push_back(static_cast<char>(result.error));
+    AppendUint32(&output, static_cast<uint32_t>(printed.size()));
+    output += printed;
+    output += result.output;
+}
+
+void EvalServer::Close(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    sessions_.erase(fd);
+}
+
+EvalClient::EvalClient(const std::string& path) {
+    auto address = MakeAddress(path);
+    fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        ThrowSystemError("can't create socket");
+    }
+    if (connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd_);
+        ThrowSystemError("can't connect to " + path);
+    }
+}
+
+EvalClient::~EvalClient() {
+    close(fd_);
+}
+
+ServerResponse EvalClient::Run(const std::string& program) {
+    Send(program);
+    return Receive();
+}
+
+void EvalClient::Send(const std::string& program) {
+    std::string message;
+    message.reserve(kHeaderSize + program.size());
+    AppendUint32(&message, static_cast<uint32_t>(program.size()));
+    message += program;
+    WriteFully(fd_, message);
+}
+
+ServerResponse EvalClient::Receive() {
+    char header[kHeaderSize];
+    ReadFully(fd_, header, kHeaderSize);
+    std::string message(ReadUint32(header), '\0');
+    ReadFully(fd_, message.data(), message.size());
+    if (message.size() < 1 + kHeaderSize) {
+        throw RuntimeError("malformed server response");
+    }
+
+    ServerResponse response;
+    response.error = static_cast<RunError>(message[0]);
+    auto printed_size = ReadUint32(message.data() + 1);
+    if (printed_size > message.size() - 1 - kHeaderSize) {
+        throw RuntimeError("malformed server response");
+    }
+    response.printed = message.substr(1 + kHeaderSize, printed_size);
+    response.output = message.substr(1 + kHeaderSize + printed_size);
+    return response;
+}
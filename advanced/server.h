@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include <run_result.h>
+#include <scheme.h>
+
+// Evaluation server on a Unix domain socket, so a long-lived process serves many short jobs
+// without paying interpreter startup for each. One thread multiplexes all client sessions with
+// epoll; every session evaluates in an interpreter of its own, a fork of the server's base
+// interpreter (see Interpreter::Fork), so definitions made by one session are invisible to
+// the others. Builtins rebound by a session's set! are private to it as well.
+//
+// Requests are evaluated on the epoll thread, so a long evaluation holds up every other
+// session until it finishes; give such work to a server of its own.
+//
+// Framing: every message is a 4-byte little-endian length followed by that many bytes.
+// Requests hold program text. Responses hold a RunError status byte, the 4-byte length of what
+// the program wrote to its current output port, that output and then the serialized result or
+// the error message. Requests of a session are answered in order.
+
+struct ServerOptions {
+    // Sessions sending a longer request are closed.
+    uint32_t max_message_size = 64 << 20;
+};
+
+struct ServerResponse {
+    RunError error = RunError::NONE;
+    // What the program wrote with display and friends.
+    std::string printed;
+    // The serialized result, or the error message.
+    std::string output;
+};
+
+class EvalServer {
+public:
+    // Listens at path, replacing a stale socket file. The server forks base for every session
+    // and base must not be used elsewhere while the server runs.
+    EvalServer(const std::string& path, Interpreter* base, const ServerOptions& options = {});
+    // Closes all sessions and removes the socket file.
+    ~EvalServer();
+
+    EvalServer(const EvalServer&) = delete;
+    EvalServer& operator=(const EvalServer&) = delete;
+
+    // Serves until Stop is called. Requests are evaluated on the calling thread.
+    void Run();
+    // Makes Run return. May be called from any thread and from signal handlers.
+    void Stop();
+
+private:
+    struct Session {
+        Session(int fd, Interpreter* base) : fd(fd), interpreter(base->Fork()) {
+        }
+
+        int fd;
+        // Declared before the interpreter, whose output port writes to it when destroyed.
+        std::ostringstream printed;
+        Interpreter interpreter;
+        std::string input;
+        std::string output;
+        size_t output_offset = 0;
+        bool waiting_to_write = false;
+    };
+
+    std::string path_;
+    Interpreter* base_;
+    ServerOptions options_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int stop_fd_ = -1;
+    std::unordered_map<int, std::unique_ptr<Session>> sessions_;
+
+    void Accept();
+    // Return false if the session has to be closed.
+    bool ReadRequests(Session* session);
+    bool WriteResponses(Session* session);
+    void Evaluate(Session* session, const std::string& program);
+    void Listen();
+    void Close(int fd);
+    void CloseDescriptors();
+};
+
+// Blocking client of EvalServer.
+class EvalClient {
+public:
+    explicit EvalClient(const std::string& path);
+    ~EvalClient();
+
+    EvalClient(const EvalClient&) = delete;
+    EvalClient& operator=(const EvalClient&) = delete;
+
+    ServerResponse Run(const std::string& program);
+
+    // Send several requests before receiving their responses to pipeline them.
+    void Send(const std::string& program);
+    ServerResponse Receive();
+
+private:
+    int fd_;
+};
@@ -3,8 +3,26 @@ add_library(scheme_advanced
         parser.cpp
         scheme.cpp
         funcs.cpp
+        bigint.cpp
         representation.cpp
         object.cpp
         evaluate.cpp
         scope.cpp
+        mapped_file.cpp
+        compiled.cpp
+        parallel_reader.cpp
+        constants.cpp
+        flat_ast.cpp
+        lazy_body.cpp
+        parse_cache.cpp
+        host_vector.cpp
+        async.cpp
+        image.cpp
+        fork.cpp
+        serializer.cpp
+        wire.cpp
+        port.cpp
+        promise.cpp
+        server.cpp
+        vector.cpp
 )
\ No newline at end of file
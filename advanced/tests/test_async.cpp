@@ -0,0 +1,108 @@
+#include <catch.hpp>
+
+#include <poll.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+
+#include <scheme.h>
+
+namespace {
+
+// The async executor refers to its interpreter by address.
+static_assert(!std::is_move_constructible_v<Interpreter>);
+static_assert(!std::is_move_assignable_v<Interpreter>);
+
+const char* kFib =
+    "(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))";
+
+}  // namespace
+
+TEST_CASE("Async results") {
+    Interpreter interpreter;
+    auto define = interpreter.RunAsync("(define x 20)");
+    auto sum = interpreter.RunAsync("(+ x 22)");
+    auto error = interpreter.RunAsync("(car 1)");
+
+    REQUIRE(sum->Wait().error == RunError::NONE);
+    REQUIRE(sum->Wait().output == "42");
+    REQUIRE(define->IsDone());
+    REQUIRE(error->Wait().error == RunError::RUNTIME);
+    REQUIRE(error->Wait().output == "not a list");
+
+    // Definitions made asynchronously are visible to Run once the runs are done.
+    REQUIRE(interpreter.Run("x") == "20");
+}
+
+TEST_CASE("Async runs report exceptions of any type") {
+    Interpreter interpreter;
+    interpreter.Register("fail", [](IntType x) -> IntType { throw x; });
+    auto failed = interpreter.RunAsync("(fail 2)");
+    auto next = interpreter.RunAsync("(+ 1 2)");
+
+    REQUIRE(failed->Wait().error == RunError::UNKNOWN);
+    REQUIRE(next->Wait().output == "3");
+}
+
+TEST_CASE("Async completion callback") {
+    Interpreter interpreter;
+    std::atomic<int> calls = 0;
+    std::string output;
+    auto run = interpreter.RunAsync("(* 6 7)", [&](const RunResult& result) {
+        output = result.output;
+        ++calls;
+    });
+    run->Wait();
+    // The callback runs after the waiters are woken up.
+    while (calls == 0) {
+        std::this_thread::yield();
+    }
+    REQUIRE(output == "42");
+    REQUIRE(calls == 1);
+}
+
+TEST_CASE("Async completion eventfd") {
+    Interpreter interpreter;
+    auto run = interpreter.RunAsync("(list 1 2)");
+
+    pollfd descriptor{.fd = run->GetEventFd(), .events = POLLIN, .revents = 0};
+    REQUIRE(poll(&descriptor, 1, 10000) == 1);
+    REQUIRE((descriptor.revents & POLLIN) != 0);
+    REQUIRE(run->IsDone());
+    REQUIRE(run->Wait().output == "(1 2)");
+}
+
+TEST_CASE("Async cancellation") {
+    Interpreter interpreter;
+    interpreter.Run(kFib);
+
+    auto slow = interpreter.RunAsync("(fib 40)");
+    auto queued = interpreter.RunAsync("(fib 40)");
+    auto next = interpreter.RunAsync("(fib 10)");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queued->Cancel();
+    slow->Cancel();
+
+    REQUIRE(slow->Wait().error == RunError::CANCELLED);
+    REQUIRE(queued->Wait().error == RunError::CANCELLED);
+    REQUIRE(next->Wait().output == "55");
+
+    // Cancelling a finished run has no effect.
+    next->Cancel();
+    REQUIRE(next->Wait().error == RunError::NONE);
+    REQUIRE(interpreter.Run("(fib 10)") == "55");
+}
+
+TEST_CASE("Destroying the interpreter cancels pending runs") {
+    std::shared_ptr<AsyncRun> run;
+    {
+        Interpreter interpreter;
+        interpreter.Run(kFib);
+        run = interpreter.RunAsync("(fib 40)");
+    }
+    REQUIRE(run->IsDone());
+    REQUIRE(run->Wait().error == RunError::CANCELLED);
+}
@@ -0,0 +1,54 @@
+#include <catch.hpp>
+
+#include <string>
+#include <vector>
+
+#include <scheme.h>
+
+TEST_CASE("Batch results and errors") {
+    Interpreter interpreter;
+    std::vector<std::string> programs = {
+        "(define x 20)", "(+ x 22)", "(+ 1", "undefined", "(car 1)", "'(1 2)", "(* x 2)",
+    };
+    auto results = interpreter.RunBatch(programs);
+    REQUIRE(results.size() == programs.size());
+
+    REQUIRE(results[0].error == RunError::NONE);
+    REQUIRE(results[1].error == RunError::NONE);
+    REQUIRE(results[1].output == "42");
+    REQUIRE(results[2].error == RunError::SYNTAX);
+    REQUIRE(results[3].error == RunError::NAME);
+    REQUIRE(results[4].error == RunError::RUNTIME);
+    REQUIRE(results[4].output == "not a list");
+    REQUIRE(results[5].output == "(1 2)");
+    REQUIRE(results[6].output == "40");
+
+    // Definitions made by a batch persist.
+    REQUIRE(interpreter.Run("x") == "20");
+}
+
+TEST_CASE("Batch reports exceptions of any type") {
+    Interpreter interpreter;
+    interpreter.Register("fail", [](IntType x) -> IntType { throw x; });
+    std::vector<std::string> programs = {"(fail 1)", "(+ 1 2)"};
+    auto results = interpreter.RunBatch(programs);
+
+    REQUIRE(results[0].error == RunError::UNKNOWN);
+    REQUIRE(results[1].output == "3");
+}
+
+TEST_CASE("Empty batch") {
+    Interpreter interpreter;
+    REQUIRE(interpreter.RunBatch({}).empty());
+}
+
+TEST_CASE("Batch with the parse cache") {
+    InterpreterOptions options;
+    options.parse_cache_entries = 8;
+    Interpreter interpreter{options};
+    std::vector<std::string> programs(100, "(+ 1 2)");
+    for (const auto& result : interpreter.RunBatch(programs)) {
+        REQUIRE(result.output == "3");
+    }
+    REQUIRE(interpreter.GetParseCacheStats().hits == 99);
+}
@@ -0,0 +1,131 @@
+#include <catch.hpp>
+
+#include <cstdint>
+#include <string>
+
+#include <bigint.h>
+#include <error.h>
+#include <scheme.h>
+#include <wire.h>
+
+namespace {
+
+// Deterministic digits, so failures reproduce.
+std::string MakeDigits(size_t count, uint32_t seed) {
+    std::string digits;
+    for (size_t i = 0; i < count; ++i) {
+        seed = seed * 1103515245 + 12345;
+        digits += static_cast<char>('0' + (seed >> 16) % 10);
+    }
+    digits[0] = digits[0] == '0' ? '1' : digits[0];
+    return digits;
+}
+
+}  // namespace
+
+TEST_CASE("Fixnum overflow promotes to bignums") {
+    Interpreter interpreter;
+    REQUIRE(interpreter.Run("(+ 9223372036854775807 1)") == "9223372036854775808");
+    REQUIRE(interpreter.Run("(- -9223372036854775808 1)") == "-9223372036854775809");
+    REQUIRE(interpreter.Run("(* 4294967296 4294967296)") == "18446744073709551616");
+    REQUIRE(interpreter.Run("(* -4294967296 4294967296 -1)") == "18446744073709551616");
+    REQUIRE(interpreter.Run("(abs -9223372036854775808)") == "9223372036854775808");
+    REQUIRE(interpreter.Run("(/ -9223372036854775808 -1)") == "9223372036854775808");
+
+    // Results that fit are fixnums again.
+    REQUIRE(interpreter.Run("(- (+ 9223372036854775807 1) 1)") == "9223372036854775807");
+    REQUIRE(interpreter.Run("(/ (* 4294967296 4294967296) 4294967296)") == "4294967296");
+    REQUIRE(interpreter.Run("(number? (* 4294967296 4294967296))") == "#t");
+}
+
+TEST_CASE("Bignum literals and comparisons") {
+    Interpreter interpreter;
+    REQUIRE(interpreter.Run("123456789012345678901234567890") ==
+            "123456789012345678901234567890");
+    REQUIRE(interpreter.Run("'(-123456789012345678901234567890 +99999999999999999999)") ==
+            "(-123456789012345678901234567890 99999999999999999999)");
+    REQUIRE(interpreter.Run("-9223372036854775808") == "-9223372036854775808");
+
+    interpreter.Run("(define big 100000000000000000000)");
+    REQUIRE(interpreter.Run("(< 1 big)") == "#t");
+    REQUIRE(interpreter.Run("(< (* -1 big) 1 big)") == "#t");
+    REQUIRE(interpreter.Run("(= big (* 10000000000 10000000000))") == "#t");
+    REQUIRE(interpreter.Run("(>= big (+ big 1))") == "#f");
+    REQUIRE(interpreter.Run("(max 1 big 5)") == "100000000000000000000");
+    REQUIRE(interpreter.Run("(min 1 (* -1 big) 5)") == "-100000000000000000000");
+    REQUIRE_THROWS_AS(interpreter.Run("(+ big 'a)"), RuntimeError);
+}
+
+TEST_CASE("Division") {
+    Interpreter interpreter;
+    REQUIRE(interpreter.Run("(/ 7 2)") == "3");
+    REQUIRE(interpreter.Run("(/ -7 2)") == "-3");
+    REQUIRE_THROWS_AS(interpreter.Run("(/ 1 0)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(/ 100000000000000000000 0)"), RuntimeError);
+    REQUIRE(interpreter.Run("(/ 100000000000000000000 -3)") == "-33333333333333333333");
+    REQUIRE(interpreter.Run("(/ 100000000000000000000 30000000000000000000)") == "3");
+
+    for (size_t size : {20, 60, 300}) {
+        auto first = BigInt::FromString(MakeDigits(2 * size, size));
+        auto second = BigInt::FromString("-" + MakeDigits(size, size + 1));
+        auto quotient = first / second;
+        auto remainder = first % second;
+        REQUIRE(quotient * second + remainder == first);
+        REQUIRE(remainder.Abs() < second.Abs());
+        REQUIRE(!remainder.IsNegative());
+    }
+}
+
+TEST_CASE("Bignum multiplication") {
+    Interpreter interpreter;
+    interpreter.Run("(define (fact n) (if (= n 0) 1 (* n (fact (- n 1)))))");
+    REQUIRE(interpreter.Run("(fact 30)") == "265252859812191058636308480000000");
+    REQUIRE(interpreter.Run("(fact 100)") ==
+            "93326215443944152681699238856266700490715968264381621468592963895217599993229915"
+            "608941463976156518286253697920827223758251185210916864000000000000000000000000");
+
+    // (10^k - 1)^2 = 10^2k - 2 10^k + 1, across the Karatsuba threshold.
+    for (size_t k : {5, 300, 2000}) {
+        auto nines = BigInt::FromString(std::string(k, '9'));
+        auto expected = std::string(k - 1, '9') + "8" + std::string(k - 1, '0') + "1";
+        REQUIRE((nines * nines).ToString() == expected);
+    }
+
+    // Karatsuba agrees with multiplying by the parts of an operand.
+    auto first = BigInt::FromString(MakeDigits(3000, 1));
+    auto second = BigInt::FromString(MakeDigits(1000, 2));
+    auto third = BigInt::FromString(MakeDigits(900, 3));
+    REQUIRE(first * (second + third) == first * second + first * third);
+    REQUIRE((first * second) / second == first);
+}
+
+TEST_CASE("BigInt square roots") {
+    REQUIRE(BigInt(0).Sqrt() == BigInt(0));
+    REQUIRE(BigInt(1).Sqrt() == BigInt(1));
+    REQUIRE(BigInt(15).Sqrt() == BigInt(3));
+    REQUIRE(BigInt(16).Sqrt() == BigInt(4));
+    REQUIRE_THROWS_AS(BigInt(-4).Sqrt(), RuntimeError);
+
+    auto root = BigInt::FromString(MakeDigits(700, 3));
+    REQUIRE((root * root).Sqrt() == root);
+    REQUIRE((root * root - 1).Sqrt() == root - 1);
+    REQUIRE((root * root + root * 2).Sqrt() == root);
+}
+
+TEST_CASE("BigInt conversions") {
+    REQUIRE(BigInt(0).ToString() == "0");
+    REQUIRE(BigInt(-42).ToString() == "-42");
+    REQUIRE(BigInt::FromString("-0").ToString() == "0");
+    REQUIRE(BigInt::FromString("000123").ToString() == "123");
+    REQUIRE(BigInt::FromString("1000000000000000000").ToString() == "1000000000000000000");
+    REQUIRE(BigInt::FromString("-9223372036854775808").FitsIntType());
+    REQUIRE(!BigInt::FromString("9223372036854775808").FitsIntType());
+    REQUIRE(BigInt::FromString("-9223372036854775808").ToIntType() == INT64_MIN);
+    REQUIRE_THROWS_AS(BigInt::FromString("12a"), SyntaxError);
+
+    auto value = MakeInteger(BigInt::FromString("-" + MakeDigits(500, 7)));
+    REQUIRE(Is<BigInteger>(value));
+    std::string message;
+    Encode(value, &message);
+    REQUIRE(Decode(message)->Serialize() == value->Serialize());
+}
@@ -0,0 +1,74 @@
+#include <catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <bigint.h>
+#include <compiled.h>
+#include <error.h>
+#include <scheme.h>
+
+std::string Compile(const std::string& source) {
+    std::stringstream in{source};
+    Tokenizer tokenizer{&in};
+    std::ostringstream out;
+    CompileForms(&tokenizer, &out);
+    return out.str();
+}
+
+TEST_CASE("Compiled forms round trip") {
+    auto image = Compile("(define (f x) (+ x 1)) '(1 (2 . 3) \"s\" ()) -7 sym ()");
+    auto forms = ReadCompiled(image);
+
+    REQUIRE(forms.size() == 5);
+    REQUIRE(forms[0]->Serialize() == "(define (f x) (+ x 1))");
+    REQUIRE(forms[1]->Serialize() == "(quote (1 (2 . 3) \"s\" ()))");
+    REQUIRE(As<Number>(forms[2])->GetValue() == -7);
+    REQUIRE(As<Symbol>(forms[3])->GetName() == "sym");
+    REQUIRE(forms[4] == nullptr);
+}
+
+TEST_CASE("Compiled numbers of every kind") {
+    auto forms = ReadCompiled(Compile("(1.5 -0.0 1e300 100000000000000000000 1.5) -7"));
+
+    REQUIRE(forms[0]->Serialize() == "(1.5 -0.0 1e+300 100000000000000000000 1.5)");
+    auto list = As<Cell>(forms[0]);
+    REQUIRE(Is<Flonum>(list->GetFirst()));
+    auto* rest = list.get();
+    for (int i = 0; i < 3; ++i) {
+        rest = As<Cell>(rest->GetSecond()).get();
+    }
+    REQUIRE(Is<BigInteger>(rest->GetFirst()));
+    // Equal flonums share a node like other atoms.
+    REQUIRE(list->GetFirst() == As<Cell>(rest->GetSecond())->GetFirst());
+    REQUIRE(As<Number>(forms[1])->GetValue() == -7);
+}
+
+TEST_CASE("Compiled symbols are interned") {
+    auto forms = ReadCompiled(Compile("(x x) x"));
+
+    auto list = As<Cell>(forms[0]);
+    REQUIRE(list->GetFirst() == As<Cell>(list->GetSecond())->GetFirst());
+    REQUIRE(list->GetFirst() == forms[1]);
+}
+
+TEST_CASE("Corrupted compiled program") {
+    REQUIRE_THROWS_AS(ReadCompiled("not an image"), RuntimeError);
+
+    auto image = Compile("(1 2 3)");
+    REQUIRE_THROWS_AS(ReadCompiled(image.substr(0, image.size() - 5)), RuntimeError);
+}
+
+TEST_CASE("RunCompiled") {
+    auto path = std::filesystem::temp_directory_path() / "scheme_test_run_compiled.scmc";
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << Compile("(define (fact n) (if (< n 2) 1 (* n (fact (- n 1)))))\n(fact 10)");
+    }
+
+    Interpreter interpreter;
+    REQUIRE(interpreter.RunCompiled(path.string()) == "3628800");
+    REQUIRE(interpreter.Run("(fact 5)") == "120");
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,68 @@
+#include <catch.hpp>
+
+#include <sstream>
+
+#include <constants.h>
+#include <error.h>
+#include <parser.h>
+#include <scheme.h>
+
+std::vector<ObjectPtr> ReadAllShared(const std::string& str,
+                                     const std::shared_ptr<ConstantPool>& pool) {
+    std::stringstream ss{str};
+    Tokenizer tokenizer{&ss};
+    ReadOptions options;
+    options.constants = pool;
+
+    std::vector<ObjectPtr> forms;
+    while (!tokenizer.IsEnd()) {
+        forms.push_back(Read(&tokenizer, options));
+    }
+    return forms;
+}
+
+ObjectPtr QuotedDatum(const ObjectPtr& quote_form) {
+    return As<Cell>(As<Cell>(quote_form)->GetSecond())->GetFirst();
+}
+
+TEST_CASE("Equal quoted constants are shared") {
+    auto pool = std::make_shared<ConstantPool>();
+    auto forms = ReadAllShared("'(1 (2 3) \"s\") (quote (1 (2 3) \"s\")) '(2 3) '(1 2) 'x", pool);
+
+    auto first = QuotedDatum(forms[0]);
+    REQUIRE(first == QuotedDatum(forms[1]));
+    REQUIRE(As<Cell>(first)->IsConstant());
+
+    auto inner = As<Cell>(As<Cell>(first)->GetSecond())->GetFirst();
+    REQUIRE(inner == QuotedDatum(forms[2]));
+    REQUIRE(QuotedDatum(forms[3]) != first);
+
+    // Code outside quotes is left alone.
+    REQUIRE(!As<Cell>(forms[0])->IsConstant());
+}
+
+TEST_CASE("Constants are dropped with their last user") {
+    auto pool = std::make_shared<ConstantPool>();
+    {
+        auto forms = ReadAllShared("'(1 2 3)", pool);
+        REQUIRE(pool->Size() > 0);
+    }
+    REQUIRE(pool->Size() == 0);
+}
+
+TEST_CASE("Shared constants are immutable") {
+    InterpreterOptions options;
+    options.share_constants = true;
+    Interpreter interpreter{options};
+
+    REQUIRE(interpreter.Run("(define x '(1 2 3))") == "()");
+    REQUIRE(interpreter.Run("(define y '(1 2 3))") == "()");
+    REQUIRE(interpreter.Run("y") == "(1 2 3)");
+    REQUIRE_THROWS_AS(interpreter.Run("(set-car! x 5)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(set-cdr! (cdr y) 5)"), RuntimeError);
+    REQUIRE(interpreter.Run("x") == "(1 2 3)");
+
+    REQUIRE(interpreter.Run("(define z (list 1 2 3))") == "()");
+    REQUIRE(interpreter.Run("(set-car! z 5)") == "()");
+    REQUIRE(interpreter.Run("z") == "(5 2 3)");
+}
@@ -0,0 +1,119 @@
+#include <catch.hpp>
+
+#include <sstream>
+
+#include <error.h>
+#include <evaluate.h>
+#include <flat_ast.h>
+#include <funcs.h>
+#include <scheme.h>
+
+namespace {
+
+FlatProgram ReadFlatString(const std::string& source) {
+    std::stringstream ss{source};
+    Tokenizer tokenizer{&ss};
+    return ReadFlat(&tokenizer);
+}
+
+class FlatInterpreter {
+public:
+    FlatInterpreter() : interpreter_(MakeOptions()) {
+    }
+
+    std::string Run(const std::string& program) {
+        return interpreter_.Run(program);
+    }
+
+private:
+    Interpreter interpreter_;
+
+    static InterpreterOptions MakeOptions() {
+        InterpreterOptions options;
+        options.flat_evaluation = true;
+        return options;
+    }
+};
+
+}  // namespace
+
+TEST_CASE("Flat layout") {
+    auto program = ReadFlatString("(f 1 (g x) '(a . b))");
+    const auto& nodes = program.GetNodes();
+    REQUIRE(program.GetRoots().size() == 1);
+
+    const auto& call = nodes[program.GetRoots().front()];
+    REQUIRE(call.kind == FlatNodeKind::CALL);
+    REQUIRE(call.argument_count == 3);
+    REQUIRE(nodes[call.first].kind == FlatNodeKind::VARIABLE);
+    REQUIRE(nodes[call.first + 1].kind == FlatNodeKind::CONSTANT);
+    REQUIRE(nodes[call.first + 2].kind == FlatNodeKind::CALL);
+    REQUIRE(nodes[call.first + 3].kind == FlatNodeKind::CALL);
+
+    const auto& inner = nodes[call.first + 2];
+    REQUIRE(inner.argument_count == 1);
+    REQUIRE(nodes[inner.first + 1].kind == FlatNodeKind::VARIABLE);
+
+    // The quoted pair is kept as one node.
+    const auto& quote = nodes[call.first + 3];
+    REQUIRE(nodes[quote.first + 1].kind == FlatNodeKind::DATUM);
+    REQUIRE(Serialize(nodes[quote.first + 1].object) == "(a . b)");
+}
+
+TEST_CASE("Flat evaluation matches tree evaluation") {
+    Interpreter tree;
+    FlatInterpreter flat;
+    const char* programs[] = {
+        "(+ 1 2 (* 3 4))",
+        "(if (< 1 2) 'yes 'no)",
+        "(if (> 1 2) 'yes)",
+        "(and 1 2 3)",
+        "(or (< 2 1) (list 1 2))",
+        "(and)",
+        "'(1 (2 . 3) \"s\")",
+        "(quote (a b))",
+        "(cons 1 (cons 2 '()))",
+        "(car (cdr '(1 2 3)))",
+        "((lambda (x y) (+ x y)) 1 2)",
+    };
+    for (const auto* program : programs) {
+        INFO(program);
+        REQUIRE(flat.Run(program) == tree.Run(program));
+    }
+}
+
+TEST_CASE("Flat evaluation of definitions and closures") {
+    FlatInterpreter flat;
+    flat.Run("(define (fact n) (if (< n 2) 1 (* n (fact (- n 1)))))");
+    REQUIRE(flat.Run("(fact 10)") == "3628800");
+
+    flat.Run("(define (make-counter) (define n 0) (lambda () (set! n (+ n 1)) n))");
+    flat.Run("(define counter (make-counter))");
+    flat.Run("(counter)");
+    REQUIRE(flat.Run("(counter)") == "2");
+
+    flat.Run("(define x '(1 2))");
+    flat.Run("(set-car! x 5)");
+    REQUIRE(flat.Run("x") == "(5 2)");
+}
+
+TEST_CASE("Flat evaluation errors") {
+    FlatInterpreter flat;
+    REQUIRE_THROWS_AS(flat.Run("undefined"), NameError);
+    REQUIRE_THROWS_AS(flat.Run("(set! undefined 1)"), NameError);
+    REQUIRE_THROWS_AS(flat.Run("(1 2)"), RuntimeError);
+    REQUIRE_THROWS_AS(flat.Run("(+ 1 . 2)"), RuntimeError);
+    REQUIRE_THROWS_AS(flat.Run("(if)"), SyntaxError);
+    REQUIRE_THROWS_AS(flat.Run("(quote)"), RuntimeError);
+    REQUIRE_THROWS_AS(flat.Run("((lambda (x) x))"), RuntimeError);
+    REQUIRE_THROWS_AS(flat.Run("(define)"), SyntaxError);
+
+    // Argument buffers are released after an error.
+    REQUIRE(flat.Run("(+ 1 (* 2 3))") == "7");
+}
+
+TEST_CASE("Flat evaluation respects rebound special forms") {
+    FlatInterpreter flat;
+    flat.Run("(define (quote x) (+ x 1))");
+    REQUIRE(flat.Run("(quote 41)") == "42");
+}
@@ -0,0 +1,90 @@
+#include <catch.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include <error.h>
+#include <scheme.h>
+#include <tokenizer.h>
+#include <wire.h>
+
+TEST_CASE("Flonum literals") {
+    std::stringstream ss{"1.5 -0.25 .5 2. 1e3 6.02E+23 1.5e-3 3"};
+    Tokenizer tokenizer{&ss};
+    for (double value : {1.5, -0.25, 0.5, 2.0, 1e3, 6.02e23, 1.5e-3}) {
+        REQUIRE(tokenizer.GetToken() == Token{FloatConstantToken{value}});
+        tokenizer.Next();
+    }
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{3}});
+
+    Interpreter interpreter;
+    REQUIRE(interpreter.Run("1.5") == "1.5");
+    REQUIRE(interpreter.Run("2.") == "2.0");
+    REQUIRE(interpreter.Run("'(0.1 -3.0 1e21 1e-7)") == "(0.1 -3.0 1e+21 1e-07)");
+    REQUIRE(interpreter.Run("1e400") == "+inf.0");
+    REQUIRE(interpreter.Run("'(1 . 2)") == "(1 . 2)");
+    REQUIRE(interpreter.Run("(number? 1.5)") == "#t");
+    REQUIRE_THROWS_AS(interpreter.Run("1e"), SyntaxError);
+}
+
+TEST_CASE("Mixed arithmetic") {
+    Interpreter interpreter;
+    REQUIRE(interpreter.Run("(+ 1 0.5)") == "1.5");
+    REQUIRE(interpreter.Run("(+ 0.5 1)") == "1.5");
+    REQUIRE(interpreter.Run("(* 2 1.5 2)") == "6.0");
+    REQUIRE(interpreter.Run("(- 1 0.25)") == "0.75");
+    REQUIRE(interpreter.Run("(/ 7 2.0)") == "3.5");
+    REQUIRE(interpreter.Run("(/ 7 2)") == "3");
+    REQUIRE(interpreter.Run("(/ 1.0 0)") == "+inf.0");
+    REQUIRE(interpreter.Run("(+ 100000000000000000000 0.5)") == "1e+20");
+    REQUIRE(interpreter.Run("(+ 9223372036854775807 1 1.0)") == "9223372036854775808.0");
+    REQUIRE(interpreter.Run("(max 1 2.0)") == "2.0");
+    REQUIRE(interpreter.Run("(min 1 2.0)") == "1.0");
+    REQUIRE(interpreter.Run("(abs -2.5)") == "2.5");
+    REQUIRE_THROWS_AS(interpreter.Run("(+ 1.5 'a)"), RuntimeError);
+
+    REQUIRE(interpreter.Run("(< 1 1.5 2)") == "#t");
+    REQUIRE(interpreter.Run("(= 2 2.0)") == "#t");
+    REQUIRE(interpreter.Run("(> 0.5 0.25 0)") == "#t");
+    REQUIRE(interpreter.Run("(< 100000000000000000000 1e21)") == "#t");
+    REQUIRE(interpreter.Run("(= (/ 0.0 0.0) (/ 0.0 0.0))") == "#f");
+}
+
+TEST_CASE("Flonum functions") {
+    Interpreter interpreter;
+    REQUIRE(interpreter.Run("(sqrt 16)") == "4");
+    REQUIRE(interpreter.Run("(sqrt 9223372030926249001)") == "3037000499");
+    REQUIRE(interpreter.Run("(sqrt 2)") == "1.4142135623730951");
+    REQUIRE(interpreter.Run("(sqrt 2.25)") == "1.5");
+    REQUIRE_THROWS_AS(interpreter.Run("(sqrt -1)"), RuntimeError);
+    REQUIRE(interpreter.Run("(sqrt (* 10000000000 10000000000))") == "10000000000");
+    REQUIRE(interpreter.Run("(sqrt (+ (* 10000000000 10000000000) 1))") == "1e+10");
+    REQUIRE_THROWS_AS(interpreter.Run("(sqrt (* -10000000000 10000000000))"), RuntimeError);
+    interpreter.Run("(define big (* 1" + std::string(200, '0') + " 1))");
+    REQUIRE(interpreter.Run("(= (sqrt (* big big)) big)") == "#t");
+    REQUIRE(interpreter.Run("(sqrt (+ (* big big) 1))") == "1e+200");
+    REQUIRE(interpreter.Run("(exp 0)") == "1.0");
+    REQUIRE(interpreter.Run("(exp 1)") == "2.718281828459045");
+    REQUIRE(interpreter.Run("(floor 2.5)") == "2.0");
+    REQUIRE(interpreter.Run("(floor -2.5)") == "-3.0");
+    REQUIRE(interpreter.Run("(floor 7)") == "7");
+    REQUIRE_THROWS_AS(interpreter.Run("(exp 'a)"), RuntimeError);
+
+    // Newton's method, to check a loop over flonums end to end.
+    interpreter.Run(
+        "(define (root x guess n) (if (= n 0) guess (root x (/ (+ guess (/ x guess)) 2) "
+        "(- n 1))))");
+    REQUIRE(interpreter.Run("(root 2.0 1.0 6)") == "1.414213562373095");
+}
+
+TEST_CASE("Flonums on the wire") {
+    for (double value : {1.5, -0.0, 1e300, 5e-324}) {
+        std::string message;
+        Encode(MakeNode<Flonum>(value), &message);
+        auto decoded = As<Flonum>(Decode(message));
+        REQUIRE(decoded != nullptr);
+        REQUIRE(std::bit_cast<uint64_t>(decoded->GetValue()) == std::bit_cast<uint64_t>(value));
+    }
+}
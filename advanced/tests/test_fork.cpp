@@ -0,0 +1,108 @@
+#include <catch.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <error.h>
+#include <scheme.h>
+
+TEST_CASE("Fork shares definitions") {
+    Interpreter parent;
+    parent.Run("(define (square x) (* x x))");
+    parent.Run("(define x 5)");
+
+    auto child = parent.Fork();
+    REQUIRE(child.Run("(square x)") == "25");
+}
+
+TEST_CASE("Fork copies bindings on write") {
+    Interpreter parent;
+    parent.Run("(define x 1)");
+    parent.Run("(define (get-x) x)");
+    parent.Run("(define (bump) (set! x (+ x 1)))");
+
+    auto child = parent.Fork();
+    child.Run("(define x 10)");
+    child.Run("(define y 2)");
+    REQUIRE(child.Run("(get-x)") == "10");
+    REQUIRE(parent.Run("(get-x)") == "1");
+    REQUIRE_THROWS_AS(parent.Run("y"), NameError);
+
+    child.Run("(bump)");
+    REQUIRE(child.Run("x") == "11");
+    REQUIRE(parent.Run("x") == "1");
+
+    // The parent's own changes after the fork are private as well.
+    parent.Run("(bump)");
+    REQUIRE(parent.Run("x") == "2");
+    REQUIRE(child.Run("x") == "11");
+}
+
+TEST_CASE("Fork copies pairs and closure frames on write") {
+    Interpreter parent;
+    parent.Run("(define data '(1 2 3))");
+    parent.Run("(define alias data)");
+    parent.Run("(define (make-counter) (define n 0) (lambda () (set! n (+ n 1)) n))");
+    parent.Run("(define counter (make-counter))");
+    parent.Run("(counter)");
+
+    auto child = parent.Fork();
+    child.Run("(set-car! data 5)");
+    child.Run("(set-cdr! (cdr data) '())");
+    REQUIRE(child.Run("alias") == "(5 2)");
+    REQUIRE(parent.Run("alias") == "(1 2 3)");
+
+    REQUIRE(child.Run("(counter)") == "2");
+    REQUIRE(child.Run("(counter)") == "3");
+    REQUIRE(parent.Run("(counter)") == "2");
+}
+
+TEST_CASE("Forks of forks") {
+    Interpreter parent;
+    parent.Run("(define x 1)");
+    auto child = parent.Fork();
+    child.Run("(set! x 2)");
+
+    auto grandchild = child.Fork();
+    REQUIRE(grandchild.Run("x") == "2");
+    grandchild.Run("(set! x 3)");
+    REQUIRE(child.Run("x") == "2");
+    REQUIRE(parent.Run("x") == "1");
+
+    auto sibling = parent.Fork();
+    REQUIRE(sibling.Run("x") == "1");
+}
+
+TEST_CASE("Forks run concurrently") {
+    Interpreter parent;
+    parent.Run("(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))");
+    parent.Run("(define results '())");
+
+    std::vector<std::unique_ptr<Interpreter>> children;
+    for (int i = 0; i < 4; ++i) {
+        children.emplace_back(new Interpreter(parent.Fork()));
+    }
+    std::vector<std::string> outputs(children.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < children.size(); ++i) {
+        threads.emplace_back([&, i] {
+            auto n = std::to_string(10 + i);
+            children[i]->Run("(set! results (cons (fib " + n + ") results))");
+            outputs[i] = children[i]->Run("results");
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(outputs == std::vector<std::string>{"(55)", "(89)", "(144)", "(233)"});
+    REQUIRE(parent.Run("results") == "()");
+}
+
+TEST_CASE("Forked interpreters can't be saved") {
+    Interpreter parent;
+    auto child = parent.Fork();
+    REQUIRE_THROWS_AS(child.SaveImage("unused.scmi"), RuntimeError);
+}
@@ -0,0 +1,68 @@
+#include <catch.hpp>
+
+#include <memory>
+#include <vector>
+
+#include <error.h>
+#include <host_vector.h>
+#include <scheme.h>
+
+TEST_CASE("Host vectors act as lists") {
+    std::vector<IntType> data = {5, 6, 7, 8};
+    Interpreter interpreter;
+    interpreter.Define("data", MakeHostList(data));
+
+    REQUIRE(interpreter.Run("data") == "(5 6 7 8)");
+    REQUIRE(interpreter.Run("(length data)") == "4");
+    REQUIRE(interpreter.Run("(list-ref data 2)") == "7");
+    REQUIRE(interpreter.Run("(car data)") == "5");
+    REQUIRE(interpreter.Run("(cdr data)") == "(6 7 8)");
+    REQUIRE(interpreter.Run("(list-tail data 3)") == "(8)");
+    REQUIRE(interpreter.Run("(list-tail data 4)") == "()");
+    REQUIRE(interpreter.Run("(cdr (cdr (cdr (cdr data))))") == "()");
+    REQUIRE(interpreter.Run("(list? data)") == "#t");
+    REQUIRE(interpreter.Run("(null? data)") == "#f");
+    REQUIRE(interpreter.Run("(cons 4 data)") == "(4 5 6 7 8)");
+    REQUIRE(interpreter.Run("(length (cons 4 data))") == "5");
+
+    data[0] = 50;
+    REQUIRE(interpreter.Run("(car data)") == "50");
+}
+
+TEST_CASE("Host vectors in scheme code") {
+    std::vector<IntType> data(1000);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<IntType>(i);
+    }
+    Interpreter interpreter;
+    interpreter.Define("data", MakeHostList(data));
+    interpreter.Run(
+        "(define (sum l acc) (if (null? l) acc (sum (cdr l) (+ acc (car l)))))");
+    REQUIRE(interpreter.Run("(sum data 0)") == "499500");
+    REQUIRE(interpreter.Run("(max (list-ref data 10) (list-ref data 999))") == "999");
+}
+
+TEST_CASE("Host vectors are read-only") {
+    std::vector<IntType> data = {1, 2};
+    Interpreter interpreter;
+    interpreter.Define("data", MakeHostList(data));
+    interpreter.Define("empty", MakeHostList({}));
+
+    REQUIRE_THROWS_AS(interpreter.Run("(set-car! data 5)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(list-ref data 2)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(list-tail data 3)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(length 1)"), RuntimeError);
+    REQUIRE(interpreter.Run("(null? empty)") == "#t");
+}
+
+TEST_CASE("Host vectors can own their memory") {
+    auto owned = std::make_shared<std::vector<IntType>>(std::vector<IntType>{1, 2, 3});
+    auto view = MakeHostList(*owned, owned);
+    std::weak_ptr<std::vector<IntType>> weak = owned;
+    owned.reset();
+
+    Interpreter interpreter;
+    interpreter.Define("data", std::move(view));
+    REQUIRE_FALSE(weak.expired());
+    REQUIRE(interpreter.Run("(cdr data)") == "(2 3)");
+}
@@ -0,0 +1,151 @@
+#include <catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#include <error.h>
+#include <scheme.h>
+
+namespace {
+
+class TempImage {
+public:
+    TempImage()
+        : path_((std::filesystem::temp_directory_path() / "scheme_test_image.scmi").string()) {
+    }
+
+    ~TempImage() {
+        std::filesystem::remove(path_);
+    }
+
+    const std::string& GetPath() const {
+        return path_;
+    }
+
+private:
+    std::string path_;
+};
+
+}  // namespace
+
+TEST_CASE("Image round trip") {
+    TempImage image;
+    {
+        Interpreter warm;
+        warm.Run("(define (fact n) (if (< n 2) 1 (* n (fact (- n 1)))))");
+        warm.Run("(define data '(1 (2 . 3) \"s\" sym))");
+        warm.Run("(define same data)");
+        warm.Run("(define plus +)");
+        warm.Run("(define (make-counter) (define n 0) (lambda () (set! n (+ n 1)) n))");
+        warm.Run("(define counter (make-counter))");
+        warm.Run("(counter)");
+        warm.Run("(define cycle '(1 2))");
+        warm.Run("(set-cdr! (cdr cycle) cycle)");
+        warm.SaveImage(image.GetPath());
+    }
+
+    Interpreter restored;
+    restored.LoadImage(image.GetPath());
+    REQUIRE(restored.Run("(fact 10)") == "3628800");
+    REQUIRE(restored.Run("data") == "(1 (2 . 3) \"s\" sym)");
+    REQUIRE(restored.Run("(plus 1 2)") == "3");
+
+    // Closures keep their captured frames.
+    REQUIRE(restored.Run("(counter)") == "2");
+    REQUIRE(restored.Run("(counter)") == "3");
+
+    // Sharing and cycles are preserved.
+    restored.Run("(set-car! data 5)");
+    REQUIRE(restored.Run("(car same)") == "5");
+    REQUIRE(restored.Run("(car (cdr (cdr cycle)))") == "1");
+}
+
+TEST_CASE("Image of numbers") {
+    TempImage image;
+    {
+        Interpreter warm;
+        warm.Run("(define half 0.5)");
+        warm.Run("(define big (* 10000000000 10000000000))");
+        warm.Run("(define numbers (list 1.5 -0.0 big -7))");
+        warm.SaveImage(image.GetPath());
+    }
+
+    Interpreter restored;
+    restored.LoadImage(image.GetPath());
+    REQUIRE(restored.Run("(+ half 1)") == "1.5");
+    REQUIRE(restored.Run("(+ big 1)") == "100000000000000000001");
+    REQUIRE(restored.Run("numbers") == "(1.5 -0.0 100000000000000000000 -7)");
+}
+
+TEST_CASE("Image of shadowed builtins") {
+    TempImage image;
+    {
+        Interpreter warm;
+        warm.Run("(define old-car car)");
+        warm.Run("(define (car x) 42)");
+        REQUIRE(warm.Run("(old-car '(1 2))") == "1");
+        warm.SaveImage(image.GetPath());
+    }
+
+    Interpreter restored;
+    restored.LoadImage(image.GetPath());
+    REQUIRE(restored.Run("(old-car '(1 2))") == "1");
+    REQUIRE(restored.Run("(car '(1 2))") == "42");
+}
+
+TEST_CASE("Image of host functions") {
+    TempImage image;
+    {
+        Interpreter warm;
+        warm.Register("twice", [](IntType x) { return 2 * x; });
+        warm.Run("(define (quadruple x) (twice (twice x)))");
+        warm.Run("(define alias twice)");
+        warm.SaveImage(image.GetPath());
+    }
+
+    // Host functions are looked up in the restoring interpreter.
+    Interpreter missing;
+    REQUIRE_THROWS_AS(missing.LoadImage(image.GetPath()), RuntimeError);
+
+    Interpreter restored;
+    restored.Register("twice", [](IntType x) { return 2 * x; });
+    restored.LoadImage(image.GetPath());
+    REQUIRE(restored.Run("(quadruple 3)") == "12");
+    REQUIRE(restored.Run("(alias 4)") == "8");
+}
+
+TEST_CASE("Images of restored interpreters") {
+    TempImage image;
+    InterpreterOptions options;
+    options.flat_evaluation = true;
+    options.lazy_bodies = true;
+    {
+        Interpreter warm{options};
+        warm.Run("(define (square x) (* x x))");
+        warm.Run("(define (cube x) (* x (square x)))");
+        warm.SaveImage(image.GetPath());
+    }
+    {
+        // Bodies that were never called are saved as well.
+        Interpreter restored{options};
+        restored.LoadImage(image.GetPath());
+        REQUIRE(restored.Run("(square 3)") == "9");
+        std::filesystem::remove(image.GetPath());
+        restored.SaveImage(image.GetPath());
+    }
+
+    Interpreter restored;
+    restored.LoadImage(image.GetPath());
+    REQUIRE(restored.Run("(cube 3)") == "27");
+}
+
+TEST_CASE("Corrupted image") {
+    TempImage image;
+    {
+        std::ofstream out{image.GetPath(), std::ios::binary};
+        out << "not an image";
+    }
+    Interpreter interpreter;
+    REQUIRE_THROWS_AS(interpreter.LoadImage(image.GetPath()), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.LoadImage(image.GetPath() + ".missing"), RuntimeError);
+}
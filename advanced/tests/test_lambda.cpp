@@ -144,3 +144,28 @@ TEST_CASE_METHOD(SchemeTest, "Redefinition and scoping") {
     ExpectEq("((foobar) 1 2)", "3");
     ExpectEq("(+ 1 2 -3)", "0");
 }
+
+TEST_CASE_METHOD(SchemeTest, "Free variables resolve lexically") {
+    ExpectNoError("(define (get-x) x)");
+    ExpectNoError("(define (call-with-x x) (get-x))");
+    ExpectNameError("(call-with-x 5)");
+    ExpectNoError("(define x 1)");
+    ExpectEq("(call-with-x 5)", "1");
+
+    ExpectNoError("(define (read-y) y)");
+    ExpectNoError("(define (outer) (define y 2) (read-y))");
+    ExpectNameError("(outer)");
+
+    // Nor can set! reach the caller's binding.
+    ExpectNoError("(define (set-z) (set! z 2))");
+    ExpectNoError("(define (keep-z z) (set-z) z)");
+    ExpectNameError("(keep-z 1)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "Empty list bindings") {
+    ExpectNoError("(define empty '())");
+    ExpectEq("empty", "()");
+    ExpectEq("((lambda (l) l) '())", "()");
+    ExpectNoError("(define (count l) (if (null? l) 0 (+ 1 (count (cdr l)))))");
+    ExpectEq("(count '(1 2 3))", "3");
+}
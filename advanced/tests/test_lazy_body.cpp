@@ -0,0 +1,86 @@
+#include <catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <error.h>
+#include <evaluate.h>
+#include <funcs.h>
+#include <lazy_body.h>
+#include <memory_stream.h>
+#include <scheme.h>
+
+namespace {
+
+ObjectPtr ReadLazy(const std::string& source) {
+    ReadOptions options;
+    options.lazy_bodies = true;
+    options.source = CopySourceText(source);
+    MemoryStream stream{options.source->text};
+    Tokenizer tokenizer{&stream};
+    return Read(&tokenizer, options);
+}
+
+InterpreterOptions LazyOptions() {
+    InterpreterOptions options;
+    options.lazy_bodies = true;
+    return options;
+}
+
+}  // namespace
+
+TEST_CASE("Lazy bodies are recorded as source ranges") {
+    auto form = ReadLazy("(define (f x)\n  (+ x 1)\n  (g \"(\" x))");
+    auto elements = Flatten(form);
+    REQUIRE(elements.size() == 4);
+    auto body = As<LazyBody>(elements[2]);
+    REQUIRE(body != nullptr);
+    REQUIRE(body->GetText() == "(+ x 1)\n  (g \"(\" x)");
+
+    auto forms = body->ReadForms();
+    REQUIRE(forms.size() == 2);
+    REQUIRE(Serialize(forms[1]) == "(g \"(\" x)");
+
+    REQUIRE(Is<LazyBody>(Flatten(ReadLazy("(lambda (x) x)"))[2]));
+}
+
+TEST_CASE("Data and empty bodies are read eagerly") {
+    REQUIRE(Serialize(ReadLazy("'(lambda (x) x)")) == "(quote (lambda (x) x))");
+    REQUIRE(Serialize(ReadLazy("(quote (define (f) 1))")) == "(quote (define (f) 1))");
+    REQUIRE(Serialize(ReadLazy("(define x (+ 1 2))")) == "(define x (+ 1 2))");
+    REQUIRE(Serialize(ReadLazy("(lambda (x))")) == "(lambda (x))");
+}
+
+TEST_CASE("Unbalanced lazy bodies are rejected") {
+    REQUIRE_THROWS_AS(ReadLazy("(lambda (x) (+ x 1)"), SyntaxError);
+    REQUIRE_THROWS_AS(ReadLazy("(define (f) \")\""), SyntaxError);
+}
+
+TEST_CASE("Lazy bodies are read on the first call") {
+    Interpreter interpreter{LazyOptions()};
+    interpreter.Run("(define (broken) (+ 1 2 . . 3))");
+    interpreter.Run("(define (adder n) (lambda (x) (+ x n)))");
+    REQUIRE(interpreter.Run("((adder 2) 40)") == "42");
+    REQUIRE(interpreter.Run("'(lambda (x) x)") == "(lambda (x) x)");
+
+    REQUIRE_THROWS_AS(interpreter.Run("(broken)"), SyntaxError);
+    REQUIRE_THROWS_AS(interpreter.Run("(broken)"), SyntaxError);
+}
+
+TEST_CASE("Lazy bodies of loaded files") {
+    auto path = std::filesystem::temp_directory_path() / "scheme_test_lazy.scm";
+    {
+        std::ofstream file{path};
+        file << "(define (square x) (* x x))\n(define (unused) (car))\n";
+    }
+
+    Interpreter interpreter{LazyOptions()};
+    interpreter.Run("(load \"" + path.string() + "\")");
+    REQUIRE(interpreter.Run("(square 7)") == "49");
+    interpreter.RunFile(path.string());
+    REQUIRE(interpreter.Run("(square 8)") == "64");
+
+    std::filesystem::remove(path);
+    REQUIRE(interpreter.Run("(square 9)") == "81");
+}
@@ -0,0 +1,62 @@
+#include "scheme_test.h"
+
+#include <filesystem>
+#include <fstream>
+
+class LoadTest : public SchemeTest {
+public:
+    LoadTest() : path_(std::filesystem::temp_directory_path() / "scheme_test_load.scm") {
+    }
+
+    ~LoadTest() {
+        std::filesystem::remove(path_);
+    }
+
+    std::string WriteLibrary(const std::string& source) {
+        std::ofstream file{path_};
+        file << source;
+        return path_.string();
+    }
+
+private:
+    std::filesystem::path path_;
+};
+
+TEST_CASE_METHOD(SchemeTest, "StringsAreSelfEvaluating") {
+    ExpectEq("\"abc\"", "\"abc\"");
+    ExpectEq("'(\"a\\\"b\" \"c\")", "(\"a\\\"b\" \"c\")");
+    ExpectEq("(string? \"abc\")", "#t");
+    ExpectEq("(string? 'abc)", "#f");
+}
+
+TEST_CASE_METHOD(LoadTest, "LoadDefinesInGlobalEnvironment") {
+    auto path = WriteLibrary("(define (twice x) (* 2 x))\n(define answer (twice 21))\n");
+
+    ExpectEq("(load \"" + path + "\")", "()");
+    ExpectEq("answer", "42");
+    ExpectEq("(twice 5)", "10");
+}
+
+TEST_CASE_METHOD(LoadTest, "LoadFromProcedure") {
+    auto path = WriteLibrary("(define (twice x) (* 2 x))\n(define answer (twice 21))\n");
+
+    ExpectNoError("(define (load-library) (define answer 0) (load \"" + path + "\") answer)");
+    ExpectEq("(load-library)", "0");
+    ExpectEq("answer", "42");
+    ExpectEq("(twice 5)", "10");
+    ExpectEq("((lambda () (load \"" + path + "\") (twice 4)))", "8");
+}
+
+TEST_CASE_METHOD(LoadTest, "LoadErrors") {
+    ExpectRuntimeError("(load 'lib)");
+    ExpectRuntimeError("(load \"/nonexistent/lib.scm\")");
+
+    auto path = WriteLibrary("(define x 1) (define y");
+    ExpectSyntaxError("(load \"" + path + "\")");
+    ExpectEq("x", "1");
+}
+
+TEST_CASE_METHOD(LoadTest, "LoadEmptyFile") {
+    auto path = WriteLibrary("");
+    ExpectEq("(load \"" + path + "\")", "()");
+}
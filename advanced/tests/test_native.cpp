@@ -0,0 +1,90 @@
+#include <catch.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <error.h>
+#include <scheme.h>
+
+namespace {
+
+IntType Triple(IntType x) {
+    return 3 * x;
+}
+
+}  // namespace
+
+TEST_CASE("Registered native functions") {
+    Interpreter interpreter;
+    interpreter.Register("dot", [](IntType a, IntType b, IntType c, IntType d) {
+        return a * c + b * d;
+    });
+    interpreter.Register("triple", &Triple);
+    interpreter.Register("small?", [](int x) { return x < 10; });
+    interpreter.Register("greet", [](const std::string& name) { return "hello, " + name; });
+    interpreter.Register("first-or", [](ObjectPtr list, ObjectPtr fallback) {
+        auto cell = As<Cell>(list);
+        return cell != nullptr ? cell->GetFirst() : fallback;
+    });
+
+    REQUIRE(interpreter.Run("(dot 1 2 3 4)") == "11");
+    REQUIRE(interpreter.Run("(triple (dot 1 1 1 1))") == "6");
+    REQUIRE(interpreter.Run("(small? 3)") == "#t");
+    REQUIRE(interpreter.Run("(greet \"world\")") == "\"hello, world\"");
+    REQUIRE(interpreter.Run("(first-or '(a b) 'none)") == "a");
+    REQUIRE(interpreter.Run("(first-or '() 'none)") == "none");
+}
+
+TEST_CASE("Native functions with state and no result") {
+    Interpreter interpreter;
+    IntType total = 0;
+    interpreter.Register("add!", [&total](IntType x) { total += x; });
+    interpreter.Register("flag", [](bool value) { return !value; });
+
+    REQUIRE(interpreter.Run("(add! 5)") == "()");
+    interpreter.Run("(add! 7)");
+    REQUIRE(total == 12);
+    REQUIRE(interpreter.Run("(flag '())") == "#f");
+}
+
+TEST_CASE("Native function errors") {
+    Interpreter interpreter;
+    interpreter.Register("inc", [](IntType x) { return x + 1; });
+    interpreter.Register("len", [](const std::string& s) { return s.size(); });
+
+    REQUIRE_THROWS_AS(interpreter.Run("(inc)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(inc 1 2)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(inc 'a)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(len 1)"), RuntimeError);
+    REQUIRE(interpreter.Run("(len \"abc\")") == "3");
+}
+
+TEST_CASE("Native integers are range-checked") {
+    Interpreter interpreter;
+    interpreter.Register("twice", [](int x) { return 2 * x; });
+    interpreter.Register("size", [](size_t n) { return n; });
+    interpreter.Register("byte", [](uint8_t b) { return b; });
+    interpreter.Register("max-size", [] { return SIZE_MAX; });
+
+    REQUIRE(interpreter.Run("(twice 21)") == "42");
+    REQUIRE(interpreter.Run("(twice -21)") == "-42");
+    REQUIRE_THROWS_AS(interpreter.Run("(twice 4294967297)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(twice 2147483648)"), RuntimeError);
+    REQUIRE(interpreter.Run("(size 9223372036854775807)") == "9223372036854775807");
+    REQUIRE_THROWS_AS(interpreter.Run("(size -1)"), RuntimeError);
+    REQUIRE(interpreter.Run("(byte 255)") == "255");
+    REQUIRE_THROWS_AS(interpreter.Run("(byte 256)"), RuntimeError);
+
+    REQUIRE(interpreter.Run("(max-size)") == "18446744073709551615");
+    REQUIRE(interpreter.Run("(- (max-size) 18446744073709551614)") == "1");
+}
+
+TEST_CASE("Native functions under flat evaluation") {
+    InterpreterOptions options;
+    options.flat_evaluation = true;
+    Interpreter interpreter{options};
+    interpreter.Register("square", [](IntType x) { return x * x; });
+    interpreter.Run("(define (sum-squares a b) (+ (square a) (square b)))");
+    REQUIRE(interpreter.Run("(sum-squares 3 4)") == "25");
+}
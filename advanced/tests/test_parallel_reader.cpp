@@ -0,0 +1,106 @@
+#include <catch.hpp>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <error.h>
+#include <evaluate.h>
+#include <funcs.h>
+#include <lazy_body.h>
+#include <parallel_reader.h>
+
+std::vector<std::string> ReadSequentially(const std::string& source) {
+    std::stringstream ss{source};
+    Tokenizer tokenizer{&ss};
+    std::vector<std::string> answer;
+    while (!tokenizer.IsEnd()) {
+        answer.push_back(Serialize(Read(&tokenizer)));
+    }
+    return answer;
+}
+
+std::vector<std::string> ReadInParallel(const std::string& source, size_t threads) {
+    std::vector<std::string> answer;
+    ParallelReadOptions options;
+    options.threads = threads;
+    options.min_chunk_size = 1;
+    for (const auto& form : ParallelRead(source, options)) {
+        answer.push_back(Serialize(form));
+    }
+    return answer;
+}
+
+TEST_CASE("Form boundaries") {
+    std::string source = "(a (b)) 'c \"x ) y\" (d)(e) f";
+    auto boundaries = FindFormBoundaries(source, source.size());
+
+    std::vector<std::string> chunks;
+    size_t begin = 0;
+    for (auto end : boundaries) {
+        chunks.emplace_back(source.substr(begin, end - begin));
+        begin = end;
+    }
+    chunks.emplace_back(source.substr(begin));
+
+    REQUIRE(chunks ==
+            std::vector<std::string>{"(a (b)) ", "'c ", "\"x ) y\" ", "(d)", "(e) ", "f"});
+}
+
+TEST_CASE("Parallel read keeps source order") {
+    std::string source;
+    for (int i = 0; i < 500; ++i) {
+        source += "(define (f" + std::to_string(i) + " x) (+ x " + std::to_string(i) + "))\n";
+        source += "'(\"a ( b\" . " + std::to_string(i) + ") sym" + std::to_string(i) + " ";
+    }
+
+    auto expected = ReadSequentially(source);
+    for (size_t threads : {1, 2, 3, 8, 32}) {
+        REQUIRE(ReadInParallel(source, threads) == expected);
+    }
+}
+
+TEST_CASE("Parallel read of vectors") {
+    std::string source = "(define a 1) #(1 2 3) '#(4 (5)) #()";
+    REQUIRE(ReadSequentially(source) ==
+            std::vector<std::string>{"(define a 1)", "#(1 2 3)", "(quote #(4 (5)))", "#()"});
+    for (size_t threads : {2, 4, 16}) {
+        REQUIRE(ReadInParallel(source, threads) == ReadSequentially(source));
+    }
+}
+
+TEST_CASE("Parallel read with lazy bodies") {
+    std::string source;
+    for (int i = 0; i < 8; ++i) {
+        source += "(define (f" + std::to_string(i) + " x) (+ x " + std::to_string(i) + "))\n";
+    }
+    auto text = CopySourceText(source);
+
+    ParallelReadOptions options;
+    options.threads = 4;
+    options.min_chunk_size = 1;
+    options.read.lazy_bodies = true;
+    options.read.source = text;
+    auto forms = ParallelRead(text->text, options);
+    REQUIRE(forms.size() == 8);
+
+    auto scopes = std::make_shared<ScopesCollection>(std::vector<std::shared_ptr<Scope>>{
+        std::make_shared<Scope>(std::unordered_map<std::string, ObjectPtr>{}, GetBuiltinsScope())});
+    for (const auto& form : forms) {
+        Evaluate(form, scopes);
+    }
+    for (int i = 0; i < 8; ++i) {
+        auto call = "(f" + std::to_string(i) + " 100)";
+        std::stringstream ss{call};
+        Tokenizer tokenizer{&ss};
+        REQUIRE(Serialize(Evaluate(Read(&tokenizer), scopes)) == std::to_string(100 + i));
+    }
+}
+
+TEST_CASE("Parallel read errors") {
+    std::string source = "(a) (b) (c . d e) (f) (g";
+    REQUIRE_THROWS_AS(ReadInParallel(source, 4), SyntaxError);
+    REQUIRE(ReadInParallel("", 4).empty());
+}
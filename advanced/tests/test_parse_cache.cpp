@@ -0,0 +1,97 @@
+#include <catch.hpp>
+
+#include <string>
+
+#include <error.h>
+#include <scheme.h>
+
+namespace {
+
+InterpreterOptions CacheOptions(size_t entries, size_t bytes = 16 << 20) {
+    InterpreterOptions options;
+    options.parse_cache_entries = entries;
+    options.parse_cache_bytes = bytes;
+    return options;
+}
+
+}  // namespace
+
+TEST_CASE("Parse cache hits") {
+    Interpreter interpreter{CacheOptions(4)};
+    interpreter.Run("(define x 1)");
+    REQUIRE(interpreter.Run("(+ x 1)") == "2");
+    interpreter.Run("(define x 10)");
+    REQUIRE(interpreter.Run("(+ x 1)") == "11");
+    REQUIRE(interpreter.Run("(+ x 1)") == "11");
+
+    auto stats = interpreter.GetParseCacheStats();
+    REQUIRE(stats.hits == 2);
+    REQUIRE(stats.misses == 3);
+    REQUIRE(stats.entries == 3);
+    REQUIRE(stats.bytes > 0);
+}
+
+TEST_CASE("Parse cache evicts least recently used programs") {
+    Interpreter interpreter{CacheOptions(2)};
+    interpreter.Run("1");
+    interpreter.Run("2");
+    interpreter.Run("1");
+    interpreter.Run("3");
+    REQUIRE(interpreter.GetParseCacheStats().entries == 2);
+
+    interpreter.Run("1");
+    REQUIRE(interpreter.GetParseCacheStats().hits == 2);
+    interpreter.Run("2");
+    REQUIRE(interpreter.GetParseCacheStats().hits == 2);
+}
+
+TEST_CASE("Parse cache memory cap") {
+    Interpreter interpreter{CacheOptions(100, 1024)};
+    interpreter.Run("'(1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20)");
+    REQUIRE(interpreter.GetParseCacheStats().entries == 0);
+
+    for (int i = 0; i < 50; ++i) {
+        interpreter.Run("(+ " + std::to_string(i) + " 1)");
+    }
+    auto stats = interpreter.GetParseCacheStats();
+    REQUIRE(stats.entries < 50);
+    REQUIRE(stats.bytes <= 1024);
+}
+
+TEST_CASE("Cached literals are immutable") {
+    Interpreter interpreter{CacheOptions(4)};
+    interpreter.Run("(define (f) '(1 2))");
+    REQUIRE_THROWS_AS(interpreter.Run("(set-car! (f) 5)"), RuntimeError);
+    REQUIRE(interpreter.Run("(f)") == "(1 2)");
+
+    interpreter.Run("(define l (list 1 2))");
+    interpreter.Run("(set-car! l 5)");
+    REQUIRE(interpreter.Run("l") == "(5 2)");
+}
+
+TEST_CASE("Cached vector literals are immutable") {
+    Interpreter interpreter{CacheOptions(16)};
+    std::string program =
+        "((lambda () (define v #(1 2)) (vector-set! v 0 (+ (vector-ref v 0) 1)) "
+        "(vector-ref v 0)))";
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE_THROWS_AS(interpreter.Run(program), RuntimeError);
+    }
+    REQUIRE_THROWS_AS(interpreter.Run("(vector-fill! #(1 2) 0)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(set-car! (vector-ref #((1 2)) 0) 5)"), RuntimeError);
+    REQUIRE(interpreter.Run("((lambda () (define v #(1 2)) (vector-ref v 0)))") == "1");
+
+    interpreter.Run("(define v (vector 1 2))");
+    interpreter.Run("(vector-set! v 0 5)");
+    REQUIRE(interpreter.Run("v") == "#(5 2)");
+}
+
+TEST_CASE("Parse cache with flat evaluation") {
+    auto options = CacheOptions(4);
+    options.flat_evaluation = true;
+    Interpreter interpreter{options};
+    interpreter.Run("(define (f x) (* x 2))");
+    REQUIRE(interpreter.Run("(f 2)") == "4");
+    REQUIRE(interpreter.Run("(f 2)") == "4");
+    REQUIRE(interpreter.GetParseCacheStats().hits == 1);
+}
@@ -154,3 +154,42 @@ TEST_CASE("Invalid") {
     REQUIRE_THROWS_AS(ReadFull("(1 . )"), SyntaxError);
     REQUIRE_THROWS_AS(ReadFull("(1 . 2 3)"), SyntaxError);
 }
+
+TEST_CASE("Deep nesting") {
+    constexpr size_t kDepth = 100000;
+
+    SECTION("Nested lists") {
+        auto node = ReadFull(std::string(kDepth, '(') + "1" + std::string(kDepth, ')'));
+        size_t depth = 0;
+        while (Is<Cell>(node) && !As<Cell>(node)->GetSecond()) {
+            node = As<Cell>(node)->GetFirst();
+            ++depth;
+        }
+        REQUIRE(depth == kDepth);
+        REQUIRE(Is<Number>(node));
+    }
+
+    SECTION("Nested quotes") {
+        auto node = ReadFull(std::string(kDepth, '\'') + "x");
+        size_t depth = 0;
+        while (Is<Cell>(node)) {
+            node = As<Cell>(As<Cell>(node)->GetSecond())->GetFirst();
+            ++depth;
+        }
+        REQUIRE(depth == kDepth);
+        REQUIRE(Is<Symbol>(node));
+    }
+
+    SECTION("Depth limit") {
+        ReadOptions options;
+        options.max_depth = 3;
+
+        std::stringstream ss{"((((1))))"};
+        Tokenizer tokenizer{&ss};
+        REQUIRE_THROWS_AS(Read(&tokenizer, options), SyntaxError);
+
+        std::stringstream ok{"(((1)))"};
+        Tokenizer ok_tokenizer{&ok};
+        REQUIRE(Is<Cell>(Read(&ok_tokenizer, options)));
+    }
+}
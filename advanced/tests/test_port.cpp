@@ -0,0 +1,114 @@
+#include <catch.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <error.h>
+#include <scheme.h>
+
+TEST_CASE("Display and write") {
+    Interpreter interpreter;
+    std::ostringstream out;
+    interpreter.SetOutput(&out);
+
+    interpreter.Run("(display \"text\")");
+    interpreter.Run("(write \"text\")");
+    interpreter.Run("(newline)");
+    interpreter.Run("(display '(1 \"a\" b))");
+    // Nothing reaches the stream before a flush.
+    REQUIRE(out.str().empty());
+    interpreter.FlushOutput();
+    REQUIRE(out.str() == "text\"text\"\n(1 \"a\" b)");
+
+    interpreter.Run("(write 42 (current-output-port))");
+    interpreter.Run("(flush-output-port)");
+    REQUIRE(out.str() == "text\"text\"\n(1 \"a\" b)42");
+
+    REQUIRE_THROWS_AS(interpreter.Run("(display)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(display 1 2)"), RuntimeError);
+}
+
+TEST_CASE("Output is flushed in large chunks") {
+    Interpreter interpreter;
+    std::ostringstream out;
+    interpreter.SetOutput(&out);
+
+    interpreter.Run("(define (display-line i) (display i) (newline))");
+    std::string expected;
+    for (int i = 0; i < 20000; ++i) {
+        interpreter.Run("(display-line " + std::to_string(i) + ")");
+        expected += std::to_string(i) + '\n';
+    }
+    // Written in whole buffers while running; the rest stays buffered.
+    auto written = out.str().size();
+    REQUIRE(written >= (64 << 10));
+    REQUIRE(written < expected.size());
+
+    interpreter.FlushOutput();
+    REQUIRE(out.str() == expected);
+}
+
+TEST_CASE("String ports") {
+    Interpreter interpreter;
+    interpreter.Run("(define out (open-output-string))");
+    interpreter.Run("(display \"a\" out)");
+    interpreter.Run("(write '(b \"c\") out)");
+    REQUIRE(interpreter.Run("(get-output-string out)") == "\"a(b \\\"c\\\")\"");
+    REQUIRE(interpreter.Run("(output-port? out)") == "#t");
+    REQUIRE(interpreter.Run("(input-port? out)") == "#f");
+
+    interpreter.Run("(define in (open-input-string \"ab\ncd\n(1 (2 x) \\\"s\\\") 7\"))");
+    REQUIRE(interpreter.Run("(peek-char in)") == "\"a\"");
+    REQUIRE(interpreter.Run("(read-char in)") == "\"a\"");
+    REQUIRE(interpreter.Run("(read-line in)") == "\"b\"");
+    REQUIRE(interpreter.Run("(read-line in)") == "\"cd\"");
+    REQUIRE(interpreter.Run("(read in)") == "(1 (2 x) \"s\")");
+    REQUIRE(interpreter.Run("(read in)") == "7");
+    REQUIRE(interpreter.Run("(eof-object? (read in))") == "#t");
+    REQUIRE(interpreter.Run("(eof-object? (read-char in))") == "#t");
+    REQUIRE(interpreter.Run("(eof-object? (read-line in))") == "#t");
+
+    interpreter.Run("(close-port in)");
+    REQUIRE_THROWS_AS(interpreter.Run("(read in)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(read out)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(get-output-string (current-output-port))"),
+                      RuntimeError);
+}
+
+TEST_CASE("Default input port") {
+    Interpreter interpreter;
+    std::istringstream in{"first line\n(+ 1 2)"};
+    interpreter.SetInput(&in);
+    REQUIRE(interpreter.Run("(read-line)") == "\"first line\"");
+    REQUIRE(interpreter.Run("(read)") == "(+ 1 2)");
+    REQUIRE(interpreter.Run("(eof-object? (read))") == "#t");
+}
+
+TEST_CASE("File ports") {
+    auto path = (std::filesystem::temp_directory_path() / "scheme_test_port.txt").string();
+    Interpreter interpreter;
+    interpreter.Define("path", MakeNode<String>(path));
+
+    interpreter.Run("(define out (open-output-file path))");
+    interpreter.Run("(display \"hello\" out)");
+    interpreter.Run("(newline out)");
+    interpreter.Run("(write '(1 2) out)");
+    interpreter.Run("(close-output-port out)");
+    REQUIRE_THROWS_AS(interpreter.Run("(display 1 out)"), RuntimeError);
+
+    std::ifstream file{path};
+    std::stringstream contents;
+    contents << file.rdbuf();
+    REQUIRE(contents.str() == "hello\n(1 2)");
+
+    interpreter.Run("(define in (open-input-file path))");
+    REQUIRE(interpreter.Run("(read-line in)") == "\"hello\"");
+    REQUIRE(interpreter.Run("(read in)") == "(1 2)");
+    interpreter.Run("(close-input-port in)");
+
+    std::remove(path.c_str());
+    REQUIRE_THROWS_AS(interpreter.Run("(open-input-file path)"), RuntimeError);
+}
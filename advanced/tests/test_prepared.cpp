@@ -0,0 +1,48 @@
+#include <catch.hpp>
+
+#include <error.h>
+#include <scheme.h>
+
+TEST_CASE("Prepared programs bind parameters") {
+    Interpreter interpreter;
+    auto program = interpreter.Prepare("(+ x (* y 2))", {"x", "y"});
+    REQUIRE(program.Execute({1, 2}) == "5");
+    REQUIRE(program.Execute({10, -3}) == "4");
+    REQUIRE(program.Execute({MakeNode<Number>(7), MakeNode<Number>(0)}) == "7");
+}
+
+TEST_CASE("Prepared programs see the interpreter environment") {
+    Interpreter interpreter;
+    interpreter.Run("(define (limit) 100)");
+    auto rule = interpreter.Prepare("(if (> amount (limit)) 'reject 'accept)", {"amount"});
+    REQUIRE(rule.Execute({50}) == "accept");
+    REQUIRE(rule.Execute({150}) == "reject");
+
+    interpreter.Run("(define (limit) 10)");
+    REQUIRE(rule.Execute({50}) == "reject");
+
+    auto constant = interpreter.Prepare("'(1 2)", {});
+    REQUIRE(constant.Execute({}) == "(1 2)");
+}
+
+TEST_CASE("Prepared program errors") {
+    Interpreter interpreter;
+    REQUIRE_THROWS_AS(interpreter.Prepare("(+ x", {"x"}), SyntaxError);
+
+    auto program = interpreter.Prepare("(+ x y)", {"x", "y"});
+    REQUIRE_THROWS_AS(program.Execute({1}), RuntimeError);
+    REQUIRE_THROWS_AS(program.Execute({MakeNode<Symbol>("a"), MakeNode<Number>(1)}),
+                      RuntimeError);
+
+    auto unknown = interpreter.Prepare("(+ x z)", {"x"});
+    REQUIRE_THROWS_AS(unknown.Execute({1}), NameError);
+}
+
+TEST_CASE("Prepared programs evaluate flat") {
+    InterpreterOptions options;
+    options.flat_evaluation = true;
+    Interpreter interpreter{options};
+    auto program = interpreter.Prepare("(and (< lo x) (< x hi))", {"x", "lo", "hi"});
+    REQUIRE(program.Execute({5, 0, 10}) == "#t");
+    REQUIRE(program.Execute({50, 0, 10}) == "#f");
+}
@@ -0,0 +1,108 @@
+#include <catch.hpp>
+
+#include <string>
+
+#include <error.h>
+#include <scheme.h>
+
+TEST_CASE("Promises are forced once") {
+    Interpreter interpreter;
+    interpreter.Run("(define count 0)");
+    interpreter.Run("(define p (delay ((lambda () (set! count (+ count 1)) (* 6 7)))))");
+    REQUIRE(interpreter.Run("(promise? p)") == "#t");
+    REQUIRE(interpreter.Run("count") == "0");
+    REQUIRE(interpreter.Run("(force p)") == "42");
+    REQUIRE(interpreter.Run("(force p)") == "42");
+    REQUIRE(interpreter.Run("count") == "1");
+
+    REQUIRE(interpreter.Run("(force (make-promise '(1 2)))") == "(1 2)");
+    REQUIRE(interpreter.Run("(promise? (make-promise 1))") == "#t");
+    REQUIRE(interpreter.Run("(force 5)") == "5");
+    REQUIRE(interpreter.Run("(promise? 5)") == "#f");
+
+    // The body sees the scope it was delayed in.
+    interpreter.Run("(define (make x) (delay (+ x 1)))");
+    REQUIRE(interpreter.Run("(force (make 9))") == "10");
+
+    REQUIRE_THROWS_AS(interpreter.Run("(force (delay (car '())))"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(delay)"), SyntaxError);
+    REQUIRE_THROWS_AS(interpreter.Run("(force (delay-force 1))"), RuntimeError);
+}
+
+TEST_CASE("Delay-force runs in constant stack") {
+    Interpreter interpreter;
+    interpreter.Run(
+        "(define (loop n) (if (= n 0) (delay 'done) (delay-force (loop (- n 1)))))");
+    REQUIRE(interpreter.Run("(force (loop 300000))") == "done");
+
+    // R7RS: forcing the outer promise remembers the value of the inner one too.
+    interpreter.Run("(define count 0)");
+    interpreter.Run("(define inner (delay ((lambda () (set! count (+ count 1)) count))))");
+    interpreter.Run("(define outer (delay-force inner))");
+    REQUIRE(interpreter.Run("(force outer)") == "1");
+    REQUIRE(interpreter.Run("(force inner)") == "1");
+    REQUIRE(interpreter.Run("count") == "1");
+}
+
+TEST_CASE("Streams") {
+    Interpreter interpreter;
+    interpreter.Run("(define (integers n) (cons-stream n (integers (+ n 1))))");
+    interpreter.Run("(define s (integers 0))");
+    REQUIRE(interpreter.Run("(stream-car s)") == "0");
+    REQUIRE(interpreter.Run("(stream-car (stream-cdr (stream-cdr s)))") == "2");
+    REQUIRE(interpreter.Run("(stream-pair? s)") == "#t");
+    REQUIRE(interpreter.Run("(stream-pair? '(1 2))") == "#f");
+    REQUIRE(interpreter.Run("(stream-null? '())") == "#t");
+
+    REQUIRE(interpreter.Run("(stream->list 5 s)") == "(0 1 2 3 4)");
+    REQUIRE(interpreter.Run("(stream-ref s 10)") == "10");
+    REQUIRE(interpreter.Run("(stream->list (stream-take 3 (integers 7)))") == "(7 8 9)");
+    REQUIRE(interpreter.Run("(stream->list (stream-take 0 s))") == "()");
+    REQUIRE(interpreter.Run("(stream->list 4 (stream-map (lambda (x) (* x x)) s))") ==
+            "(0 1 4 9)");
+    interpreter.Run("(define (even? x) (= (* 2 (/ x 2)) x))");
+    REQUIRE(interpreter.Run("(stream->list 4 (stream-filter even? s))") == "(0 2 4 6)");
+
+    interpreter.Run("(define out (open-output-string))");
+    interpreter.Run("(stream-for-each (lambda (x) (display x out)) (stream-take 4 s))");
+    REQUIRE(interpreter.Run("(get-output-string out)") == "\"0123\"");
+
+    // Finite streams end with ().
+    interpreter.Run(
+        "(define (count-down n) (if (= n 0) '() (cons-stream n (count-down (- n 1)))))");
+    REQUIRE(interpreter.Run("(stream->list (count-down 3))") == "(3 2 1)");
+    REQUIRE(interpreter.Run("(stream->list (stream-filter even? (count-down 3)))") == "(2)");
+    REQUIRE_THROWS_AS(interpreter.Run("(stream-ref (count-down 3) 3)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(stream-car '())"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(stream-take -1 s)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(stream-map 1 s)"), RuntimeError);
+}
+
+TEST_CASE("Stream elements are computed once and only when needed") {
+    Interpreter interpreter;
+    interpreter.Run("(define count 0)");
+    interpreter.Run(
+        "(define (integers n) (cons-stream n ((lambda () (set! count (+ count 1)) "
+        "(integers (+ n 1))))))");
+    interpreter.Run("(define s (integers 0))");
+    interpreter.Run("(stream-ref s 5)");
+    interpreter.Run("(stream-ref s 5)");
+    REQUIRE(interpreter.Run("count") == "5");
+    interpreter.Run("(stream->list 3 (stream-take 3 (integers 0)))");
+    REQUIRE(interpreter.Run("count") == "7");
+}
+
+TEST_CASE("Stream pipelines run iteratively") {
+    Interpreter interpreter;
+    interpreter.Run("(define (integers n) (cons-stream n (integers (+ n 1))))");
+    interpreter.Run("(define (multiple-of-1000? x) (= (* 1000 (/ x 1000)) x))");
+    REQUIRE(interpreter.Run("(stream-ref (stream-map (lambda (x) (* 2 x)) "
+                            "(stream-filter multiple-of-1000? (integers 1))) 500)") ==
+            "1002000");
+    REQUIRE(interpreter.Run("(stream-ref (integers 0) 300000)") == "300000");
+
+    // A long forced stream that is kept is released without deep recursion.
+    interpreter.Run("(define kept (integers 0))");
+    REQUIRE(interpreter.Run("(stream-ref kept 300000)") == "300000");
+    interpreter.Run("(define kept '())");
+}
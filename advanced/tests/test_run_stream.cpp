@@ -0,0 +1,52 @@
+#include <catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <error.h>
+#include <scheme.h>
+
+TEST_CASE("RunStream evaluates every form") {
+    Interpreter interpreter;
+    std::stringstream program{"(define x 1)\n(define (f y)\n  (+ x y))\n(f 41)"};
+
+    std::vector<std::string> results;
+    auto last = interpreter.RunStream(
+        program, [&results](const std::string& result) { results.push_back(result); });
+
+    REQUIRE(last == "42");
+    REQUIRE(results == std::vector<std::string>{"()", "()", "42"});
+    REQUIRE(interpreter.Run("(f 1)") == "2");
+}
+
+TEST_CASE("RunStream keeps forms evaluated before an error") {
+    Interpreter interpreter;
+    std::stringstream program{"(define x 5) (+ x 1) (1 . 2 3)"};
+
+    REQUIRE_THROWS_AS(interpreter.RunStream(program), SyntaxError);
+    REQUIRE(interpreter.Run("x") == "5");
+}
+
+TEST_CASE("RunStream on empty input") {
+    Interpreter interpreter;
+    std::stringstream program{"  \n "};
+
+    REQUIRE(interpreter.RunStream(program) == "()");
+}
+
+TEST_CASE("RunFile") {
+    auto path = std::filesystem::temp_directory_path() / "scheme_test_run_file.scm";
+    {
+        std::ofstream file{path};
+        file << "(define (square x) (* x x))\n(square 12)\n";
+    }
+
+    Interpreter interpreter;
+    REQUIRE(interpreter.RunFile(path.string()) == "144");
+    std::filesystem::remove(path);
+
+    REQUIRE_THROWS_AS(interpreter.RunFile(path.string()), RuntimeError);
+}
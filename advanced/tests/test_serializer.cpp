@@ -0,0 +1,92 @@
+#include <catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <error.h>
+#include <host_vector.h>
+#include <scheme.h>
+#include <serializer.h>
+
+namespace {
+
+std::string SerializeToString(const ObjectPtr& object) {
+    std::string out;
+    SerializeTo(object, &out);
+    return out;
+}
+
+}  // namespace
+
+TEST_CASE("Serializer output") {
+    Interpreter interpreter;
+    REQUIRE(interpreter.Run("'(1 (2 . 3) \"s\" () (a (b)))") == "(1 (2 . 3) \"s\" () (a (b)))");
+    REQUIRE(interpreter.Run("'(1 2 . 3)") == "(1 2 . 3)");
+    REQUIRE(interpreter.Run("'()") == "()");
+
+    // Shared pairs that don't form a cycle are written in full.
+    interpreter.Run("(define x '(1 2))");
+    REQUIRE(interpreter.Run("(list x x)") == "((1 2) (1 2))");
+
+    std::vector<IntType> elements = {2, 3};
+    auto tail = MakeHostList(elements);
+    auto cell = MakeNode<Cell>();
+    cell->SetFirst(MakeNode<Number>(1));
+    cell->SetSecond(tail);
+    REQUIRE(SerializeToString(cell) == "(1 2 3)");
+}
+
+TEST_CASE("Serializer labels cycles") {
+    Interpreter interpreter;
+    interpreter.Run("(define x '(1 2 3))");
+    interpreter.Run("(set-cdr! (cdr (cdr x)) x)");
+    REQUIRE(interpreter.Run("x") == "#0=(1 2 3 . #0#)");
+    REQUIRE(interpreter.Run("(cdr x)") == "#0=(2 3 1 . #0#)");
+
+    interpreter.Run("(define y '(1 2))");
+    interpreter.Run("(set-cdr! (cdr y) (cdr y))");
+    REQUIRE(interpreter.Run("y") == "(1 . #0=(2 . #0#))");
+
+    interpreter.Run("(define z '(1))");
+    interpreter.Run("(set-car! z z)");
+    // Once labelled, a pair is referred to by its label.
+    REQUIRE(interpreter.Run("(list z z)") == "(#0=(#0#) #0#)");
+}
+
+TEST_CASE("Serializer handles deep nesting") {
+    constexpr size_t kDepth = 1000000;
+    ObjectPtr nested;
+    for (size_t i = 0; i < kDepth; ++i) {
+        auto cell = MakeNode<Cell>();
+        cell->SetFirst(std::move(nested));
+        nested = std::move(cell);
+    }
+
+    auto text = SerializeToString(nested);
+    REQUIRE(text.size() == 2 * kDepth + 2);
+    REQUIRE(text.substr(0, 4) == "((((");
+    REQUIRE(text.substr(text.size() - 4) == "))))");
+}
+
+TEST_CASE("Serializer streams") {
+    // Large enough to be flushed in several chunks.
+    ObjectPtr list;
+    for (IntType i = 100000; i > 0; --i) {
+        auto cell = MakeNode<Cell>();
+        cell->SetFirst(MakeNode<Number>(i));
+        cell->SetSecond(std::move(list));
+        list = std::move(cell);
+    }
+
+    std::stringstream out;
+    SerializeTo(list, &out);
+    REQUIRE(out.str() == SerializeToString(list));
+    REQUIRE(out.str().substr(0, 8) == "(1 2 3 4");
+
+    // Run reuses the buffer it is given.
+    Interpreter interpreter;
+    std::string output = "stale";
+    interpreter.Run("(+ 1 2)", &output);
+    REQUIRE(output == "3");
+}
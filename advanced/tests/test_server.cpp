@@ -0,0 +1,152 @@
+#include <catch.hpp>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <error.h>
+#include <scheme.h>
+#include <server.h>
+
+namespace {
+
+// Runs a server on a thread for the lifetime of the object.
+class TestServer {
+public:
+    explicit TestServer(Interpreter* base, const ServerOptions& options = {})
+        : path_((std::filesystem::temp_directory_path() /
+                 ("scheme_test_server_" + std::to_string(getpid()) + ".sock"))
+                    .string()),
+          server_(path_, base, options),
+          thread_([this] { server_.Run(); }) {
+    }
+
+    ~TestServer() {
+        server_.Stop();
+        thread_.join();
+    }
+
+    const std::string& GetPath() const {
+        return path_;
+    }
+
+private:
+    std::string path_;
+    EvalServer server_;
+    std::thread thread_;
+};
+
+}  // namespace
+
+TEST_CASE("Server evaluates requests") {
+    Interpreter base;
+    TestServer server{&base};
+    EvalClient client{server.GetPath()};
+
+    auto response = client.Run("(+ 1 2)");
+    REQUIRE(response.error == RunError::NONE);
+    REQUIRE(response.output == "3");
+    REQUIRE(response.printed.empty());
+
+    response = client.Run("(display \"hi\")");
+    REQUIRE(response.printed == "hi");
+    REQUIRE(response.output == "()");
+
+    response = client.Run("(car '())");
+    REQUIRE(response.error == RunError::RUNTIME);
+    response = client.Run("undefined-name");
+    REQUIRE(response.error == RunError::NAME);
+    response = client.Run("(+ 1");
+    REQUIRE(response.error == RunError::SYNTAX);
+
+    // Pipelined requests are answered in order.
+    for (int i = 0; i < 100; ++i) {
+        client.Send("(* " + std::to_string(i) + " 2)");
+    }
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(client.Receive().output == std::to_string(i * 2));
+    }
+}
+
+TEST_CASE("Server sessions are isolated forks") {
+    Interpreter base;
+    base.Run("(define shared 10)");
+    base.Run("(define lst '(1 2))");
+    TestServer server{&base};
+
+    EvalClient first{server.GetPath()};
+    EvalClient second{server.GetPath()};
+    REQUIRE(first.Run("shared").output == "10");
+    first.Run("(define own 1)");
+    first.Run("(set! shared 11)");
+    first.Run("(set-car! lst 5)");
+
+    REQUIRE(first.Run("(list shared own lst)").output == "(11 1 (5 2))");
+    REQUIRE(second.Run("(list shared lst)").output == "(10 (1 2))");
+    REQUIRE(second.Run("own").error == RunError::NAME);
+}
+
+TEST_CASE("Server sessions rebind builtins privately") {
+    Interpreter base;
+    TestServer server{&base};
+
+    EvalClient first{server.GetPath()};
+    EvalClient second{server.GetPath()};
+    first.Run("(set! car cdr)");
+    REQUIRE(first.Run("(car '(1 2))").output == "(2)");
+    REQUIRE(second.Run("(car '(1 2))").output == "1");
+    REQUIRE(base.Run("(car '(1 2))") == "1");
+
+    Interpreter other;
+    REQUIRE(other.Run("(car '(1 2))") == "1");
+}
+
+TEST_CASE("Server handles many clients") {
+    Interpreter base;
+    base.Run("(define (square x) (* x x))");
+    TestServer server{&base};
+
+    constexpr int kClients = 8;
+    constexpr int kRequests = 200;
+    std::vector<std::thread> threads;
+    std::vector<int> correct(kClients);
+    for (int i = 0; i < kClients; ++i) {
+        threads.emplace_back([&, i] {
+            EvalClient client{server.GetPath()};
+            for (int j = 0; j < kRequests; ++j) {
+                auto response = client.Run("(square " + std::to_string(i + j) + ")");
+                correct[i] += response.output == std::to_string((i + j) * (i + j));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < kClients; ++i) {
+        REQUIRE(correct[i] == kRequests);
+    }
+}
+
+TEST_CASE("Server closes sessions sending oversized requests") {
+    Interpreter base;
+    TestServer server{&base, {.max_message_size = 16}};
+
+    EvalClient client{server.GetPath()};
+    REQUIRE(client.Run("(+ 1 2)").output == "3");
+    REQUIRE_THROWS_AS(client.Run("(list 1 2 3 4 5 6 7 8 9)"), RuntimeError);
+
+    EvalClient other{server.GetPath()};
+    REQUIRE(other.Run("(+ 2 2)").output == "4");
+}
+
+TEST_CASE("Server reports listen errors") {
+    Interpreter base;
+    REQUIRE_THROWS_AS(EvalServer("/nonexistent/scheme.sock", &base), RuntimeError);
+}
+
+TEST_CASE("Server client reports connection errors") {
+    REQUIRE_THROWS_AS(EvalClient{"/nonexistent/scheme.sock"}, RuntimeError);
+}
@@ -153,3 +153,23 @@ TEST_CASE("Empty string handled correctly") {
 
     REQUIRE(tokenizer.IsEnd());
 }
+
+TEST_CASE("String literals") {
+    std::stringstream ss{R"("lib.scm" "a \"b\"\n" "")"};
+    Tokenizer tokenizer{&ss};
+
+    REQUIRE(tokenizer.GetToken() == Token{StringToken{"lib.scm"}});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{StringToken{"a \"b\"\n"}});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{StringToken{""}});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.IsEnd());
+
+    std::stringstream unterminated{R"("abc)"};
+    Tokenizer bad_tokenizer{&unterminated};
+    REQUIRE_THROWS_AS(bad_tokenizer.GetToken(), SyntaxError);
+}
@@ -0,0 +1,147 @@
+#include <catch.hpp>
+
+#include <sstream>
+#include <string>
+
+#include <error.h>
+#include <scheme.h>
+#include <serializer.h>
+#include <tokenizer.h>
+#include <vector.h>
+
+TEST_CASE("Vector literals") {
+    std::stringstream ss{"#(1) #a"};
+    Tokenizer tokenizer{&ss};
+    REQUIRE(tokenizer.GetToken() == Token{VectorOpenToken{}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{1}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{BracketToken::CLOSE});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{SymbolToken{"#a"}});
+
+    Interpreter interpreter;
+    REQUIRE(interpreter.Run("#(1 2 3)") == "#(1 2 3)");
+    REQUIRE(interpreter.Run("#()") == "#()");
+    REQUIRE(interpreter.Run("'#(a (b c) #(1.5) \"s\" ())") == "#(a (b c) #(1.5) \"s\" ())");
+    REQUIRE(interpreter.Run("'(1 #(2) . #(3))") == "(1 #(2) . #(3))");
+    REQUIRE(interpreter.Run("(vector? #(1))") == "#t");
+    REQUIRE(interpreter.Run("(vector? '(1))") == "#f");
+    REQUIRE_THROWS_AS(interpreter.Run("#(1 2"), SyntaxError);
+    REQUIRE_THROWS_AS(interpreter.Run("#(1 . 2)"), SyntaxError);
+}
+
+TEST_CASE("Vector functions") {
+    Interpreter interpreter;
+    interpreter.Run("(define v (make-vector 3 'x))");
+    REQUIRE(interpreter.Run("v") == "#(x x x)");
+    REQUIRE(interpreter.Run("(make-vector 2)") == "#(0 0)");
+    REQUIRE(interpreter.Run("(vector-length v)") == "3");
+    interpreter.Run("(vector-set! v 1 '(a b))");
+    REQUIRE(interpreter.Run("(vector-ref v 1)") == "(a b)");
+    REQUIRE(interpreter.Run("v") == "#(x (a b) x)");
+    REQUIRE_THROWS_AS(interpreter.Run("(vector-ref v 3)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(vector-ref v -1)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(vector-set! '(1) 0 1)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(make-vector -1)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(make-vector 9223372036854775807)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(make-vector 1125899906842624)"), RuntimeError);
+
+    interpreter.Run("(vector-fill! v 0)");
+    REQUIRE(interpreter.Run("v") == "#(0 0 0)");
+    interpreter.Run("(vector-fill! v 7 1)");
+    REQUIRE(interpreter.Run("v") == "#(0 7 7)");
+    interpreter.Run("(vector-fill! v 5 0 1)");
+    REQUIRE(interpreter.Run("v") == "#(5 7 7)");
+    REQUIRE_THROWS_AS(interpreter.Run("(vector-fill! v 5 2 1)"), RuntimeError);
+
+    REQUIRE(interpreter.Run("(vector 1 (+ 1 1) 'c)") == "#(1 2 c)");
+    REQUIRE(interpreter.Run("(list->vector '(1 2 3))") == "#(1 2 3)");
+    REQUIRE(interpreter.Run("(list->vector '())") == "#()");
+    REQUIRE_THROWS_AS(interpreter.Run("(list->vector '(1 . 2))"), RuntimeError);
+    REQUIRE(interpreter.Run("(vector->list #(1 2 3))") == "(1 2 3)");
+    REQUIRE(interpreter.Run("(vector->list #(1 2 3) 1)") == "(2 3)");
+    REQUIRE(interpreter.Run("(vector->list #(1 2 3) 1 2)") == "(2)");
+    REQUIRE(interpreter.Run("(vector->list #())") == "()");
+
+    interpreter.Run("(vector-set! v 0 v)");
+    REQUIRE_THROWS_AS(interpreter.Run("v"), RuntimeError);
+}
+
+TEST_CASE("Vectors handle deep nesting") {
+    constexpr size_t kDepth = 200000;
+    ObjectPtr nested;
+    for (size_t i = 0; i < kDepth; ++i) {
+        if (i % 2 == 0) {
+            nested = MakeNode<Vector>(std::vector<ObjectPtr>{std::move(nested)});
+        } else {
+            auto cell = MakeNode<Cell>();
+            cell->SetFirst(std::move(nested));
+            nested = std::move(cell);
+        }
+    }
+
+    std::string text;
+    SerializeTo(nested, &text);
+    REQUIRE(text.size() == 5 * kDepth / 2 + 2);
+    REQUIRE(text.substr(0, 6) == "(#((#(");
+    nested = nullptr;
+
+    Interpreter interpreter;
+    interpreter.Run("(define v #())");
+    for (size_t i = 0; i < kDepth; ++i) {
+        interpreter.Run("(set! v (vector v))");
+    }
+    interpreter.Run("(set! v 0)");
+}
+
+TEST_CASE("Cycles inside vectors") {
+    Interpreter interpreter;
+    interpreter.Run("(define l (list 1 2))");
+    interpreter.Run("(set-cdr! (cdr l) l)");
+    REQUIRE(interpreter.Run("(vector l 3)") == "#(#0=(1 2 . #0#) 3)");
+
+    interpreter.Run("(define v (vector 1))");
+    interpreter.Run("(define m (list v))");
+    interpreter.Run("(vector-set! v 0 m)");
+    REQUIRE_THROWS_AS(interpreter.Run("v"), RuntimeError);
+}
+
+TEST_CASE("Indexed loops over vectors") {
+    Interpreter interpreter;
+    interpreter.Run("(define n 2000)");
+    interpreter.Run("(define v (make-vector n))");
+    interpreter.Run(
+        "(define (fill i) (if (< i n) ((lambda () (vector-set! v i i) (fill (+ i 1))))))");
+    interpreter.Run("(fill 0)");
+    interpreter.Run(
+        "(define (sum i acc) (if (= i n) acc (sum (+ i 1) (+ acc (vector-ref v i)))))");
+    REQUIRE(interpreter.Run("(sum 0 0)") == "1999000");
+}
+
+TEST_CASE("List-ref walks the list") {
+    Interpreter interpreter;
+    REQUIRE(interpreter.Run("(list-ref '(1 2 . 3) 1)") == "2");
+    REQUIRE_THROWS_AS(interpreter.Run("(list-ref '(1 2 . 3) 2)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(list-ref '(1 2) -1)"), RuntimeError);
+    REQUIRE(interpreter.Run("(list-tail '(1 2 . 3) 2)") == "3");
+
+    // list-tail shares the tail.
+    interpreter.Run("(define l (list 1 2 3))");
+    interpreter.Run("(set-car! (list-tail l 1) 'x)");
+    REQUIRE(interpreter.Run("l") == "(1 x 3)");
+}
+
+TEST_CASE("Forks copy vectors on write") {
+    Interpreter parent;
+    parent.Run("(define v (vector 1 2 3))");
+
+    auto child = parent.Fork();
+    child.Run("(vector-set! v 0 'c)");
+    REQUIRE(child.Run("v") == "#(c 2 3)");
+    REQUIRE(parent.Run("v") == "#(1 2 3)");
+
+    parent.Run("(vector-fill! v 'p)");
+    REQUIRE(parent.Run("v") == "#(p p p)");
+    REQUIRE(child.Run("(vector-ref v 1)") == "2");
+}
@@ -0,0 +1,137 @@
+#include <catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <error.h>
+#include <host_vector.h>
+#include <scheme.h>
+#include <serializer.h>
+#include <wire.h>
+
+namespace {
+
+std::string SerializeToString(const ObjectPtr& object) {
+    std::string out;
+    SerializeTo(object, &out);
+    return out;
+}
+
+std::string RoundTrip(Interpreter* interpreter, const std::string& program,
+                      const WireOptions& options = {}) {
+    std::string message;
+    interpreter->RunEncoded(program, &message, options);
+    return SerializeToString(Decode(message));
+}
+
+}  // namespace
+
+TEST_CASE("Wire round trip") {
+    Interpreter interpreter;
+    REQUIRE(RoundTrip(&interpreter, "'(1 -2 (a . b) \"s\" () (a (b)))") ==
+            "(1 -2 (a . b) \"s\" () (a (b)))");
+    REQUIRE(RoundTrip(&interpreter, "'(1 2 . 3)") == "(1 2 . 3)");
+    REQUIRE(RoundTrip(&interpreter, "'()") == "()");
+    REQUIRE(RoundTrip(&interpreter, "(= 1 1)") == "#t");
+    REQUIRE(RoundTrip(&interpreter, "(= 1 2)") == "#f");
+    REQUIRE(RoundTrip(&interpreter, "(* -1000000 1000000 1000000)") ==
+            "-1000000000000000000");
+
+    std::vector<IntType> elements = {2, 3};
+    auto cell = MakeNode<Cell>();
+    cell->SetFirst(MakeNode<Number>(1));
+    cell->SetSecond(MakeHostList(elements));
+    std::string message;
+    Encode(cell, &message);
+    REQUIRE(SerializeToString(Decode(message)) == "(1 2 3)");
+}
+
+TEST_CASE("Wire format is compact") {
+    Interpreter interpreter;
+    std::string message;
+    interpreter.RunEncoded("'(1 2 3)", &message);
+    // Version, LIST, count and three one-byte numbers.
+    REQUIRE(message.size() == 9);
+
+    // Repeated symbols are sent once.
+    interpreter.RunEncoded("'(symbol symbol symbol)", &message);
+    REQUIRE(message.size() == 3 + 2 + 6 + 2 * 2);
+    auto decoded = Decode(message);
+    auto first = As<Cell>(decoded)->GetFirst();
+    REQUIRE(As<Cell>(As<Cell>(decoded)->GetSecond())->GetFirst() == first);
+}
+
+TEST_CASE("Wire keeps cycles and sharing") {
+    Interpreter interpreter;
+    interpreter.Run("(define x '(1 2 3))");
+    interpreter.Run("(set-cdr! (cdr (cdr x)) x)");
+    REQUIRE(RoundTrip(&interpreter, "x") == "#0=(1 2 3 . #0#)");
+
+    interpreter.Run("(define z '(1))");
+    interpreter.Run("(set-car! z z)");
+    REQUIRE(RoundTrip(&interpreter, "(list z z)") == "(#0=(#0#) #0#)");
+
+    std::string message;
+    interpreter.Run("(define y '(1 2))");
+    interpreter.RunEncoded("(list y y)", &message);
+    auto copied = As<Cell>(Decode(message));
+    REQUIRE(copied->GetFirst() != As<Cell>(copied->GetSecond())->GetFirst());
+
+    interpreter.RunEncoded("(list y y)", &message, {.preserve_sharing = true});
+    auto shared = As<Cell>(Decode(message));
+    REQUIRE(shared->GetFirst() == As<Cell>(shared->GetSecond())->GetFirst());
+    REQUIRE(SerializeToString(shared) == "((1 2) (1 2))");
+}
+
+TEST_CASE("Wire handles deep nesting") {
+    constexpr size_t kDepth = 1000000;
+    ObjectPtr nested;
+    for (size_t i = 0; i < kDepth; ++i) {
+        auto cell = MakeNode<Cell>();
+        cell->SetFirst(nested);
+        nested = cell;
+    }
+
+    std::string message;
+    Encode(nested, &message);
+    auto decoded = Decode(message);
+    size_t depth = 0;
+    for (auto cell = As<Cell>(decoded); cell != nullptr; cell = As<Cell>(cell->GetFirst())) {
+        ++depth;
+    }
+    REQUIRE(depth == kDepth);
+}
+
+TEST_CASE("Wire streams") {
+    std::stringstream stream;
+    Encode(MakeNode<Number>(42), &stream);
+    Encode(MakeNode<Symbol>("next"), &stream);
+    REQUIRE(SerializeToString(Decode(stream)) == "42");
+    REQUIRE(SerializeToString(Decode(stream)) == "next");
+    REQUIRE_THROWS_AS(Decode(stream), RuntimeError);
+
+    auto cycle = MakeNode<Cell>();
+    cycle->SetFirst(MakeNode<Number>(1));
+    cycle->SetSecond(cycle);
+    cycle->MarkMutated();
+    std::stringstream cyclic;
+    Encode(cycle, &cyclic);
+    REQUIRE(SerializeToString(Decode(cyclic)) == "#0=(1 . #0#)");
+    cycle->SetSecond(nullptr);
+}
+
+TEST_CASE("Wire rejects malformed messages") {
+    Interpreter interpreter;
+    std::string message;
+    interpreter.RunEncoded("'(1 \"two\" three)", &message);
+    for (size_t size = 0; size < message.size(); ++size) {
+        REQUIRE_THROWS_AS(Decode(std::string_view{message}.substr(0, size)), RuntimeError);
+    }
+    REQUIRE_THROWS_AS(Decode(message + '\0'), RuntimeError);
+    REQUIRE_THROWS_AS(Decode(std::string{"\x01\x05\x00", 3}), RuntimeError);
+    REQUIRE_THROWS_AS(Decode(std::string{"\x02\x00", 2}), RuntimeError);
+    REQUIRE_THROWS_AS(Decode(std::string{"\x01\x0a\x00", 3}), RuntimeError);
+
+    REQUIRE_THROWS_AS(interpreter.RunEncoded("car", &message), RuntimeError);
+}
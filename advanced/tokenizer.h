@@ -6,6 +6,10 @@
 #include <cctype>
 #include <array>
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string>
 #include "error.h"
 
 struct SymbolToken {
@@ -31,28 +35,116 @@ struct DotToken {
 enum class BracketToken { OPEN, CLOSE };
 
 struct ConstantToken {
-    int value;
+    int64_t value;
 
     bool operator==(const ConstantToken& other) const {
         return value == other.value;
     }
 };
 
-using Token = std::variant<ConstantToken, BracketToken, SymbolToken, QuoteToken, DotToken>;
+struct StringToken {
+    std::string value;
+
+    bool operator==(const StringToken& other) const {
+        return value == other.value;
+    }
+};
+
+// Integer literal too large for a ConstantToken; digits has the optional sign.
+struct BigConstantToken {
+    std::string digits;
+
+    bool operator==(const BigConstantToken& other) const {
+        return digits == other.digits;
+    }
+};
+
+struct FloatConstantToken {
+    double value;
+
+    bool operator==(const FloatConstantToken& other) const {
+        return value == other.value;
+    }
+};
+
+// #( that opens a vector; the vector is closed with BracketToken::CLOSE.
+struct VectorOpenToken {
+    bool operator==(const VectorOpenToken&) const {
+        return true;
+    }
+};
+
+using Token = std::variant<ConstantToken, BracketToken, SymbolToken, QuoteToken, DotToken,
+                           StringToken, BigConstantToken, FloatConstantToken, VectorOpenToken>;
 
 class Tokenizer {
 private:
     std::istream* in_;
     Token temp_token_;
     bool reach_end_ = false;
+    bool pending_ = true;
+    size_t offset_ = 0;
+    int Get() {
+        auto c = in_->get();
+        if (c != EOF) {
+            ++offset_;
+        }
+        return c;
+    }
     std::string ReadWholeNumber() {
         std::string str;
         while (std::isdigit(in_->peek())) {
-            auto addition = in_->get();
+            auto addition = Get();
             str += addition;
         }
         return str;
     }  // НЕ ЗАБЫТЬ РАПИСАТЬ ВОЗМОЖНЫЕ СТМВОЛЫ АЗ И ТД!!!
+    static Token MakeConstantToken(const std::string& text) {
+        auto digits = text.front() == '+' ? text.substr(1) : text;
+        int64_t value = 0;
+        auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+        if (error == std::errc::result_out_of_range) {
+            return BigConstantToken{text};
+        }
+        return ConstantToken{value};
+    }
+    // Reads the fraction and the exponent that may follow the integer part in text.
+    Token ReadNumber(std::string text) {
+        bool inexact = false;
+        if (in_->peek() == '.') {
+            inexact = true;
+            text += Get();
+            text += ReadWholeNumber();
+        }
+        if (in_->peek() == 'e' || in_->peek() == 'E') {
+            inexact = true;
+            ReadExponent(&text);
+        }
+        return inexact ? MakeFloatConstantToken(text) : MakeConstantToken(text);
+    }
+    void ReadExponent(std::string* text) {
+        *text += Get();
+        if (in_->peek() == '+' || in_->peek() == '-') {
+            *text += Get();
+        }
+        auto digits = ReadWholeNumber();
+        if (digits.empty()) {
+            throw SyntaxError("bad number: " + *text);
+        }
+        *text += digits;
+    }
+    static Token MakeFloatConstantToken(const std::string& text) {
+        auto digits = text.front() == '+' ? text.substr(1) : text;
+        double value = 0;
+        auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+        if (error == std::errc::result_out_of_range) {
+            auto exponent = digits.find_first_of("eE");
+            bool underflow = exponent != std::string::npos && digits[exponent + 1] == '-';
+            value = underflow ? 0.0 : std::numeric_limits<double>::infinity();
+            value = digits.front() == '-' ? -value : value;
+        }
+        return FloatConstantToken{value};
+    }
     std::array<char, 2> signs_ = {'+', '-'};
     std::array<char, 6> signs_begin_ = {'<', '=', '>', '*', '/', '#'};
     std::array<char, 4> sings_contain_ = {'/', '?', '!', '-'};
@@ -65,34 +157,111 @@ private:
                std::find(sings_contain_.begin(), sings_contain_.end(), c) != sings_contain_.end() ||
                std::isdigit(c);
     }
+    std::string ReadStringLiteral() {
+        std::string str;
+        while (true) {
+            auto c = Get();
+            if (c == EOF) {
+                throw SyntaxError("unterminated string");
+            }
+            if (c == '"') {
+                return str;
+            }
+            if (c == '\\') {
+                c = Get();
+                if (c == EOF) {
+                    throw SyntaxError("unterminated string");
+                }
+                if (c == 'n') {
+                    c = '\n';
+                } else if (c == 't') {
+                    c = '\t';
+                }
+            }
+            str += static_cast<char>(c);
+        }
+    }
     std::string SubmitTail() {
         std::string str;
         while (AllowedTail(in_->peek())) {
-            str += in_->get();
+            str += Get();
         }
         return str;
     }
 
 public:
     Tokenizer(std::istream* in) : in_(in) {
-        Next();
     }
 
     bool IsEnd() {
+        Fetch();
         return reach_end_;
     }
 
     void Next() {
+        Fetch();
+        pending_ = true;
+    }
+
+    Token GetToken() {
+        Fetch();
+        return temp_token_;
+    }
+
+    // Skips the raw text up to the bracket that closes the current list, leaving that bracket
+    // unread, and returns the [begin, end) byte offsets of the skipped text. Must be called
+    // right after Next(). Only brackets and string literals are looked at.
+    std::pair<size_t, size_t> SkipToClosingBracket() {
+        size_t begin = offset_;
+        size_t depth = 0;
+        while (true) {
+            auto c = in_->peek();
+            if (c == EOF) {
+                throw SyntaxError("no closing bracket");
+            }
+            if (c == ')' && depth == 0) {
+                return {begin, offset_};
+            }
+            Get();
+            if (c == '(') {
+                ++depth;
+            } else if (c == ')') {
+                --depth;
+            } else if (c == '"') {
+                ReadStringLiteral();
+            }
+        }
+    }
+
+private:
+    // The next token is read only when it is inspected, so a caller reading forms from an
+    // interactive stream is never blocked waiting for input past the current form.
+    void Fetch() {
+        if (pending_) {
+            pending_ = false;
+            ReadToken();
+        }
+    }
+
+    void ReadToken() {
         char c;
         while (std::isspace(in_->peek())) {
-            in_->get();
+            Get();
         }
         if (in_->eof() || in_->peek() == EOF) {
             reach_end_ = true;
             return;
         }
-        c = in_->get();
+        c = Get();
         std::string cur_token = {c};
+        if (c == '.' && std::isdigit(in_->peek())) {
+            cur_token = "0." + ReadWholeNumber();
+            if (in_->peek() == 'e' || in_->peek() == 'E') {
+                ReadExponent(&cur_token);
+            }
+            temp_token_ = MakeFloatConstantToken(cur_token);
+            return;
+        }
         if (c == '.') {
             temp_token_ = DotToken{};
             return;
@@ -109,9 +278,18 @@ public:
             temp_token_ = BracketToken::CLOSE;
             return;
         }
+        if (c == '"') {
+            temp_token_ = StringToken{ReadStringLiteral()};
+            return;
+        }
+        if (c == '#' && in_->peek() == '(') {
+            Get();
+            temp_token_ = VectorOpenToken{};
+            return;
+        }
         if (std::isdigit(c)) {
             cur_token += ReadWholeNumber();
-            temp_token_ = ConstantToken{std::stoi(cur_token)};
+            temp_token_ = ReadNumber(cur_token);
             return;
         }
         if (std::find(signs_.begin(), signs_.end(), c) != signs_.end()) {
@@ -121,7 +299,7 @@ public:
                 return;
             }
             cur_token += read;
-            temp_token_ = ConstantToken{std::stoi(cur_token)};
+            temp_token_ = ReadNumber(cur_token);
             return;
         }
         if (AllowedBegin(c)) {
@@ -131,8 +309,4 @@ public:
         }
         throw SyntaxError(std::string("Unknown token: ") + c);
     }
-
-    Token GetToken() {
-        return temp_token_;
-    }
 };
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "representation.h"
+#include "serializer.h"
+
+namespace {
+
+std::shared_ptr<Vector> GetVector(const ObjectPtr& object) {
+    auto vector = As<Vector>(object);
+    if (vector == nullptr) {
+        throw RuntimeError("expected vector");
+    }
+    return vector;
+}
+
+std::shared_ptr<Vector> GetMutableVector(const ObjectPtr& object) {
+    auto vector = GetVector(object);
+    if (vector->IsConstant()) {
+        throw RuntimeError("can't modify a shared constant");
+    }
+    return vector;
+}
+
+size_t GetIndex(const ObjectPtr& object, size_t size) {
+    IntType index = GetNumber(object).GetValue();
+    if (index < 0 || static_cast<size_t>(index) >= size) {
+        throw RuntimeError("index out of bounds");
+    }
+    return static_cast<size_t>(index);
+}
+
+// The [start, end) range given by the optional arguments from args[first] on.
+std::pair<size_t, size_t> GetRange(const std::vector<ObjectPtr>& args, size_t first,
+                                   size_t size) {
+    size_t start = args.size() > first ? GetIndex(args[first], size + 1) : 0;
+    size_t end = args.size() > first + 1 ? GetIndex(args[first + 1], size + 1) : size;
+    if (end < start) {
+        throw RuntimeError("index out of bounds");
+    }
+    return {start, end};
+}
+
+}  // namespace
+
+std::vector<ObjectPtr>& Vector::GetMutableElements() {
+    if (IsForkShared()) [[unlikely]] {
+        if (auto* elements = current_fork->FindElements(this)) {
+            return *elements;
+        }
+        return *current_fork->SetElements(this, elements_);
+    }
+    return elements_;
+}
+
+const std::vector<ObjectPtr>& Vector::GetForkedElements() const {
+    const auto* elements = current_fork->FindElements(this);
+    return elements != nullptr ? *elements : elements_;
+}
+
+Vector::~Vector() {
+    ReleaseChildren(this);
+}
+
+std::string Vector::Serialize() {
+    std::string answer;
+    SerializeTo(shared_from_this(), &answer);
+    return answer;
+}
+
+ObjectPtr Vector::Evaluate(const std::shared_ptr<ScopesCollection>&) {
+    return shared_from_this();
+}
+
+void Vector::DetachChildren(std::vector<ObjectPtr>* pending) {
+    for (auto& element : elements_) {
+        if (element != nullptr && element.use_count() == 1) {
+            pending->push_back(std::move(element));
+        }
+    }
+}
+
+std::vector<ObjectPtr> MakeVector::DoCall(const std::vector<ObjectPtr>& args,
+                                          const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountBetween(args, 1, 2);
+
+    IntType size = GetNumber(args.front()).GetValue();
+    if (size < 0) {
+        throw RuntimeError("expected non-negative length");
+    }
+    std::vector<ObjectPtr> elements;
+    if (static_cast<uint64_t>(size) > elements.max_size()) {
+        throw RuntimeError("vector is too long");
+    }
+    auto fill = args.size() == 2 ? args[1] : MakeNode<Number>(0);
+    try {
+        elements.assign(static_cast<size_t>(size), fill);
+    } catch (const std::bad_alloc&) {
+        throw RuntimeError("vector is too long");
+    }
+    return {MakeNode<Vector>(std::move(elements))};
+}
+
+std::vector<ObjectPtr> VectorOf::DoCall(const std::vector<ObjectPtr>& args,
+                                        const std::shared_ptr<ScopesCollection>&) {
+    return {MakeNode<Vector>(args)};
+}
+
+std::vector<ObjectPtr> VectorRef::DoCall(const std::vector<ObjectPtr>& args,
+                                         const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 2);
+
+    const auto& elements = GetVector(args.front())->GetElements();
+    return {elements[GetIndex(args[1], elements.size())]};
+}
+
+std::vector<ObjectPtr> VectorSet::DoCall(const std::vector<ObjectPtr>& args,
+                                         const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 3);
+
+    auto vector = GetMutableVector(args.front());
+    auto index = GetIndex(args[1], vector->GetElements().size());
+    vector->GetMutableElements()[index] = args[2];
+    return {nullptr};
+}
+
+std::vector<ObjectPtr> VectorLength::DoCall(const std::vector<ObjectPtr>& args,
+                                            const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+
+    auto size = GetVector(args.front())->GetElements().size();
+    return {MakeNode<Number>(static_cast<IntType>(size))};
+}
+
+std::vector<ObjectPtr> VectorFill::DoCall(const std::vector<ObjectPtr>& args,
+                                          const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountBetween(args, 2, 4);
+
+    auto vector = GetMutableVector(args.front());
+    auto [start, end] = GetRange(args, 2, vector->GetElements().size());
+    auto& elements = vector->GetMutableElements();
+    std::fill(elements.begin() + start, elements.begin() + end, args[1]);
+    return {nullptr};
+}
+
+std::vector<ObjectPtr> ListToVector::DoCall(const std::vector<ObjectPtr>& args,
+                                            const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountEqual(args, 1);
+
+    auto elements = Flatten(args.front());
+    if (elements.back() != nullptr) {
+        throw RuntimeError("expected list");
+    }
+    elements.pop_back();
+    return {MakeNode<Vector>(std::move(elements))};
+}
+
+std::vector<ObjectPtr> VectorToList::DoCall(const std::vector<ObjectPtr>& args,
+                                            const std::shared_ptr<ScopesCollection>&) {
+    AssertArgsCountBetween(args, 1, 3);
+
+    const auto& elements = GetVector(args.front())->GetElements();
+    auto [start, end] = GetRange(args, 1, elements.size());
+    std::vector<ObjectPtr> answer(elements.begin() + start, elements.begin() + end);
+    answer.push_back(nullptr);
+    return answer;
+}
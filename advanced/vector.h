@@ -0,0 +1,106 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <funcs.h>
+#include <object.h>
+
+// Vectors: fixed-length sequences whose elements are stored contiguously, so vector-ref and
+// vector-set! take constant time. #(...) reads as a vector of its unevaluated elements, and a
+// vector evaluates to itself. Read with a ConstantPool, a literal vector is a constant like a
+// quoted list: its elements are interned, and vector-set! and vector-fill! refuse to modify it.
+//
+// A vector created before Interpreter::Fork is shared copy-on-write like cells are: the first
+// vector-set! or vector-fill! of a fork copies its elements into the fork's overlay.
+
+class Vector : public Object {
+public:
+    explicit Vector(std::vector<ObjectPtr> elements) : elements_(std::move(elements)) {
+    }
+    ~Vector() override;
+
+    // Borrowed; valid until the vector is modified.
+    const std::vector<ObjectPtr>& GetElements() const {
+        if (IsForkShared()) [[unlikely]] {
+            return GetForkedElements();
+        }
+        return elements_;
+    }
+    std::vector<ObjectPtr>& GetMutableElements();
+
+    bool IsConstant() const {
+        return constant_;
+    }
+    void MarkConstant() {
+        constant_ = true;
+    }
+
+    // Throws RuntimeError for a vector that contains itself.
+    std::string Serialize() override;
+    ObjectPtr Evaluate(const std::shared_ptr<ScopesCollection>& scopes) override;
+    void DetachChildren(std::vector<ObjectPtr>* pending) override;
+
+private:
+    std::vector<ObjectPtr> elements_;
+    bool constant_ = false;
+    uint32_t generation_ = GetForkGeneration();
+
+    bool IsForkShared() const {
+        return generation_ < current_fork_generation;
+    }
+    const std::vector<ObjectPtr>& GetForkedElements() const;
+};
+
+// (make-vector k [fill]); the elements are 0 without fill.
+class MakeVector : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+// (vector obj ...)
+class VectorOf : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+class VectorRef : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+class VectorSet : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+class VectorLength : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+// (vector-fill! v fill [start [end]])
+class VectorFill : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+class ListToVector : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
+
+// (vector->list v [start [end]])
+class VectorToList : public EvaluatingArgumentFunction {
+public:
+    std::vector<ObjectPtr> DoCall(const std::vector<ObjectPtr>& args,
+                                  const std::shared_ptr<ScopesCollection>& scopes);
+};
@@ -0,0 +1,447 @@
+#include "wire.h"
+
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <bigint.h>
+#include <error.h>
+#include <host_vector.h>
+#include <memory_stream.h>
+#include <serializer.h>
+
+namespace {
+
+constexpr size_t kFlushSize = 64 << 10;
+
+uint64_t ZigZag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+class Encoder {
+public:
+    Encoder(std::string* buffer, std::ostream* out, const WireOptions& options)
+        : buffer_(buffer), out_(out), options_(options) {
+    }
+
+    void Encode(const ObjectPtr& root) {
+        auto* cell = dynamic_cast<const Cell*>(root.get());
+        // Into a string, the search for cycles is put off until a mutated pair shows up; the
+        // message is then discarded and written again with labels. Streamed messages can't be
+        // taken back, so they search first.
+        optimistic_ = cell != nullptr && out_ == nullptr && !options_.preserve_sharing;
+        if (cell != nullptr && !optimistic_) {
+            labels_ = FindLabelledPairs(cell, options_.preserve_sharing);
+        }
+
+        auto start = buffer_->size();
+        if (!Write(root)) {
+            buffer_->resize(start);
+            symbols_.clear();
+            frames_.clear();
+            optimistic_ = false;
+            labels_ = FindLabelledPairs(cell, false);
+            Write(root);
+        }
+        Flush(false);
+    }
+
+    void Flush(bool all) {
+        if (out_ != nullptr && (all || buffer_->size() >= kFlushSize)) {
+            out_->write(buffer_->data(), static_cast<std::streamsize>(buffer_->size()));
+            buffer_->clear();
+        }
+    }
+
+private:
+    // Writes the message, unless an optimistic write meets a mutated pair.
+    bool Write(const ObjectPtr& root) {
+        buffer_->push_back(static_cast<char>(kWireVersion));
+        WriteItem(root);
+        while (!frames_.empty() && !found_mutated_) {
+            auto& frame = frames_.back();
+            if (frame.remaining > 0) {
+                const auto& [first, second] = frame.cell->GetChildren();
+                // The pairs counted by Open continue the spine.
+                frame.cell = --frame.remaining > 0 ? static_cast<const Cell*>(second.get())
+                                                   : nullptr;
+                // May push a frame, so `frame` isn't used afterwards.
+                WriteItem(first);
+                continue;
+            }
+
+            if (frame.tail != nullptr) {
+                auto tail = std::move(frame.tail);
+                frame.tail = nullptr;
+                WriteItem(tail);
+                continue;
+            }
+
+            frames_.pop_back();
+            Flush(false);
+        }
+        return !std::exchange(found_mutated_, false);
+    }
+
+    // A list being written: `remaining` elements from `cell` on, then `tail` unless it is ().
+    struct Frame {
+        const Cell* cell;
+        uint64_t remaining;
+        ObjectPtr tail;
+    };
+
+    std::string* buffer_;
+    std::ostream* out_;
+    WireOptions options_;
+    std::unordered_map<const Cell*, int64_t> labels_;
+    int64_t next_label_ = 0;
+    bool optimistic_ = false;
+    bool found_mutated_ = false;
+    // Names are owned by the symbols of the value being encoded.
+    std::unordered_map<std::string_view, uint64_t> symbols_;
+    std::vector<Frame> frames_;
+
+    void WriteTag(WireTag tag) {
+        buffer_->push_back(static_cast<char>(tag));
+    }
+
+    void WriteVarint(uint64_t value) {
+        while (value >= 0x80) {
+            buffer_->push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        buffer_->push_back(static_cast<char>(value));
+    }
+
+    void WriteBytes(const std::string& bytes) {
+        WriteVarint(bytes.size());
+        *buffer_ += bytes;
+    }
+
+    void WriteItem(const ObjectPtr& object) {
+        if (object == nullptr) {
+            WriteTag(WireTag::NIL);
+        } else if (auto* cell = dynamic_cast<const Cell*>(object.get())) {
+            Open(cell);
+        } else if (auto* number = dynamic_cast<const Number*>(object.get())) {
+            WriteTag(WireTag::NUMBER);
+            WriteVarint(ZigZag(number->GetValue()));
+        } else if (auto* big = dynamic_cast<const BigInteger*>(object.get())) {
+            WriteTag(WireTag::BIG_NUMBER);
+            WriteVarint(big->GetValue().IsNegative());
+            const auto& magnitude = big->GetValue().GetMagnitude();
+            WriteVarint(magnitude.size() * 4);
+            for (auto digit : magnitude) {
+                for (int i = 0; i < 4; ++i) {
+                    buffer_->push_back(static_cast<char>(digit >> (8 * i)));
+                }
+            }
+        } else if (auto* flonum = dynamic_cast<const Flonum*>(object.get())) {
+            WriteTag(WireTag::FLONUM);
+            auto bits = std::bit_cast<uint64_t>(flonum->GetValue());
+            for (int i = 0; i < 8; ++i) {
+                buffer_->push_back(static_cast<char>(bits >> (8 * i)));
+            }
+        } else if (auto* symbol = dynamic_cast<const Symbol*>(object.get())) {
+            auto [it, inserted] = symbols_.try_emplace(symbol->GetName(), symbols_.size());
+            if (inserted) {
+                WriteTag(WireTag::SYMBOL);
+                WriteBytes(symbol->GetName());
+            } else {
+                WriteTag(WireTag::SYMBOL_REF);
+                WriteVarint(it->second);
+            }
+        } else if (auto* string = dynamic_cast<const String*>(object.get())) {
+            WriteTag(WireTag::STRING);
+            WriteBytes(string->GetValue());
+        } else if (auto* boolean = dynamic_cast<const Boolean*>(object.get())) {
+            WriteTag(boolean->GetValue() ? WireTag::TRUE : WireTag::FALSE);
+        } else if (auto* view = dynamic_cast<const HostVector*>(object.get())) {
+            // Host views are proper lists of their elements.
+            const auto& elements = view->GetElements();
+            if (elements.empty()) {
+                WriteTag(WireTag::NIL);
+                return;
+            }
+            WriteTag(WireTag::LIST);
+            WriteVarint(elements.size());
+            for (auto element : elements) {
+                WriteTag(WireTag::NUMBER);
+                WriteVarint(ZigZag(element));
+            }
+        } else {
+            throw RuntimeError("value can't be encoded: " + object->Serialize());
+        }
+    }
+
+    void Open(const Cell* cell) {
+        if (optimistic_ && cell->IsMutated()) {
+            found_mutated_ = true;
+            return;
+        }
+        if (!labels_.empty()) {
+            if (auto it = labels_.find(cell); it != labels_.end()) {
+                if (it->second >= 0) {
+                    WriteTag(WireTag::LABEL_REF);
+                    WriteVarint(it->second);
+                    return;
+                }
+                it->second = next_label_++;
+                WriteTag(WireTag::LABEL);
+            }
+        }
+
+        // Counts the spine up to its end or to a labelled pair, which is written as the tail.
+        uint64_t count = 1;
+        const auto* last = cell;
+        while (auto* next = dynamic_cast<const Cell*>(last->GetChildren().second.get())) {
+            if (!labels_.empty() && labels_.contains(next)) {
+                break;
+            }
+            if (optimistic_ && next->IsMutated()) {
+                found_mutated_ = true;
+                return;
+            }
+            last = next;
+            ++count;
+        }
+        auto tail = last->GetChildren().second;
+
+        WriteTag(tail == nullptr ? WireTag::LIST : WireTag::DOTTED);
+        WriteVarint(count);
+        frames_.push_back({cell, count, std::move(tail)});
+    }
+};
+
+class Decoder {
+public:
+    explicit Decoder(std::streambuf* in) : in_(in) {
+    }
+
+    ObjectPtr Decode() {
+        if (ReadByte() != kWireVersion) {
+            throw RuntimeError("unsupported wire format version");
+        }
+
+        ObjectPtr value;
+        while (true) {
+            if (!ReadItem(&value)) {
+                // Opened a list; its first element comes next.
+                continue;
+            }
+            // Adds the value to the innermost open list and closes the lists it completes.
+            while (true) {
+                if (frames_.empty()) {
+                    return value;
+                }
+                auto& frame = frames_.back();
+                bool tail = frame.remaining == 0;
+                if (tail) {
+                    frame.last->SetSecond(std::move(value));
+                } else {
+                    Append(&frame, std::move(value));
+                }
+                if (std::exchange(label_reference_, false)) {
+                    // Writers only look for cycles through mutated pairs, and a label
+                    // reference may close one.
+                    frame.last->MarkMutated();
+                }
+                if (!tail && (--frame.remaining > 0 || frame.dotted)) {
+                    break;
+                }
+                value = std::move(frame.head);
+                frames_.pop_back();
+            }
+        }
+    }
+
+private:
+    // A list being read: `remaining` more elements, then the tail if it is dotted.
+    struct Frame {
+        std::shared_ptr<Cell> head;
+        Cell* last;
+        uint64_t remaining;
+        bool dotted;
+    };
+
+    std::streambuf* in_;
+    std::vector<ObjectPtr> symbols_;
+    std::vector<ObjectPtr> labels_;
+    bool pending_label_ = false;
+    // The value just read is a labelled pair.
+    bool label_reference_ = false;
+    std::vector<Frame> frames_;
+
+    [[noreturn]] static void Corrupted() {
+        throw RuntimeError("corrupted wire message");
+    }
+
+    uint8_t ReadByte() {
+        auto c = in_->sbumpc();
+        if (c == std::streambuf::traits_type::eof()) {
+            throw RuntimeError("truncated wire message");
+        }
+        return static_cast<uint8_t>(c);
+    }
+
+    uint64_t ReadVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            auto byte = ReadByte();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        Corrupted();
+    }
+
+    uint64_t ReadIndex(size_t size) {
+        auto index = ReadVarint();
+        if (index >= size) {
+            Corrupted();
+        }
+        return index;
+    }
+
+    std::string ReadBytes() {
+        auto size = ReadVarint();
+        std::string bytes;
+        // Grows with the data actually read rather than trusting the length.
+        while (bytes.size() < size) {
+            auto offset = bytes.size();
+            auto chunk = std::min<uint64_t>(size - offset, kFlushSize);
+            bytes.resize(offset + chunk);
+            auto count = static_cast<std::streamsize>(chunk);
+            if (in_->sgetn(bytes.data() + offset, count) != count) {
+                throw RuntimeError("truncated wire message");
+            }
+        }
+        return bytes;
+    }
+
+    // Reads a value into *value, or opens a list and returns false.
+    bool ReadItem(ObjectPtr* value) {
+        auto tag = static_cast<WireTag>(ReadByte());
+        if (pending_label_ && tag != WireTag::LIST && tag != WireTag::DOTTED) {
+            Corrupted();
+        }
+
+        switch (tag) {
+            case WireTag::NIL:
+                *value = nullptr;
+                return true;
+            case WireTag::FALSE:
+            case WireTag::TRUE:
+                *value = MakeNode<Boolean>(tag == WireTag::TRUE);
+                return true;
+            case WireTag::NUMBER:
+                *value = MakeNode<Number>(UnZigZag(ReadVarint()));
+                return true;
+            case WireTag::BIG_NUMBER: {
+                auto negative = ReadVarint();
+                auto bytes = ReadBytes();
+                if (negative > 1 || bytes.size() % 4 != 0) {
+                    Corrupted();
+                }
+                std::vector<uint32_t> magnitude(bytes.size() / 4);
+                for (size_t i = 0; i < bytes.size(); ++i) {
+                    magnitude[i / 4] |= static_cast<uint32_t>(static_cast<uint8_t>(bytes[i]))
+                                        << (8 * (i % 4));
+                }
+                *value = MakeInteger(BigInt::FromMagnitude(negative == 1, std::move(magnitude)));
+                return true;
+            }
+            case WireTag::FLONUM: {
+                uint64_t bits = 0;
+                for (int i = 0; i < 8; ++i) {
+                    bits |= static_cast<uint64_t>(ReadByte()) << (8 * i);
+                }
+                *value = MakeNode<Flonum>(std::bit_cast<double>(bits));
+                return true;
+            }
+            case WireTag::SYMBOL:
+                *value = MakeNode<Symbol>(ReadBytes());
+                symbols_.push_back(*value);
+                return true;
+            case WireTag::SYMBOL_REF:
+                *value = symbols_[ReadIndex(symbols_.size())];
+                return true;
+            case WireTag::STRING:
+                *value = MakeNode<String>(ReadBytes());
+                return true;
+            case WireTag::LIST:
+            case WireTag::DOTTED: {
+                auto count = ReadVarint();
+                if (count == 0) {
+                    Corrupted();
+                }
+                // Created up front so references to its label inside the list resolve.
+                auto head = MakeNode<Cell>();
+                if (pending_label_) {
+                    labels_.push_back(head);
+                    pending_label_ = false;
+                }
+                frames_.push_back({std::move(head), nullptr, count, tag == WireTag::DOTTED});
+                return false;
+            }
+            case WireTag::LABEL:
+                pending_label_ = true;
+                return ReadItem(value);
+            case WireTag::LABEL_REF:
+                *value = labels_[ReadIndex(labels_.size())];
+                label_reference_ = true;
+                return true;
+        }
+        Corrupted();
+    }
+
+    static void Append(Frame* frame, ObjectPtr value) {
+        if (frame->last == nullptr) {
+            frame->head->SetFirst(std::move(value));
+            frame->last = frame->head.get();
+            return;
+        }
+        auto cell = MakeNode<Cell>();
+        cell->SetFirst(std::move(value));
+        auto* last = cell.get();
+        frame->last->SetSecond(std::move(cell));
+        frame->last = last;
+    }
+};
+
+}  // namespace
+
+void Encode(const ObjectPtr& value, std::string* out, const WireOptions& options) {
+    Encoder encoder{out, nullptr, options};
+    encoder.Encode(value);
+}
+
+void Encode(const ObjectPtr& value, std::ostream* out, const WireOptions& options) {
+    std::string buffer;
+    buffer.reserve(kFlushSize);
+    Encoder encoder{&buffer, out, options};
+    encoder.Encode(value);
+    encoder.Flush(true);
+}
+
+ObjectPtr Decode(std::string_view data) {
+    MemoryBuffer buffer{data};
+    Decoder decoder{&buffer};
+    auto value = decoder.Decode();
+    if (buffer.sgetc() != std::streambuf::traits_type::eof()) {
+        throw RuntimeError("trailing data after wire message");
+    }
+    return value;
+}
+
+ObjectPtr Decode(std::istream& in) {
+    Decoder decoder{in.rdbuf()};
+    return decoder.Decode();
+}
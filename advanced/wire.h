@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include <object.h>
+
+// Compact binary format for shipping values between processes, cheaper to produce and to read
+// than the external representation. A message is a version byte followed by one value:
+//
+//   NIL | FALSE | TRUE
+//   NUMBER varint                 zigzag encoded
+//   SYMBOL varint bytes           length and name; gets the next symbol id of the message
+//   SYMBOL_REF varint             id of a symbol written earlier in the message
+//   STRING varint bytes
+//   LIST varint value...          proper list of that many elements, at least one
+//   DOTTED varint value... value  elements, then the tail
+//   LABEL list                    list whose first pair gets the next label id
+//   LABEL_REF varint              id of a labelled pair written earlier in the message
+//   BIG_NUMBER varint bytes       sign (1 if negative) and the magnitude in 4-byte
+//                                 little-endian digits, least significant first
+//   FLONUM bytes                  8 bytes of the IEEE 754 double, little-endian
+//
+// Pairs closing a cycle are always labelled. With WireOptions::preserve_sharing every pair
+// reached more than once is, so the decoded value shares structure like the encoded one;
+// otherwise such pairs are written every time they are reached. Varints are little-endian
+// base 128. Both directions work without recursion, so arbitrarily deep lists can be shipped.
+
+inline constexpr uint8_t kWireVersion = 1;
+
+enum class WireTag : uint8_t {
+    NIL,
+    FALSE,
+    TRUE,
+    NUMBER,
+    SYMBOL,
+    SYMBOL_REF,
+    STRING,
+    LIST,
+    DOTTED,
+    LABEL,
+    LABEL_REF,
+    BIG_NUMBER,
+    FLONUM,
+};
+
+struct WireOptions {
+    // Label every shared pair rather than only the targets of cycles. Costs a pass over the
+    // value with a hash table, so it is off by default.
+    bool preserve_sharing = false;
+};
+
+// Appends the message of value to out. Throws RuntimeError for values that have no wire form,
+// such as functions.
+void Encode(const ObjectPtr& value, std::string* out, const WireOptions& options = {});
+
+// Streams the message of value to out in chunks.
+void Encode(const ObjectPtr& value, std::ostream* out, const WireOptions& options = {});
+
+// Decodes a message that makes up all of data. Throws RuntimeError on malformed data.
+ObjectPtr Decode(std::string_view data);
+
+// Reads one message from in, leaving what follows it unread.
+ObjectPtr Decode(std::istream& in);
@@ -0,0 +1,68 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <event_reader.h>
+#include <parser.h>
+
+// Compares a scan-only workload (summing every number of a large data file) done with
+// EventReader against building the full tree with Read.
+// Usage: scheme_parser_bench_events [MEGABYTES]
+
+template <typename Body>
+double MeasureMs(Body&& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int64_t SumNumbers(const std::shared_ptr<Object>& root) {
+    int64_t sum = 0;
+    std::vector<std::shared_ptr<Object>> stack{root};
+    while (!stack.empty()) {
+        auto object = std::move(stack.back());
+        stack.pop_back();
+        if (auto number = As<Number>(object); number != nullptr) {
+            sum += number->GetValue();
+        } else if (auto cell = As<Cell>(object); cell != nullptr) {
+            stack.push_back(cell->GetFirst());
+            stack.push_back(cell->GetSecond());
+        }
+    }
+    return sum;
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 16;
+
+    std::string data;
+    for (int i = 0; data.size() < megabytes * 1024 * 1024; ++i) {
+        data += "(record " + std::to_string(i) + " (tags alpha beta) (values 1 2 3 4 5 . 6))\n";
+    }
+
+    int64_t event_sum = 0;
+    double events_ms = MeasureMs([&] {
+        std::stringstream ss{data};
+        Tokenizer tokenizer{&ss};
+        ReadEvents(&tokenizer, [&event_sum](const ReadEvent& event) {
+            if (event.type == ReadEventType::NUMBER) {
+                event_sum += event.number;
+            }
+        });
+    });
+
+    int64_t tree_sum = 0;
+    double tree_ms = MeasureMs([&] {
+        std::stringstream ss{data};
+        Tokenizer tokenizer{&ss};
+        while (!tokenizer.IsEnd()) {
+            tree_sum += SumNumbers(Read(&tokenizer));
+        }
+    });
+
+    std::cout << "EventReader: " << events_ms << " ms (sum " << event_sum << ")\n"
+              << "Read:        " << tree_ms << " ms (sum " << tree_sum << ")\n"
+              << "speedup:     " << tree_ms / events_ms << "x" << std::endl;
+}
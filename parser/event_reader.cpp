@@ -0,0 +1,79 @@
+#include <event_reader.h>
+
+bool EventReader::Next() {
+    // The token of the previous event is consumed only now, so the symbol name it points to
+    // stays valid until this call.
+    if (consume_token_) {
+        tokenizer_->Next();
+        consume_token_ = false;
+    }
+    if (tokenizer_->IsEnd()) {
+        if (!levels_.empty()) {
+            throw SyntaxError("no closing bracket");
+        }
+        return false;
+    }
+
+    const Token& token = tokenizer_->PeekToken();
+    auto* level = levels_.empty() ? nullptr : &levels_.back();
+
+    if (auto* bracket = std::get_if<BracketToken>(&token); bracket != nullptr) {
+        if (*bracket == BracketToken::OPEN) {
+            if (level != nullptr && *level == Level::EXPECT_CLOSE) {
+                throw SyntaxError("no closing bracket no end of the token");
+            }
+            levels_.push_back(Level::EMPTY);
+            event_ = {ReadEventType::BEGIN_LIST, 0, {}};
+        } else {
+            if (level == nullptr || *level == Level::AFTER_DOT) {
+                throw SyntaxError("closing");
+            }
+            levels_.pop_back();
+            event_ = {ReadEventType::END_LIST, 0, {}};
+            CompleteDatum();
+        }
+        consume_token_ = true;
+        return true;
+    }
+
+    if (std::holds_alternative<DotToken>(token)) {
+        if (level == nullptr || *level != Level::ELEMENTS) {
+            throw SyntaxError(level != nullptr && *level == Level::EMPTY
+                                  ? "no dot in the beginning"
+                                  : "dot");
+        }
+        *level = Level::AFTER_DOT;
+        event_ = {ReadEventType::DOT, 0, {}};
+        consume_token_ = true;
+        return true;
+    }
+
+    if (level != nullptr && *level == Level::EXPECT_CLOSE) {
+        throw SyntaxError("no closing bracket no end of the token");
+    }
+
+    if (auto* constant = std::get_if<ConstantToken>(&token); constant != nullptr) {
+        event_ = {ReadEventType::NUMBER, constant->value, {}};
+    } else if (auto* symbol = std::get_if<SymbolToken>(&token); symbol != nullptr) {
+        event_ = {ReadEventType::SYMBOL, 0, symbol->name};
+    } else if (std::holds_alternative<QuoteToken>(token)) {
+        throw SyntaxError("quote");
+    } else {
+        throw SyntaxError("invalid");
+    }
+    CompleteDatum();
+    consume_token_ = true;
+    return true;
+}
+
+void EventReader::CompleteDatum() {
+    if (levels_.empty()) {
+        return;
+    }
+    auto& level = levels_.back();
+    if (level == Level::EMPTY) {
+        level = Level::ELEMENTS;
+    } else if (level == Level::AFTER_DOT) {
+        level = Level::EXPECT_CLOSE;
+    }
+}
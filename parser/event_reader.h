@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <error.h>
+#include <tokenizer.h>
+
+enum class ReadEventType { BEGIN_LIST, END_LIST, DOT, NUMBER, SYMBOL };
+
+struct ReadEvent {
+    ReadEventType type;
+    int number = 0;
+    // Points into the tokenizer; valid until the next event is read.
+    std::string_view name;
+};
+
+// Event-based (SAX-style) reader: walks the data Read would build and reports it as a flat
+// sequence of events, without creating any objects. For example "(a . 1)" yields
+// BEGIN_LIST, SYMBOL a, DOT, NUMBER 1, END_LIST. Input is validated exactly like Read does.
+//
+// Memory use is one byte per currently open list, whatever the size of the input.
+class EventReader {
+public:
+    explicit EventReader(Tokenizer* tokenizer) : tokenizer_(tokenizer) {
+    }
+
+    // Reads the next event of the top-level data sequence; returns false at the end of input.
+    bool Next();
+
+    const ReadEvent& GetEvent() const {
+        return event_;
+    }
+
+    // Number of lists enclosing the current event; BEGIN_LIST and END_LIST count their own.
+    size_t GetDepth() const {
+        return levels_.size() + (event_.type == ReadEventType::END_LIST ? 1 : 0);
+    }
+
+private:
+    // Position inside an open list.
+    enum class Level : uint8_t { EMPTY, ELEMENTS, AFTER_DOT, EXPECT_CLOSE };
+
+    Tokenizer* tokenizer_;
+    ReadEvent event_{ReadEventType::END_LIST, 0, {}};
+    std::vector<Level> levels_;
+    bool consume_token_ = false;
+
+    void CompleteDatum();
+};
+
+// Callback flavour: calls handler(const ReadEvent&) for every event of the input.
+template <typename Handler>
+void ReadEvents(Tokenizer* tokenizer, Handler&& handler) {
+    EventReader reader{tokenizer};
+    while (reader.Next()) {
+        handler(reader.GetEvent());
+    }
+}
@@ -0,0 +1,81 @@
+#include <catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <error.h>
+#include <event_reader.h>
+#include <parser.h>
+
+std::vector<std::string> ReadEventNames(const std::string& str) {
+    std::stringstream ss{str};
+    Tokenizer tokenizer{&ss};
+
+    std::vector<std::string> events;
+    ReadEvents(&tokenizer, [&events](const ReadEvent& event) {
+        switch (event.type) {
+            case ReadEventType::BEGIN_LIST:
+                events.emplace_back("(");
+                break;
+            case ReadEventType::END_LIST:
+                events.emplace_back(")");
+                break;
+            case ReadEventType::DOT:
+                events.emplace_back(".");
+                break;
+            case ReadEventType::NUMBER:
+                events.push_back(std::to_string(event.number));
+                break;
+            case ReadEventType::SYMBOL:
+                events.emplace_back(event.name);
+                break;
+        }
+    });
+    return events;
+}
+
+using Events = std::vector<std::string>;
+
+TEST_CASE("Events of atoms and lists") {
+    REQUIRE(ReadEventNames("").empty());
+    REQUIRE(ReadEventNames("5") == Events{"5"});
+    REQUIRE(ReadEventNames("()") == Events{"(", ")"});
+    REQUIRE(ReadEventNames("(+ 1 -2)") == Events{"(", "+", "1", "-2", ")"});
+    REQUIRE(ReadEventNames("(1 2 . 3)") == Events{"(", "1", "2", ".", "3", ")"});
+    REQUIRE(ReadEventNames("(1 . (2 . ()))") ==
+            Events{"(", "1", ".", "(", "2", ".", "(", ")", ")", ")"});
+    REQUIRE(ReadEventNames("(a (b (c))) d 7") ==
+            Events{"(", "a", "(", "b", "(", "c", ")", ")", ")", "d", "7"});
+}
+
+TEST_CASE("Symbol names stay valid until the next event") {
+    std::stringstream ss{"(a-very-long-symbol-name-past-sso another-long-symbol-name-here)"};
+    Tokenizer tokenizer{&ss};
+    EventReader reader{&tokenizer};
+
+    REQUIRE(reader.Next());
+    REQUIRE(reader.GetEvent().type == ReadEventType::BEGIN_LIST);
+    REQUIRE(reader.GetDepth() == 1);
+
+    REQUIRE(reader.Next());
+    REQUIRE(reader.GetEvent().name == "a-very-long-symbol-name-past-sso");
+    REQUIRE(reader.GetDepth() == 1);
+
+    REQUIRE(reader.Next());
+    REQUIRE(reader.GetEvent().name == "another-long-symbol-name-here");
+
+    REQUIRE(reader.Next());
+    REQUIRE(reader.GetEvent().type == ReadEventType::END_LIST);
+    REQUIRE(reader.GetDepth() == 1);
+
+    REQUIRE(!reader.Next());
+}
+
+TEST_CASE("Invalid event streams") {
+    for (std::string invalid : {"(", "(1", "(1 .", "( .", "(1 . ()", "(1 . )", "(1 . 2 3)", ")",
+                                "(.)", "(1 .)", "(. 2)", "((1)", "'a", ". 1"}) {
+        INFO(invalid);
+        REQUIRE_THROWS_AS(ReadEventNames(invalid), SyntaxError);
+    }
+}
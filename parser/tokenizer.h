@@ -44,11 +44,20 @@ class Tokenizer {
 private:
     std::istream* in_;
     Token temp_token_;
+    std::string name_buffer_;
     bool reach_end_ = false;
+    // Characters are taken from the stream buffer directly, skipping the per-call sentry of
+    // istream::peek/get.
+    int Peek() {
+        return in_->rdbuf()->sgetc();
+    }
+    int Get() {
+        return in_->rdbuf()->sbumpc();
+    }
     std::string ReadWholeNumber() {
         std::string str;
-        while (std::isdigit(in_->peek())) {
-            auto addition = in_->get();
+        while (std::isdigit(Peek())) {
+            auto addition = Get();
             str += addition;
         }
         return str;
@@ -65,12 +74,27 @@ private:
                std::find(sings_contain_.begin(), sings_contain_.end(), c) != sings_contain_.end() ||
                std::isdigit(c);
     }
-    std::string SubmitTail() {
-        std::string str;
-        while (AllowedTail(in_->peek())) {
-            str += in_->get();
+    void SubmitTail(std::string* str) {
+        while (AllowedTail(Peek())) {
+            *str += Get();
         }
-        return str;
+    }
+
+    // Symbol names are built in place and the string is parked in name_buffer_ while another
+    // token is current, so scanning reuses one allocation instead of making one per symbol.
+    void SetToken(Token token) {
+        if (auto* symbol = std::get_if<SymbolToken>(&temp_token_); symbol != nullptr) {
+            name_buffer_ = std::move(symbol->name);
+        }
+        temp_token_ = std::move(token);
+    }
+    std::string& StartSymbol(char first) {
+        if (!std::holds_alternative<SymbolToken>(temp_token_)) {
+            temp_token_ = SymbolToken{std::move(name_buffer_)};
+        }
+        auto& name = std::get<SymbolToken>(temp_token_).name;
+        name.assign(1, first);
+        return name;
     }
 
 public:
@@ -84,49 +108,48 @@ public:
 
     void Next() {
         char c;
-        while (std::isspace(in_->peek())) {
-            in_->get();
+        while (std::isspace(Peek())) {
+            Get();
         }
-        if (in_->eof() || in_->peek() == EOF) {
+        if (Peek() == EOF) {
             reach_end_ = true;
             return;
         }
-        c = in_->get();
+        c = Get();
         std::string cur_token = {c};
         if (c == '.') {
-            temp_token_ = DotToken{};
+            SetToken(DotToken{});
             return;
         }
         if (c == '\'') {
-            temp_token_ = QuoteToken{};
+            SetToken(QuoteToken{});
             return;
         }
         if (c == '(') {
-            temp_token_ = BracketToken::OPEN;
+            SetToken(BracketToken::OPEN);
             return;
         }
         if (c == ')') {
-            temp_token_ = BracketToken::CLOSE;
+            SetToken(BracketToken::CLOSE);
             return;
         }
         if (std::isdigit(c)) {
             cur_token += ReadWholeNumber();
-            temp_token_ = ConstantToken{std::stoi(cur_token)};
+            SetToken(ConstantToken{std::stoi(cur_token)});
             return;
         }
         if (std::find(signs_.begin(), signs_.end(), c) != signs_.end()) {
             std::string read = ReadWholeNumber();
             if (read.empty()) {
-                temp_token_ = SymbolToken{cur_token};
+                StartSymbol(c);
                 return;
             }
             cur_token += read;
-            temp_token_ = ConstantToken{std::stoi(cur_token)};
+            SetToken(ConstantToken{std::stoi(cur_token)});
             return;
         }
         if (AllowedBegin(c)) {
-            cur_token += SubmitTail();
-            temp_token_ = SymbolToken{cur_token};
+            SubmitTail(&StartSymbol(c));
             return;
         }
         throw SyntaxError(std::string("Unknown token: ") + c);
@@ -135,4 +158,9 @@ public:
     Token GetToken() {
         return temp_token_;
     }
+
+    // Same as GetToken, without copying; the reference is valid until the next call to Next.
+    const Token& PeekToken() const {
+        return temp_token_;
+    }
 };
\ No newline at end of file